@@ -0,0 +1,91 @@
+////////////////////////////////////////////////////////////
+//
+// Bouge - Modern and flexible skeletal animation library
+// Copyright (C) 2010 Lucas Beyer (pompei2@gmail.com)
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it freely,
+// subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+////////////////////////////////////////////////////////////
+#include <bouge/bouge.hpp>
+
+#include <bouge/IOModules/XML/Loader.hpp>
+#include <bouge/IOModules/XML/Saver.hpp>
+#include <bouge/IOModules/XMLParserCommon/XMLParserModules/TinyXMLParser.hpp>
+
+#include <cstdlib>
+#include <iostream>
+
+using namespace bouge;
+
+int main(int argc, const char* argv[])
+{
+    CoreAnimationReducer reducer;
+
+    std::vector<std::string> files;
+    for(int i = 1 ; i < argc ; ++i) {
+        std::string arg = argv[i];
+        if(arg == "-p" && i + 1 < argc) {
+            reducer.positionTolerance((float)std::atof(argv[++i]));
+        } else if(arg == "-r" && i + 1 < argc) {
+            reducer.rotationTolerance((float)std::atof(argv[++i]));
+        } else {
+            files.push_back(arg);
+        }
+    }
+
+    if(files.size() < 2 || files.size() > 3) {
+        std::cout << "Usage: " << argv[0] << " [-p POSITIONTOLERANCE] [-r ROTATIONTOLERANCE] SKELETONFILE ANIMATIONFILE [OUTFILE]" << std::endl;
+        std::cout << std::endl;
+        std::cout << "Will read the animations in Bouge's XML format and remove all the" << std::endl;
+        std::cout << "keyframes which can be interpolated from their neighbours, such that" << std::endl;
+        std::cout << "no bone moves farther than POSITIONTOLERANCE (in model space, default " << reducer.positionTolerance() << ")" << std::endl;
+        std::cout << "and no bone turns farther than ROTATIONTOLERANCE (in radians, default " << reducer.rotationTolerance() << ")" << std::endl;
+        std::cout << "from where the original animation puts it. The skeleton is needed in" << std::endl;
+        std::cout << "order to know how much moving a bone moves its children." << std::endl;
+        std::cout << "" << std::endl;
+        std::cout << "The result is stored into OUTFILE, or overwrites ANIMATIONFILE if none is given." << std::endl;
+        return 0;
+    }
+
+    XMLLoader loader(new TinyXMLParser());
+    XMLSaver saver;
+
+    try {
+        CoreSkeletonPtr skel = loader.loadSkeleton(files[0]);
+        std::vector<CoreAnimationPtr> anims = loader.loadAnimation(files[1]);
+
+        std::size_t before = 0, after = 0;
+        for(std::vector<CoreAnimationPtr>::iterator i = anims.begin() ; i != anims.end() ; ++i) {
+            KeyframeReduction reduction = reducer.reduce(*i, skel);
+            std::cout << (*i)->name() << ": " << reduction.keyframesBefore << " -> " << reduction.keyframesAfter
+                      << " keyframes, off by at most " << reduction.maxError << std::endl;
+
+            before += reduction.keyframesBefore;
+            after += reduction.keyframesAfter;
+        }
+
+        std::string outname = files.size() == 3 ? files[2] : files[1];
+        saver.saveAnimations(anims, outname);
+        std::cout << "Total: " << before << " -> " << after << " keyframes, stored in " << outname << std::endl;
+    } catch(const std::exception& err) {
+        std::cerr << "Error: " << err.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
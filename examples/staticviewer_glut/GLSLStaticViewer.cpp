@@ -324,7 +324,10 @@ namespace bougeExample
         // Faces work in the same way, regardless the vertex format.
         // Here, we only support triangles.
         gl_BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_VBOIds[0]);
-        gl_BufferData(GL_ELEMENT_ARRAY_BUFFER, m_hwmesh->faceCount() * m_hwmesh->indicesPerFace() * sizeof(BOUGE_FACE_INDEX_TYPE), &m_hwmesh->faceIndices()[0], GL_STATIC_DRAW);
+        // The mesh tells us the narrowest index type that fits its vertices.
+        std::vector<char> indices(m_hwmesh->faceIndices().size() * m_hwmesh->indexSize());
+        m_hwmesh->writeIndices(&indices[0], m_hwmesh->indexSize());
+        gl_BufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size(), &indices[0], GL_STATIC_DRAW);
 
         gl_BindVertexArray(0);
 
@@ -434,7 +437,7 @@ namespace bougeExample
                 m_shaderToUse->uniformi(uDiffTex, 0);
             }
 
-            glDrawElements(GL_TRIANGLES, submesh.faceCount() * m_hwmesh->indicesPerFace(), BOUGE_FACE_INDEX_TYPE_GL, (const GLvoid*)(submesh.startIndex()*sizeof(BOUGE_FACE_INDEX_TYPE)));
+            glDrawElements(GL_TRIANGLES, submesh.faceCount() * m_hwmesh->indicesPerFace(), m_hwmesh->indexSize() == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, (const GLvoid*)(submesh.startIndex()*m_hwmesh->indexSize()));
         }
 
         gl_BindVertexArray(0);
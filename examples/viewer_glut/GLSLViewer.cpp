@@ -301,6 +301,9 @@ namespace bougeExample
         gl_BindVertexArray(m_VAOIds[0]);
 
         m_hwmesh = m_model->buildHardwareMesh(maxBonesPerMesh, bonesPerVertex);
+        m_palette.reset(new BonePalette(*m_hwmesh, m_model->skeleton()));
+        m_paletteMatrices.resize(16*std::max<std::size_t>(m_palette->maxBoneCount(), 1));
+        m_paletteNormalMatrices.resize(9*std::max<std::size_t>(m_palette->maxBoneCount(), 1));
 
         // We allow two names for stuff just to be more compatible.
         std::string normal = m_hwmesh->hasAttrib("aVertexNormal") ? "aVertexNormal" : "normal";
@@ -362,7 +365,10 @@ namespace bougeExample
         // Faces work in the same way, regardless the vertex format.
         // Here, we only support triangles.
         gl_BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_VBOIds[0]);
-        gl_BufferData(GL_ELEMENT_ARRAY_BUFFER, m_hwmesh->faceCount() * m_hwmesh->indicesPerFace() * sizeof(BOUGE_FACE_INDEX_TYPE), &m_hwmesh->faceIndices()[0], GL_STATIC_DRAW);
+        // The mesh tells us the narrowest index type that fits its vertices.
+        std::vector<char> indices(m_hwmesh->faceIndices().size() * m_hwmesh->indexSize());
+        m_hwmesh->writeIndices(&indices[0], m_hwmesh->indexSize());
+        gl_BufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size(), &indices[0], GL_STATIC_DRAW);
 
         gl_BindVertexArray(0);
 
@@ -561,17 +567,20 @@ namespace bougeExample
 
         // Now, render each submesh of the mesh one after. It may need to get split
         // for example if it has too many bones.
-        for(CoreHardwareMesh::iterator i = m_hwmesh->begin() ; i != m_hwmesh->end() ; ++i) {
+        std::size_t iSubMesh = 0;
+        for(CoreHardwareMesh::iterator i = m_hwmesh->begin() ; i != m_hwmesh->end() ; ++i, ++iSubMesh) {
             const CoreHardwareSubMesh& submesh = *i;
 
             // We set the per-submesh material options.
 
-            // Probably the most important per-submesh option are the bone states
-            for(std::size_t i = 0 ; i < submesh.boneCount() ; ++i) {
-                /// \TODO Maybe optimize by storing the bone "ID in skeleton" in the hardware submesh, if possible?
-                BoneInstancePtrC bone = m_modelInst->skeleton()->bone(submesh.boneName(i));
-                m_shaderToUse->uniformMatrix4fv(uBonesPalette(i), 1, false, bone->transformMatrix().array16f());
-                m_shaderToUse->uniformMatrix3fv(uBonesPaletteInvTrans(i), 1, true, bone->transformMatrix().array9fInverse());
+            // Probably the most important per-submesh option are the bone states.
+            // The palette knows the skeleton's bone id of every slot, so we can
+            // gather all matrices at once and upload them in one go.
+            if(submesh.boneCount() > 0) {
+                m_palette->writeMatrices(iSubMesh, m_modelInst->skeleton(), &m_paletteMatrices[0]);
+                m_palette->writeNormalMatrices(iSubMesh, m_modelInst->skeleton(), &m_paletteNormalMatrices[0]);
+                m_shaderToUse->uniformMatrix4fv(uBonesPalette(0), submesh.boneCount(), false, &m_paletteMatrices[0]);
+                m_shaderToUse->uniformMatrix3fv(uBonesPaletteInvTrans(0), submesh.boneCount(), false, &m_paletteNormalMatrices[0]);
             }
 
             // Take care if this happens. We actually *should* render it with
@@ -616,7 +625,7 @@ namespace bougeExample
                 m_shaderToUse->uniformi(uDiffTex, 0);
             }
 
-            glDrawElements(GL_TRIANGLES, submesh.faceCount() * m_hwmesh->indicesPerFace(), BOUGE_FACE_INDEX_TYPE_GL, (const GLvoid*)(submesh.startIndex()*sizeof(BOUGE_FACE_INDEX_TYPE)));
+            glDrawElements(GL_TRIANGLES, submesh.faceCount() * m_hwmesh->indicesPerFace(), m_hwmesh->indexSize() == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, (const GLvoid*)(submesh.startIndex()*m_hwmesh->indexSize()));
         }
 
         gl_BindVertexArray(0);
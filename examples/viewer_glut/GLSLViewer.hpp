@@ -28,6 +28,8 @@
 
 #include <bouge/CoreModel.hpp>
 
+#include <vector>
+
 namespace bougeExample {
 
     typedef bouge::shared_ptr<bicali::detail::Shader>::type ShaderPtr;
@@ -62,6 +64,10 @@ namespace bougeExample {
         bouge::CoreModelPtr m_model;
         bouge::ModelInstancePtr m_modelInst;
         bouge::CoreHardwareMeshPtr m_hwmesh;
+        bouge::BonePalettePtr m_palette;
+        // Scratch space to gather the bone matrices in while rendering.
+        mutable std::vector<float> m_paletteMatrices;
+        mutable std::vector<float> m_paletteNormalMatrices;
         bouge::CoreModel::animation_iterator m_currAnim;
         float m_newAnimSpeed;
         float m_newAnimWeight;
@@ -26,6 +26,7 @@
 
 #include <bouge/bougefwd.hpp>
 #include <list>
+#include <vector>
 
 namespace bouge {
 
@@ -36,6 +37,33 @@ namespace bouge {
         virtual ~AnimationCallback() {};
     };
 
+    class BOUGE_API AnimationMarkerCallback
+    {
+    public:
+        /// Called once every time the animation goes over a marker.
+        /// \param anim The animation which went over the marker.
+        /// \param marker The name of the marker.
+        /// \param time The time of the marker in the core animation, in seconds.
+        virtual void operator()(const Animation& anim, const Name& marker, float time) = 0;
+        virtual ~AnimationMarkerCallback() {};
+    };
+
+    /// A marker of a core animation an animation went over while updating.
+    struct BOUGE_API AnimationEvent
+    {
+        AnimationEvent(const Animation* anim, const Name& marker, float time);
+
+        /// The animation which went over the marker.
+        const Animation* animation;
+        /// The name of the marker.
+        Name marker;
+        /// The time of the marker in the core animation, in seconds.
+        float time;
+    };
+
+    /// All events of one or more animations, in the order they happened in.
+    typedef std::vector<AnimationEvent> AnimationEvents;
+
     class BOUGE_API Animation
     {
     public:
@@ -44,9 +72,17 @@ namespace bouge {
 
         BOUGE_USER_DATA;
 
-        std::string name() const;
+        const Name& name() const;
 
-        void update(float deltaTime);
+        /// Advances the animation and fires all markers of its core animation
+        /// it went over, as told by the control function. That includes all
+        /// the loops and turnarounds, be it forwards or backwards in time.
+        /// Markers at the very start fire on the first update.
+        /// \param deltaTime The time that passed since the last update, in seconds.
+        /// \param events If given, an event is appended to it for every marker.
+        ///               This allows to collect the events of many animations
+        ///               into one single buffer, without any callback.
+        void update(float deltaTime, AnimationEvents* events = 0);
 
         Animation& pause();
         bool paused() const;
@@ -55,9 +91,12 @@ namespace bouge {
         float speed() const;
         Animation& speed(float s);
 
-//         Animation& addCallback(AnimationCallback* cb, float absoluteTime);
         Animation& addEndCallback(AnimationCallback* cb);
         Animation& addUpdateCallback(AnimationCallback* cb);
+        /// \param cb Called for every marker the animation goes over. The
+        ///           animation takes ownership of it.
+        /// \return A reference to the current object for chaining operation.
+        Animation& addMarkerCallback(AnimationMarkerCallback* cb);
 
         float timePercent() const;
         float timePercentRaw() const;
@@ -76,18 +115,32 @@ namespace bouge {
         const TimeFunction* weightFct() const;
         Animation& weightFct(TimeFunction* newFun);
 
+        /// \return Which bones this animation may move and how much, none if
+        ///         it may move all of them fully.
+        BoneMaskPtrC mask() const;
+        /// \param mask Which bones this animation may move and how much, or
+        ///             none to let it move all of them fully.
+        /// \return A reference to the current object for chaining operation.
+        Animation& mask(BoneMaskPtrC mask);
+
     private:
+        void fireMarkers(float from, float to, AnimationEvents* events);
+        void fireMarkersBetween(float from, float to, bool withFrom, AnimationEvents* events);
+        void fireMarker(const Name& marker, float time, AnimationEvents* events);
+
         float m_timePercent;
+        bool m_bStarted;
 
         CoreAnimationPtrC m_core;
         float m_speed;
         TimeFunction* m_control;
         TimeFunction* m_weight;
+        BoneMaskPtrC m_mask;
         bool m_paused;
 
-//         std::multimap<float, AnimationCallback*> m_arbitraryCbs;
         std::list<AnimationCallback*> m_updateCbs;
         std::list<AnimationCallback*> m_endCbs;
+        std::list<AnimationMarkerCallback*> m_markerCbs;
     };
 
 } // namespace bouge
@@ -0,0 +1,71 @@
+////////////////////////////////////////////////////////////
+//
+// Bouge - Modern and flexible skeletal animation library
+// Copyright (C) 2010 Lucas Beyer (pompei2@gmail.com)
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it freely,
+// subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+////////////////////////////////////////////////////////////
+#ifndef BOUGE_BONEBOUNDS_HPP
+#define BOUGE_BONEBOUNDS_HPP
+
+#include <bouge/bougefwd.hpp>
+#include <bouge/Math/BoundingVolume.hpp>
+
+#include <vector>
+
+namespace bouge {
+
+    /// The bounding volumes of the parts of a mesh that each bone of a skeleton
+    /// moves, in the model space of the rest pose. Build it once per mesh and
+    /// skeleton, then SkeletonInstance::bounds and
+    /// SkeletonInstance::boundingSphere can bound any pose of the model
+    /// without touching a single vertex.
+    class BOUGE_API BoneBounds
+    {
+    public:
+        /// Bounds, for every bone, all vertices it influences with a weight
+        /// other than zero.
+        /// \exception NotExistException if one of the bones influencing \a mesh
+        ///            doesn't exist in \a skel.
+        BoneBounds(CoreMeshPtrC mesh, CoreSkeletonPtrC skel);
+        virtual ~BoneBounds();
+
+        BOUGE_USER_DATA;
+
+        /// \return The number of bones, the same as in the skeleton.
+        std::size_t boneCount() const;
+
+        /// \return The box around all vertices influenced by the bone, empty
+        ///         if the bone doesn't influence any vertex.
+        /// \exception std::out_of_range if there is no bone with that id.
+        const BoundingBox& box(BoneId id) const;
+
+        /// \return The sphere around all vertices influenced by the bone, empty
+        ///         if the bone doesn't influence any vertex.
+        /// \exception std::out_of_range if there is no bone with that id.
+        const BoundingSphere& sphere(BoneId id) const;
+
+    private:
+        std::vector<BoundingBox> m_boxes;
+        std::vector<BoundingSphere> m_spheres;
+    };
+
+} // namespace bouge
+
+#endif // BOUGE_BONEBOUNDS_HPP
@@ -29,6 +29,7 @@
 #include <bouge/CoreBone.hpp>
 #include <bouge/Math/Vector.hpp>
 #include <bouge/Math/Quaternion.hpp>
+#include <bouge/Math/DualQuaternion.hpp>
 
 namespace bouge {
 
@@ -40,7 +41,7 @@ namespace bouge {
 
         BOUGE_USER_DATA;
 
-        std::string name() const;
+        const Name& name() const;
 
         CoreBonePtrC core() const;
 
@@ -121,7 +122,13 @@ namespace bouge {
 
         float length() const;
 
-        AffineMatrix transformMatrix() const;
+        const AffineMatrix& transformMatrix() const;
+        /// \return The same transformation as transformMatrix, from model space
+        ///         in rest pose to model space in the current pose, but as a
+        ///         dual quaternion, for dual quaternion skinning.
+        /// \note The scale of the bone is ignored, as a dual quaternion can't
+        ///       represent it.
+        const DualQuaternion& transformDualQuaternion() const;
 
     protected:
         BoneInstance& recalcMatrixCache();
@@ -139,6 +146,7 @@ namespace bouge {
         Vector m_absoluteRootPos;
         Quaternion m_absoluteBoneRot;
         AffineMatrix m_transformationMatrix;
+        DualQuaternion m_transformationDualQuat;
     };
 
 } // namespace bouge
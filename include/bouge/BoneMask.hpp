@@ -0,0 +1,77 @@
+////////////////////////////////////////////////////////////
+//
+// Bouge - Modern and flexible skeletal animation library
+// Copyright (C) 2010 Lucas Beyer (pompei2@gmail.com)
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it freely,
+// subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+////////////////////////////////////////////////////////////
+#ifndef BOUGE_BONEMASK_HPP
+#define BOUGE_BONEMASK_HPP
+
+#include <bouge/bougefwd.hpp>
+
+#include <vector>
+
+namespace bouge {
+
+    /// How much an animation may move each bone of a skeleton, from 0 (not at
+    /// all) to 1 (fully). Put a mask on an animation (see Animation::mask) to
+    /// restrict it to a part of the body, for example an upper-body action
+    /// played on top of the legs' walk cycle. The mixer doesn't even sample
+    /// the tracks of bones weighted 0.
+    class BOUGE_API BoneMask
+    {
+    public:
+        /// Creates a mask weighting all the bones of \a skel the same.
+        /// \param weight The weight of all bones, 0 to start from nothing
+        ///               and add parts, 1 to start from all and remove parts.
+        BoneMask(CoreSkeletonPtrC skel, float weight = 0.0f);
+        virtual ~BoneMask();
+
+        BOUGE_USER_DATA;
+
+        /// \return The number of bones, the same as in the skeleton.
+        std::size_t boneCount() const;
+
+        /// \return How much the bone may be moved.
+        /// \exception std::out_of_range if there is no bone with that id.
+        float weight(BoneId id) const;
+
+        /// \param id The bone whose weight to set.
+        /// \param weight How much the bone may be moved.
+        /// \return A reference to the current object for chaining operation.
+        /// \exception std::out_of_range if there is no bone with that id.
+        BoneMask& weight(BoneId id, float weight);
+
+        /// Sets the weight of a bone and all of its children, grand-children
+        /// and so on, for example "Spine and children".
+        /// \param bone The name of the bone the part starts at.
+        /// \param weight How much the bones of that part may be moved.
+        /// \return A reference to the current object for chaining operation.
+        /// \exception NotExistException if there is no bone named \a bone.
+        BoneMask& subtree(const Name& bone, float weight);
+
+    private:
+        CoreSkeletonPtrC m_skel;
+        std::vector<float> m_weights;
+    };
+
+} // namespace bouge
+
+#endif // BOUGE_BONEMASK_HPP
@@ -0,0 +1,185 @@
+////////////////////////////////////////////////////////////
+//
+// Bouge - Modern and flexible skeletal animation library
+// Copyright (C) 2010 Lucas Beyer (pompei2@gmail.com)
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it freely,
+// subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+////////////////////////////////////////////////////////////
+#ifndef BOUGE_BONEPALETTE_HPP
+#define BOUGE_BONEPALETTE_HPP
+
+#include <bouge/bougefwd.hpp>
+#include <bouge/Span.hpp>
+#include <bouge/Math/Util.hpp>
+
+#include <string>
+#include <vector>
+
+namespace bouge {
+
+    /// Maps the bone palette slots of all the hardware submeshes of a hardware
+    /// mesh to the ids of the bones in a skeleton. Build it once per hardware
+    /// mesh and skeleton, then use it to gather the bone matrices of a skeleton
+    /// instance every frame without ever looking a bone up by its name.
+    class BOUGE_API BonePalette
+    {
+    public:
+        /// The ways a single bone matrix can be written into a buffer.
+        enum MatrixLayout {
+            /// All 16 floats, laid out just like AffineMatrix::array16f.
+            Matrix4x4,
+
+            /// Only the first three rows, one row after the other (12 floats).
+            /// The last row of an affine matrix always is (0, 0, 0, 1), so the
+            /// shader can rebuild the matrix out of three vec4 fetches.
+            Matrix3x4,
+
+            /// Not a matrix but the bone's dual quaternion (8 floats), laid out
+            /// just like DualQuaternion::array8f, for dual quaternion skinning.
+            /// The bone's scale is lost.
+            DualQuaternion8
+        };
+
+        /// \exception NotExistException if one of the bones used by \a hwmesh
+        ///            doesn't exist in \a skel.
+        BonePalette(const CoreHardwareMesh& hwmesh, CoreSkeletonPtrC skel);
+        virtual ~BonePalette();
+
+        BOUGE_USER_DATA;
+
+        /// \return The number of hardware submeshes, in the same order as in the hardware mesh.
+        std::size_t submeshCount() const;
+
+        /// \return The number of bones of the biggest palette of all hardware submeshes.
+        std::size_t maxBoneCount() const;
+
+        /// \return The number of palette slots of all hardware submeshes together.
+        std::size_t slotCount() const;
+
+        /// \return The index of the first palette slot of the hardware submesh
+        ///         when all palettes are stored one after the other, like
+        ///         writeInstance does.
+        /// \exception std::out_of_range if there is no hardware submesh with that index.
+        std::size_t firstSlot(std::size_t submeshIdx) const;
+
+        /// \return The id of the bone in the skeleton for every palette slot of the hardware submesh.
+        /// \exception std::out_of_range if there is no hardware submesh with that index.
+        Span<BoneId> boneIds(std::size_t submeshIdx) const;
+
+        /// Writes the transformation matrices of all the bones of the palette
+        /// of a hardware submesh, one after the other, into \a out. Each
+        /// matrix takes 16 floats, laid out just like AffineMatrix::array16f.
+        /// \param submeshIdx The index of the hardware submesh.
+        /// \param skel The instance of the skeleton this palette was built for.
+        /// \param out Where to write the matrices to, room for 16*boneIds(submeshIdx).size() floats.
+        /// \return The number of floats written.
+        /// \exception std::out_of_range if there is no hardware submesh with that index.
+        std::size_t writeMatrices(std::size_t submeshIdx, SkeletonInstancePtrC skel, float* out) const;
+
+        /// Same as writeMatrices, but writes the matrices to transform the
+        /// normals, that is the inverse transpose of the upper-left 3x3 part of
+        /// each bone's transformation. Each matrix takes 9 floats, laid out
+        /// just like AffineMatrix::array9f, no transposing needed when uploading.
+        /// \return The number of floats written.
+        /// \exception std::out_of_range if there is no hardware submesh with that index.
+        std::size_t writeNormalMatrices(std::size_t submeshIdx, SkeletonInstancePtrC skel, float* out) const;
+
+        /// Same as writeMatrices, but writes the dual quaternions of the bones
+        /// instead, for dual quaternion skinning. Each one takes 8 floats, laid
+        /// out just like DualQuaternion::array8f.
+        /// \return The number of floats written.
+        /// \exception std::out_of_range if there is no hardware submesh with that index.
+        std::size_t writeDualQuaternions(std::size_t submeshIdx, SkeletonInstancePtrC skel, float* out) const;
+
+        /// Skins the vertices of \a hwmesh on the CPU using dual quaternion
+        /// skinning, for when there are no shaders to do it. The result has
+        /// the same layout as CoreHardwareMesh::coords and, if asked for, as
+        /// the normal attribute, so it can be drawn just like the rest pose.
+        /// \param hwmesh The hardware mesh this palette was built for.
+        /// \param skel The instance of the skeleton this palette was built for.
+        /// \param outCoords Where to write the skinned coordinates to, room for
+        ///                  as many floats as \a hwmesh 's coords has.
+        /// \param normalAttrib The name of the attribute holding the normals.
+        ///                     Leave empty in order not to skin the normals.
+        /// \param outNormals Where to write the skinned normals to, room for
+        ///                   as many floats as that attribute has.
+        /// \exception std::invalid_argument if \a hwmesh has another number of
+        ///            hardware submeshes than this palette or no attribute
+        ///            called \a normalAttrib.
+        void skinDualQuaternions(const CoreHardwareMesh& hwmesh, SkeletonInstancePtrC skel, float* outCoords, const std::string& normalAttrib = std::string(), float* outNormals = 0) const;
+
+        /// \return The number of floats a single bone matrix takes in \a layout.
+        static std::size_t floatsPerMatrix(MatrixLayout layout);
+
+        /// Writes the palettes of all hardware submeshes for one skeleton
+        /// instance into \a out, one after the other. The matrix of slot
+        /// \a slot of hardware submesh \a submesh ends up at matrix index
+        /// <tt>firstSlot(submesh) + slot</tt>.
+        /// \param skel The instance of the skeleton this palette was built for.
+        /// \param out Where to write the matrices to, room for slotCount()*floatsPerMatrix(layout) floats.
+        /// \param layout How to write each single matrix.
+        /// \return The number of floats written.
+        std::size_t writeInstance(SkeletonInstancePtrC skel, float* out, MatrixLayout layout = Matrix4x4) const;
+
+        /// Writes the palettes of many instances of the same skeleton, all
+        /// rendered using the same hardware mesh, into one big buffer meant
+        /// for instanced drawing, using a texture buffer or a storage buffer.
+        /// The palettes of the instances follow each other, each laid out just
+        /// like writeInstance does. So the matrix of slot \a slot of hardware
+        /// submesh \a submesh of instance \a inst is at matrix index
+        /// <tt>inst*slotCount() + firstSlot(submesh) + slot</tt>.
+        /// \param skels The instances of the skeleton this palette was built for.
+        /// \param out Where to write the matrices to, room for skels.size()*slotCount()*floatsPerMatrix(layout) floats.
+        /// \param layout How to write each single matrix.
+        /// \return The number of floats written.
+        std::size_t writeInstances(const std::vector<SkeletonInstancePtrC>& skels, float* out, MatrixLayout layout = Matrix4x4) const;
+
+        /// Same as writeInstance, but in half precision, halving the amount
+        /// of data to upload once more. Together with the Matrix3x4 layout, a
+        /// bone matrix only takes 24 bytes instead of 64.
+        /// \note Half precision floats only have about three significant
+        ///       digits, so this only fits models not too far from the origin.
+        /// \return The number of halfs written.
+        std::size_t writeInstanceHalf(SkeletonInstancePtrC skel, Uint16* out, MatrixLayout layout = Matrix3x4) const;
+
+        /// Same as writeInstances, but in half precision, see writeInstanceHalf.
+        /// \return The number of halfs written.
+        std::size_t writeInstancesHalf(const std::vector<SkeletonInstancePtrC>& skels, Uint16* out, MatrixLayout layout = Matrix3x4) const;
+
+        /// Checks if all bones of the palettes are scaled uniformly, that is
+        /// the same along all three axes. In that case, the inverse transpose
+        /// of a bone's matrix only differs from the matrix by a factor, so
+        /// there is no need to write the normal matrices at all: the shader
+        /// can transform the normals with the upper-left 3x3 part of the bone
+        /// matrix and normalize them afterwards.
+        /// \param skel The instance of the skeleton this palette was built for.
+        /// \param epsilon How much the scale factors may differ.
+        /// \return true if no normal matrices are needed for \a skel.
+        bool hasUniformScale(SkeletonInstancePtrC skel, float epsilon = D_BOUGE_EPSILON) const;
+
+    private:
+        /// The bone ids of all palettes, one after the other.
+        std::vector<BoneId> m_boneIds;
+        /// Where the palette of each hardware submesh starts in m_boneIds, plus the end.
+        std::vector<std::size_t> m_starts;
+    };
+
+} // namespace bouge
+
+#endif // BOUGE_BONEPALETTE_HPP
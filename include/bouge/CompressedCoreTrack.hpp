@@ -0,0 +1,140 @@
+////////////////////////////////////////////////////////////
+//
+// Bouge - Modern and flexible skeletal animation library
+// Copyright (C) 2010 Lucas Beyer (pompei2@gmail.com)
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it freely,
+// subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+////////////////////////////////////////////////////////////
+#ifndef BOUGE_COMPRESSEDCORETRACK_HPP
+#define BOUGE_COMPRESSEDCORETRACK_HPP
+
+#include <bouge/bougefwd.hpp>
+#include <bouge/CoreTrack.hpp>
+
+#include <vector>
+
+namespace bouge {
+
+    /// How far a compressed or resampled track or animation is off from its original.
+    struct BOUGE_API CompressionError {
+        CompressionError();
+
+        /// Makes this the worst of this and \a other.
+        CompressionError& merge(const CompressionError& other);
+
+        /// The biggest angle, in radians, between an original and a compressed rotation.
+        float rotation;
+        /// The biggest distance between an original and a compressed translation.
+        float translation;
+        /// The biggest difference between an original and a compressed scale factor.
+        float scale;
+    };
+
+    /// A track whose keyframes are stored compressed, decompressed on the fly
+    /// while sampling it, using just the same interface as any other track.\n
+    /// Rotations take 48 bits per keyframe (smallest-three encoding, that is
+    /// the three smallest components quantized to 15 bits each, plus which one
+    /// got dropped and its sign). Translations and scales take 48 bits per
+    /// keyframe too, quantized to 16 bits per component within the range the
+    /// track covers. A channel which doesn't change over the whole track is
+    /// only stored once. Rotations are stored normalized, so a track made of
+    /// non-unit quaternions interpolates slightly differently once compressed;
+    /// that shows up in the error. The keyframes are interpolated just as the
+    /// source track does, see CoreTrack::interpolation.
+    /// \note A compressed track doesn't hold any CoreKeyframe, so iterating it
+    ///       yields nothing and editing it throws. Use decompress in order
+    ///       to edit or save it.
+    class BOUGE_API CompressedCoreTrack : public CoreTrack
+    {
+    public:
+        /// Compresses \a source.
+        /// \param source The track to compress, it needs at least one keyframe.
+        /// \param tolerance How much a channel may change over the whole track
+        ///                  and still be stored as constant.
+        /// \exception std::invalid_argument if \a source has no keyframes.
+        CompressedCoreTrack(const CoreTrack& source, float tolerance = 1e-5f);
+        virtual ~CompressedCoreTrack();
+
+        virtual bool hasRotation() const;
+        virtual Quaternion rotation(float time) const;
+        virtual bool hasTranslation() const;
+        virtual Vector translation(float time) const;
+        virtual bool hasScale() const;
+        virtual Vector scale(float time) const;
+
+        virtual std::size_t keyframeCount() const;
+        virtual float duration() const;
+
+        // There are no keyframes to edit, all of these throw a std::logic_error.
+        // Use decompress and edit that instead.
+        using CoreTrack::begin;
+        using CoreTrack::closest;
+        using CoreTrack::after;
+        virtual iterator begin();
+        virtual iterator closest(float time);
+        virtual iterator after(float time);
+        virtual CoreTrack& add(float time, CoreKeyframePtr keyframe);
+        virtual CoreTrack& remove(iterator who);
+        virtual CoreTrack& removeAllIn(float start, float end);
+
+        /// \return How far this track is off from the one it has been
+        ///         compressed from, measured at every keyframe and halfway
+        ///         between each two of them.
+        const CompressionError& error() const;
+
+        /// \return The number of bytes the compressed keyframes take.
+        std::size_t byteSize() const;
+
+        /// \return An uncompressed track with the same keyframes, up to the
+        ///         precision lost by compressing them.
+        CoreTrackPtr decompress() const;
+
+    private:
+        /// \internal Everything to decompress one vector channel.
+        struct VectorChannel {
+            bool has;
+            bool constant;
+            float min[3];
+            float extent[3];
+            std::vector<Uint16> quantized;
+
+            void compress(const std::vector<Vector>& values, float tolerance);
+            Vector at(std::size_t idx) const;
+        };
+
+        void keyframesAround(float time, std::size_t& from, std::size_t& to) const;
+        void neighbours(std::size_t from, std::size_t to, std::size_t& prev, std::size_t& next) const;
+        Quaternion rotationAt(std::size_t idx) const;
+
+        std::vector<float> m_times;
+
+        bool m_bHasRot;
+        bool m_bConstRot;
+        float m_constRot[4];
+        std::vector<Uint16> m_rot;
+
+        VectorChannel m_trans;
+        VectorChannel m_scale;
+
+        CompressionError m_error;
+    };
+
+} // namespace bouge
+
+#endif // BOUGE_COMPRESSEDCORETRACK_HPP
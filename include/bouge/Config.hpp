@@ -30,11 +30,14 @@
 // Some compile-time options on bouge.
 ////////////////////////////////////////////////////////////
 // In case you don't use it and want to save some memory, define this to 0 in your preprocessor.
+// Small objects like vertices, faces and keyframes don't carry a userData
+// member, their owners hold it in a UserDataTable instead.
 #ifndef BOUGE_USE_USERDATA
     #define BOUGE_USE_USERDATA 1
 #endif
 
-// Choose whatever you want here. The OpenGL docs say unsigned short might be faster..
+// This is only used by CoreHardwareMesh::writeFaceIndices. The hardware mesh
+// chooses the narrowest index type at runtime, see CoreHardwareMesh::indexSize.
 // Choose by adding "BOUGE_FACE_INDEX_UINT" or not to your preprocessor.
 #ifndef BOUGE_FACE_INDEX_TYPE
     #ifdef BOUGE_FACE_INDEX_UINT
@@ -111,6 +114,22 @@
 #endif
 
 
+////////////////////////////////////////////////////////////
+// Define portable fixed-size types
+////////////////////////////////////////////////////////////
+namespace bouge {
+    // All "common" platforms use the same size for char, short and int
+    // (basically there are 3 types for 3 sizes, so no other match is possible),
+    // we can use them without doing any kind of check
+    typedef signed   char Int8;
+    typedef unsigned char Uint8;
+    typedef signed   short Int16;
+    typedef unsigned short Uint16;
+    typedef signed   int Int32;
+    typedef unsigned int Uint32;
+}
+
+
 ////////////////////////////////////////////////////////////
 // Identify if C++0x can be used.
 ////////////////////////////////////////////////////////////
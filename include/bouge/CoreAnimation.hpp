@@ -25,33 +25,115 @@
 #define BOUGE_COREANIMATION_HPP
 
 #include <bouge/bougefwd.hpp>
+#include <bouge/CompressedCoreTrack.hpp>
+#include <bouge/ResampledCoreTrack.hpp>
 
 #include <string>
 #include <map>
 
 namespace bouge {
 
+    /// An animation is a set of tracks, one per bone it moves.\n
+    /// Its duration and which kinds of transformations it has are kept up to
+    /// date as tracks are added, so that they can be queried every frame.
+    /// Handing out a modifiable track (through the non-const track getter or
+    /// iterators) makes the animation look at all its tracks again the next
+    /// time it is queried, in case the track got changed.
+    /// \note If you keep a track and change it after adding it to the
+    ///       animation, get it through track(bone) once more afterwards.
     class BOUGE_API CoreAnimation
     {
-        typedef std::map<std::string, CoreTrackPtr> TrackMap;
+        typedef std::map<Name, CoreTrackPtr> TrackMap;
+        typedef std::multimap<float, Name> MarkerMap;
     public:
         CoreAnimation(std::string name, TimeFunction* preferredControl = 0);
         virtual ~CoreAnimation();
 
         BOUGE_USER_DATA;
 
-        std::string name() const;
-        CoreAnimation& name(std::string name);
+#if BOUGE_USE_USERDATA
+        /// User data of the tracks, keyed by the name of the bone they animate.
+        UserDataTable<Name> trackUserData;
+#endif
 
+        const Name& name() const;
+        CoreAnimation& name(const Name& name);
+
+        /// \return The duration of the longest track.
         float duration() const;
         const TimeFunction* preferredControl() const;
 
-        bool hasTrack(const std::string& bone);
-        CoreTrackPtr track(const std::string& bone);
-        const CoreTrackPtr track(const std::string& bone) const;
-        CoreAnimation& track(const std::string& bone, CoreTrackPtr track);
+        /// \return Whether any track of this animation rotates its bone.
+        bool hasRotation() const;
+        /// \return Whether any track of this animation translates its bone.
+        bool hasTranslation() const;
+        /// \return Whether any track of this animation scales its bone.
+        bool hasScale() const;
+
+        /// Recalculates the duration and what the tracks do from scratch.
+        /// The methods changing the tracks do so themselves, but the tracks
+        /// handed out by track(bone) or the iterators may be changed behind
+        /// the animation's back. Call this once done changing them.
+        /// \return A reference to the current object for chaining operation.
+        CoreAnimation& updateMetadata();
+
+        bool hasTrack(const Name& bone) const;
+        /// Doesn't add \a bone to the name table, unlike converting it to a Name.
+        bool hasTrack(const std::string& bone) const;
+        bool hasTrack(const char* bone) const;
+        CoreTrackPtr track(const Name& bone);
+        const CoreTrackPtr track(const Name& bone) const;
+        CoreAnimation& track(const Name& bone, CoreTrackPtr track);
         std::size_t trackCount() const;
 
+        /// Replaces every track by a CompressedCoreTrack, which takes way less
+        /// memory and is sampled just the same. Tracks already compressed or
+        /// resampled are left as they are.
+        /// \return How far the compressed tracks are off from the original
+        ///         ones, the worst of all tracks compressed now.
+        CompressionError compress();
+
+        /// Replaces every track by a ResampledCoreTrack, which is sampled
+        /// without searching for keyframes. Tracks already resampled are left
+        /// as they are, compressed ones are resampled too.
+        /// \param rate How many samples to take per second.
+        /// \return How far the resampled tracks are off from the original
+        ///         ones, the worst of all tracks resampled now.
+        /// \exception std::invalid_argument if \a rate is not positive.
+        CompressionError resample(float rate = 30.0f);
+
+        /// Lets every track look for what stays the same throughout it, see
+        /// CoreTrack::detectConstants. The loader already does this.
+        /// \param tolerance How much a rotation, translation or scale may
+        ///                  vary for it to still be the same.
+        /// \return A reference to the current object for chaining operation.
+        CoreAnimation& detectConstants(float tolerance = 1e-5f);
+
+        /// Turns this into an additive animation: every keyframe becomes the
+        /// difference between its pose and a reference pose. Played as an
+        /// additive layer (see Mixer::additive), it then moves the bones
+        /// relative to whatever pose the other animations put them in.
+        /// Parts not differing from the reference are dropped (see
+        /// CoreTrack::detectConstants), so that they cost nothing to play.
+        /// \note Do this at load-time, before compressing or resampling.
+        /// \param reference The animation to take the reference pose from, or
+        ///                  none to take it from this animation itself.
+        /// \param referenceTime When to take the reference pose.
+        /// \return A reference to the current object for chaining operation.
+        /// \exception std::invalid_argument if a track has already been
+        ///            compressed or resampled. Nothing has been changed then.
+        CoreAnimation& makeAdditive(CoreAnimationPtrC reference = CoreAnimationPtrC(), float referenceTime = 0.0f);
+
+        /// \return Whether the tracks of this animation hold differences to a
+        ///         reference pose, see makeAdditive.
+        bool additive() const;
+
+        /// Only tells whether the tracks of this animation hold differences to
+        /// a reference pose, it does not change them. Use makeAdditive for that.
+        /// \param additive Whether the tracks hold differences.
+        /// \return A reference to the current object for chaining operation.
+        CoreAnimation& additive(bool additive);
+
         class BOUGE_API iterator {
         public:
             iterator();
@@ -63,7 +145,7 @@ namespace bouge {
             iterator operator++(int);
             iterator& operator--();
             iterator operator--(int);
-            std::string bone() const;
+            const Name& bone() const;
             CoreTrackPtr track();
             CoreTrack* operator->();
         private:
@@ -88,7 +170,7 @@ namespace bouge {
             const_iterator operator++(int);
             const_iterator& operator--();
             const_iterator operator--(int);
-            std::string bone() const;
+            const Name& bone() const;
             CoreTrackPtrC track() const;
             const CoreTrack* operator->() const;
         private:
@@ -102,10 +184,59 @@ namespace bouge {
         /// \return An iterator pointing behind the last track.
         const_iterator end() const;
 
+        /// Adds a named point in time, for example when a foot touches the
+        /// ground. Playing the animation fires an event whenever it goes over
+        /// a marker, see Animation::addMarkerCallback and Mixer::events.
+        /// \param time The time of the marker, in seconds.
+        /// \param name What happens at that time. Several markers may have
+        ///             the same name or the same time.
+        /// \return A reference to the current object for chaining operation.
+        CoreAnimation& addMarker(float time, const Name& name);
+        CoreAnimation& removeAllMarkers();
+        std::size_t markerCount() const;
+
+        class BOUGE_API const_marker_iterator {
+        public:
+            const_marker_iterator();
+            ~const_marker_iterator();
+
+            bool operator==(const_marker_iterator other) const;
+            bool operator!=(const_marker_iterator other) const;
+            const_marker_iterator& operator++();
+            const_marker_iterator operator++(int);
+            const_marker_iterator& operator--();
+            const_marker_iterator operator--(int);
+            float time() const;
+            const Name& name() const;
+        private:
+            friend class CoreAnimation;
+            const_marker_iterator(MarkerMap::const_iterator me);
+            MarkerMap::const_iterator myIter;
+        };
+
+        /// \return An iterator pointing at the first marker, in time.
+        const_marker_iterator begin_marker() const;
+        /// \return An iterator pointing behind the last marker.
+        const_marker_iterator end_marker() const;
+        /// \return The first marker at or after \a time.
+        const_marker_iterator markersFrom(float time) const;
+        /// \return The first marker strictly after \a time.
+        const_marker_iterator markersAfter(float time) const;
+
     private:
-        std::string m_sName;
+        /// \internal Takes the track into account for the metadata.
+        void addMetadata(const CoreTrack& track);
+
+        Name m_name;
         TimeFunction* m_preferredControl;
         TrackMap m_tracks;
+        MarkerMap m_markers;
+        bool m_bAdditive;
+
+        float m_duration;
+        bool m_bHasRotation;
+        bool m_bHasTranslation;
+        bool m_bHasScale;
     };
 
 } // namespace bouge
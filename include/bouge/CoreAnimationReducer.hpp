@@ -0,0 +1,121 @@
+////////////////////////////////////////////////////////////
+//
+// Bouge - Modern and flexible skeletal animation library
+// Copyright (C) 2010 Lucas Beyer (pompei2@gmail.com)
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it freely,
+// subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+////////////////////////////////////////////////////////////
+#ifndef BOUGE_COREANIMATIONREDUCER_HPP
+#define BOUGE_COREANIMATIONREDUCER_HPP
+
+#include <bouge/bougefwd.hpp>
+
+#include <cstddef>
+
+namespace bouge {
+
+    /// What a keyframe reduction did to an animation.
+    struct BOUGE_API KeyframeReduction {
+        KeyframeReduction();
+
+        /// How many keyframes all tracks had together before the reduction.
+        std::size_t keyframesBefore;
+        /// How many keyframes all tracks have together after the reduction.
+        std::size_t keyframesAfter;
+        /// The biggest model-space distance any bone may now be off from where
+        /// the original animation put it, an upper bound.
+        float maxError;
+    };
+
+    /// This class removes the keyframes of an animation which can be left out
+    /// without changing its outcome by more than a given tolerance, typically
+    /// those of exported mocap or baked animations, which have a keyframe on
+    /// every frame, even where the motion is linear or constant.
+    ///
+    /// A keyframe is removed if interpolating its neighbours still gives all
+    /// the removed keyframes of the original track, up to the tolerance. The
+    /// error is measured in model space: a rotation that is off moves all the
+    /// child bones, the farther away they are the more; and errors add up
+    /// along a chain of bones. Thus each bone gets an equal share of the
+    /// position tolerance of the longest chain of bones it is part of, and
+    /// the rotations of bones with long chains of children hanging off them
+    /// are kept much more precisely than the ones of the tips of fingers.
+    ///
+    /// \note Compressed and resampled tracks (see CompressedCoreTrack and
+    ///       ResampledCoreTrack) are left untouched, so reduce an animation
+    ///       before compressing or resampling it. Tracks interpolated using
+    ///       splines are left untouched too.
+    class BOUGE_API CoreAnimationReducer
+    {
+    public:
+        CoreAnimationReducer();
+        virtual ~CoreAnimationReducer();
+
+        BOUGE_USER_DATA;
+
+        /// \return How far, in model space, a bone may end up from where the
+        ///         original animation put it.
+        float positionTolerance() const;
+
+        /// \param tolerance How far, in model space, a bone may end up from
+        ///                  where the original animation put it.
+        /// \return A reference to the current object for chaining operation.
+        CoreAnimationReducer& positionTolerance(float tolerance);
+
+        /// \return How far, in radians, the rotation of any bone may be off,
+        ///         regardless of the position tolerance.
+        float rotationTolerance() const;
+
+        /// \param tolerance How far, in radians, the rotation of any bone may
+        ///                  be off. This matters for the bones at the end of
+        ///                  the chains, which move nothing else but the skin.
+        /// \return A reference to the current object for chaining operation.
+        CoreAnimationReducer& rotationTolerance(float tolerance);
+
+        /// Removes all the keyframes of \a anim that aren't needed.
+        /// \param anim The animation to reduce. It is modified in place.
+        /// \param skel The skeleton the animation is made for. Its hierarchy
+        ///             and bone lengths are used in order to measure the error
+        ///             in model space. If there is none, or a track animates a
+        ///             bone the skeleton hasn't got, the track is reduced on its
+        ///             own, as if its bone had neither parent nor children.
+        /// \return The keyframe counts before and after the reduction.
+        KeyframeReduction reduce(CoreAnimationPtr anim, CoreSkeletonPtrC skel = CoreSkeletonPtrC()) const;
+
+    private:
+        /// \internal How much one track may be off.
+        struct TrackTolerance {
+            /// The share of the position tolerance this bone gets.
+            float distance;
+            /// How far the children of this bone reach away from it.
+            float reach;
+            /// How long the bone itself is, its scale moves its skin that far.
+            float length;
+        };
+
+        /// \internal Removes the keyframes of one track, returns the biggest error.
+        float reduce(CoreTrack& track, const TrackTolerance& tolerance) const;
+
+        float m_positionTolerance;
+        float m_rotationTolerance;
+    };
+
+} // namespace bouge
+
+#endif // BOUGE_COREANIMATIONREDUCER_HPP
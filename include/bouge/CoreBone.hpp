@@ -46,8 +46,8 @@ namespace bouge {
 
         BOUGE_USER_DATA;
 
-        std::string name() const;
-        CoreBone& name(std::string name);
+        const Name& name() const;
+        CoreBone& name(const Name& name);
 
         BoneId id() const;
         CoreBone& id(BoneId id);
@@ -145,7 +145,7 @@ namespace bouge {
         void updateAbsoluteRecursive();
 
     private:
-        std::string m_sName;
+        Name m_name;
         CoreBonePtr m_pParent;
 
         ChildrenMap m_children;
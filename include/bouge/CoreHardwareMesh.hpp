@@ -35,13 +35,13 @@ namespace bouge {
     class BOUGE_API CoreHardwareSubMesh
     {
     public:
-        CoreHardwareSubMesh(std::size_t startIdx, std::string submeshName);
+        CoreHardwareSubMesh(std::size_t startIdx, const Name& submeshName);
         virtual ~CoreHardwareSubMesh();
 
         BOUGE_USER_DATA;
 
         /// \return The name of the original submesh this hardware submesh comes from.
-        std::string submeshName() const;
+        const Name& submeshName() const;
 
         /// \return The number of faces this sub-mesh has.
         std::size_t faceCount() const;
@@ -50,20 +50,41 @@ namespace bouge {
         ///         face of this submesh is located.
         std::size_t startIndex() const;
 
+        /// \return The index of the first vertex of this submesh in the vertex
+        ///         buffers. The vertices of a hardware submesh are all stored
+        ///         one after the other, starting at this one.
+        std::size_t baseVertex() const;
+
+        /// \return The number of vertices used by this submesh, starting at baseVertex.
+        std::size_t vertexCount() const;
+
+        /// \return The size in bytes (2 or 4) of the narrowest index type that
+        ///         can hold the face indices of this submesh when they are
+        ///         relative to its baseVertex.
+        std::size_t indexSize() const;
+
         std::size_t boneCount() const;
-        bool hasBone(const std::string& name) const;
-        unsigned int boneId(const std::string& name) const;
-        std::string boneName(std::size_t idInSubmesh) const;
+        bool hasBone(const Name& name) const;
+        unsigned int boneId(const Name& name) const;
+        const Name& boneName(std::size_t idInSubmesh) const;
 
         bool canAddFace(Face f, CoreSubMeshPtrC coreSubMesh, unsigned int bonesPerMesh) const;
         void addFace(Face f, CoreSubMeshPtrC coreSubMesh);
 
     private:
-        std::map<std::string, unsigned int> m_boneNameToIdInSubmesh;
-        std::vector<std::string> m_boneIdInSubmeshToName;
+        friend class CoreHardwareMesh;
+
+        /// \internal
+        /// Appends a bone to the palette, without checking if it's already in.
+        void addBone(const Name& name);
+
+        std::map<Name, unsigned int> m_boneNameToIdInSubmesh;
+        std::vector<Name> m_boneIdInSubmeshToName;
         std::size_t m_faceCount;
         std::size_t m_startIdx;
-        std::string m_submeshName;
+        std::size_t m_baseVertex;
+        std::size_t m_vertexCount;
+        Name m_submeshName;
     };
 
     class BOUGE_API CoreHardwareMesh
@@ -74,10 +95,46 @@ namespace bouge {
     public:
         typedef shared_ptr<CoreHardwareMesh>::type Ptr;
 
+        /// The ways a submesh can be split into hardware submeshes when it is
+        /// influenced by more bones than \a bonesPerMesh.
+        enum PartitionMethod {
+            /// Walk the faces in their stored order and start a new hardware
+            /// submesh as soon as a face doesn't fit into the current one anymore.
+            /// Fast, but the result depends a lot on the order of the faces.
+            PartitionGreedy,
+
+            /// Grow every hardware submesh from a seed face by always taking the
+            /// neighbouring face that adds the least new bones to its palette,
+            /// and then absorb all faces whose bones are already in the palette.
+            /// This gives less hardware submeshes (draw calls) and less vertices
+            /// duplicated at the splits, but takes a bit longer to build.
+            PartitionBoneAffinity
+        };
+
         /// \NOTE If you want to create a hardware mesh that doesn't use bones
         ///       (that is, a static hardware mesh), just set both \a bonesPerMesh
         ///       and \a bonesPerVertex to 0. Yes, both. Yes, there is reason for that.
-        CoreHardwareMesh(CoreMeshPtrC coremesh, unsigned int bonesPerMesh, unsigned char bonesPerVertex = 4, unsigned char verticesPerFace = 3);
+        CoreHardwareMesh(CoreMeshPtrC coremesh, unsigned int bonesPerMesh, unsigned char bonesPerVertex = 4, unsigned char verticesPerFace = 3, PartitionMethod method = PartitionGreedy);
+
+        /// Creates a hardware mesh out of a prebuilt one, see saveBinary.
+        /// Before using it, you should check that it isn't stale by using
+        /// CoreHardwareMeshBinary::isBuiltFrom on it.
+        /// \exception BadDataException if the streams of the prebuilt hardware
+        ///            mesh don't start with the coordinates, weights and bone
+        ///            indices as written by saveBinary.
+        CoreHardwareMesh(const CoreHardwareMeshBinary& prebuilt);
+
+        /// Creates the hardware mesh of a level of detail of the mesh that
+        /// \a paletteSource has been built from (see CoreMeshSimplifier).
+        /// It is built with the same settings and vertex attributes, and its
+        /// faces are put into hardware submeshes having exactly the same bone
+        /// palette (same bones in the same order) as one of \a paletteSource,
+        /// wherever their bones allow it. This way, both levels of detail can
+        /// share the same bone matrices. Only faces that don't fit into any of
+        /// those palettes end up in additional hardware submeshes.
+        /// \exception BadDataException if \a lod has a face with more bones
+        ///            than fit into a hardware submesh.
+        CoreHardwareMesh(CoreMeshPtrC lod, const CoreHardwareMesh& paletteSource);
         virtual ~CoreHardwareMesh();
 
         BOUGE_USER_DATA;
@@ -86,6 +143,33 @@ namespace bouge {
 
         SubMeshContainer::size_type submeshCount() const;
 
+        /// \return The method that has been used to split the submeshes.
+        PartitionMethod partitionMethod() const;
+
+        /// \return The number of vertices that had to be duplicated because
+        ///         they are used by faces ending up in different hardware
+        ///         submeshes. Together with submeshCount, this tells you how
+        ///         good the split is.
+        std::size_t duplicatedVertexCount() const;
+
+        /// \return The maximal number of bones per hardware submesh this has been built with.
+        unsigned int bonesPerMesh() const;
+
+        /// \return The CoreMesh::contentHash of the mesh this has been built from.
+        Uint32 sourceHash() const;
+
+        /// Stores this hardware mesh in a binary form, so it doesn't need to be
+        /// built anew the next time. The layout is described in CoreHardwareMeshBinary.hpp,
+        /// the data can be memory-mapped and used through a CoreHardwareMeshBinary.
+        /// \return The binary data of this hardware mesh.
+        std::vector<char> saveBinary() const;
+
+        /// Stores this hardware mesh in a binary form in a file.
+        /// \param sFileName The name of the file to write the data to.
+        /// \exception std::runtime_error if the file can't be written.
+        /// \see saveBinary()
+        const CoreHardwareMesh& saveBinary(const std::string& sFileName) const;
+
         class BOUGE_API iterator {
         public:
             iterator();
@@ -292,26 +376,48 @@ namespace bouge {
         /// \return The number of indices each face has. (Usually 3: triangles)
         std::size_t indicesPerFace() const;
 
+        /// \return The size in bytes (2 or 4) of the narrowest index type that
+        ///         can hold all the face indices of this mesh.
+        std::size_t indexSize() const;
+
+        /// \return The size in bytes (2 or 4) of the narrowest index type that
+        ///         can hold the face indices of every submesh when they are
+        ///         relative to the submesh's base vertex. Use this when you
+        ///         draw with base vertex offsets (like glDrawElementsBaseVertex).
+        std::size_t relativeIndexSize() const;
+
         /// Get a copy of the indices of the face at the specified index.
         /// \param idx The (0-based) number (index) of the face whose indices to get.
         /// \return A copy of that face's indices. Modifying the copy won't modify the original.
         /// \exception std::out_of_range in case there is no face at the specified index.
-        std::vector<BOUGE_FACE_INDEX_TYPE> faceIndices(std::size_t idx) const;
+        std::vector<Uint32> faceIndices(std::size_t idx) const;
 
         /// Modify the indices of the face at the specified index.
         /// \param idx The (0-based) number (index) of the face whose indices to modify.
         /// \param indices The new value to assign to that face's indices.
         /// \return A reference to the current object for chaining operation.
         /// \exception std::out_of_range in case there is no face at the specified index.
-        CoreHardwareMesh& faceIndices(std::size_t idx, const std::vector<BOUGE_FACE_INDEX_TYPE>& indices);
+        CoreHardwareMesh& faceIndices(std::size_t idx, const std::vector<Uint32>& indices);
 
         /// Get the whole list of face indices (can be modified).
         /// \return A reference to the whole list of raw face indices.
-        std::vector<BOUGE_FACE_INDEX_TYPE>& faceIndices();
+        std::vector<Uint32>& faceIndices();
 
-        /// Get the whole list of read-only face indices. Should be sent to the graphics card.
+        /// Get the whole list of read-only face indices. To send them to the
+        /// graphics card, you better use writeIndices with the indexSize.
         /// \return A read-only reference to the whole list of raw face indices.
-        const std::vector<BOUGE_FACE_INDEX_TYPE>& faceIndices() const;
+        const std::vector<Uint32>& faceIndices() const;
+
+        /// Writes the face indices into a buffer, tightly packed.
+        /// \param where The buffer to write the face indices to. It needs to
+        ///              be (at least) faceIndices().size() * \a indexSize bytes big.
+        /// \param indexSize The size of one index in bytes, that is 2 or 4.
+        ///                  Usually, you want to pass indexSize() or relativeIndexSize().
+        /// \param bRelativeToBaseVertex If true, the indices of every submesh
+        ///                              are written relative to its baseVertex.
+        /// \return A reference to the current object for chaining operation.
+        /// \exception std::invalid_argument in case an index doesn't fit into \a indexSize bytes.
+        const CoreHardwareMesh& writeIndices(void* where, std::size_t indexSize, bool bRelativeToBaseVertex = false) const;
 
         /// Writes the face indices into a buffer.
         /// \param where The buffer to write the face indices to.
@@ -319,14 +425,39 @@ namespace bouge {
         ///               and the next face's indices, there are \a stride bytes.
         ///               It's actually exactly the same as in OpenGL.
         /// \return A reference to the current object for chaining operation.
+        /// \exception std::invalid_argument in case an index doesn't fit into a BOUGE_FACE_INDEX_TYPE.
+        /// \note This is for code using the compile-time BOUGE_FACE_INDEX_TYPE,
+        ///       prefer writeIndices together with indexSize().
         const CoreHardwareMesh& writeFaceIndices(BOUGE_FACE_INDEX_TYPE* where, std::size_t stride) const;
 
     protected:
         /// \internal
-        static std::size_t totalDifferentBoneCount(const Face& f, CoreSubMeshPtrC submesh);
+        typedef std::vector< std::vector<std::size_t> > FaceClusters;
+
+        /// \internal
+        struct FlatSubMesh;
+
+        /// \internal
+        /// Copies everything we need from \a submesh into flat arrays, checking
+        /// its faces and vertices on the fly.
+        void flatten(FlatSubMesh& flat, CoreSubMeshPtrC submesh, const std::string& meshName, unsigned int bonesPerMesh, unsigned char bonesPerVertex, unsigned char verticesPerFace) const;
 
         /// \internal
-        void addVertex(Vertex vtx, unsigned char bonesPerVertex, const std::string& submeshDiagnosticName);
+        /// Splits the (valid) faces of a submesh into groups of faces that each
+        /// fit into one hardware submesh, using the given \a method.
+        FaceClusters partition(const FlatSubMesh& flat, unsigned int bonesPerMesh, PartitionMethod method) const;
+
+        /// \internal
+        /// Splits the (valid) faces of a submesh so that as many as possible go
+        /// into clusters using the bone palette of a hardware submesh of \a reference.
+        /// \param palettes Receives the palette to use for each of the first clusters.
+        FaceClusters partitionLike(FlatSubMesh& flat, const Name& submeshName, const CoreHardwareMesh& reference, std::vector<const CoreHardwareSubMesh*>& palettes) const;
+
+        /// \internal
+        /// Adds a hardware submesh for each cluster of faces, with all their
+        /// vertices, to our buffers. If a cluster has an entry in \a palettes,
+        /// its hardware submesh starts out with exactly that bone palette.
+        void emit(const FlatSubMesh& flat, const Name& submeshName, const FaceClusters& clusters, const std::vector<const CoreHardwareSubMesh*>& palettes);
 
     private:
         /// We might need to split this mesh into submeshes. Here they are.
@@ -348,13 +479,25 @@ namespace bouge {
         GenericAttribsCoords m_genericAttribCoordCount;
 
         /// These are all the vertex indices of the triangle faces.
-        std::vector<BOUGE_FACE_INDEX_TYPE> m_faceIndices;
+        std::vector<Uint32> m_faceIndices;
 
         /// The amount of weights (bone influences) each vertex has.
         unsigned int m_weightsPerVertex;
 
         /// The amount of vertices each face has.
         unsigned int m_verticesPerFace;
+
+        /// How the submeshes have been split.
+        PartitionMethod m_partitionMethod;
+
+        /// How many vertices have been duplicated at the splits.
+        std::size_t m_duplicatedVertexCount;
+
+        /// The maximal number of bones per hardware submesh.
+        unsigned int m_bonesPerMesh;
+
+        /// The hash of the mesh this has been built from.
+        Uint32 m_sourceHash;
     };
 
 } // namespace bouge
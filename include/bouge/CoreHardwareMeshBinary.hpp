@@ -0,0 +1,161 @@
+////////////////////////////////////////////////////////////
+//
+// Bouge - Modern and flexible skeletal animation library
+// Copyright (C) 2010 Lucas Beyer (pompei2@gmail.com)
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it freely,
+// subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+////////////////////////////////////////////////////////////
+#ifndef BOUGE_COREHARDWAREMESHBINARY_HPP
+#define BOUGE_COREHARDWAREMESHBINARY_HPP
+
+#include <bouge/bougefwd.hpp>
+#include <bouge/CoreHardwareMesh.hpp>
+
+#include <string>
+
+namespace bouge {
+
+    // This is the layout of a prebuilt hardware mesh as written by
+    // CoreHardwareMesh::saveBinary. It is made to be memory-mapped and used
+    // right away: all numbers are 32 bit in the byte order of the machine that
+    // wrote it, every section starts 16-byte aligned and is located by its
+    // offset in bytes from the beginning of the data. The vertex and index
+    // sections can be handed to the graphics card as they are.
+    //
+    // The sections follow each other in this order:
+    //
+    // header | streams | submeshes | palette | strings | vertices | indices
+
+    /// The header of a prebuilt hardware mesh, found at the very beginning.
+    struct BOUGE_API CoreHardwareMeshBinaryHeader
+    {
+        char magic[8];             ///< Always "BOUGEHWM".
+        Uint32 version;            ///< The version of the layout, see CoreHardwareMeshBinary::version.
+        Uint32 byteOrderMark;      ///< 0x01020304 in the byte order of the writer.
+
+        // The key: from what and how this hardware mesh has been built.
+        Uint32 sourceHash;         ///< CoreMesh::contentHash of the source mesh.
+        Uint32 bonesPerMesh;
+        Uint32 bonesPerVertex;
+        Uint32 verticesPerFace;
+        Uint32 partitionMethod;    ///< A CoreHardwareMesh::PartitionMethod.
+
+        Uint32 vertexCount;
+        Uint32 vertexStride;       ///< The size of one interleaved vertex, in bytes.
+        Uint32 indexCount;
+        Uint32 indexSize;          ///< The size of one index, in bytes: the narrowest possible, 2 or 4.
+        Uint32 duplicatedVertexCount;
+
+        Uint32 streamCount;
+        Uint32 streamsOffset;      ///< streamCount CoreHardwareMeshBinaryStream
+        Uint32 submeshCount;
+        Uint32 submeshesOffset;    ///< submeshCount CoreHardwareMeshBinarySubMesh
+        Uint32 paletteSize;
+        Uint32 paletteOffset;      ///< paletteSize Uint32 string offsets: the bone names.
+        Uint32 stringsSize;
+        Uint32 stringsOffset;      ///< Zero-terminated strings.
+        Uint32 verticesOffset;     ///< vertexCount interleaved vertices of vertexStride bytes.
+        Uint32 indicesOffset;      ///< indexCount indices of indexSize bytes.
+        Uint32 totalSize;          ///< The size of the whole thing, in bytes.
+    };
+
+    /// Describes one of the streams (vertex attributes) interleaved in the
+    /// vertex section. The first three are always the coordinates ("pos"),
+    /// the weights ("weights") and the bone indices ("bones"), then come
+    /// the generic attributes.
+    struct BOUGE_API CoreHardwareMeshBinaryStream
+    {
+        Uint32 name;               ///< Offset of the name in the strings section.
+        Uint32 coordCount;         ///< The number of floats of this stream per vertex.
+        Uint32 offsetInVertex;     ///< Where this stream is located in a vertex, in bytes.
+    };
+
+    /// Describes one of the hardware submeshes.
+    struct BOUGE_API CoreHardwareMeshBinarySubMesh
+    {
+        Uint32 name;               ///< Offset of the name of the original submesh in the strings section.
+        Uint32 startIndex;
+        Uint32 faceCount;
+        Uint32 baseVertex;         ///< The first vertex used by this submesh.
+        Uint32 vertexCount;        ///< How many vertices, starting at baseVertex, this submesh uses.
+        Uint32 firstBone;          ///< Index of the first bone of the bone-palette in the palette section.
+        Uint32 boneCount;
+    };
+
+    /// A read-only view on a prebuilt hardware mesh lying in memory, for example
+    /// a memory-mapped file. It neither copies nor owns the data, which thus
+    /// needs to live at least as long as the view. The data needs to be aligned
+    /// to (at least) four bytes, something mapped files always are.
+    class BOUGE_API CoreHardwareMeshBinary
+    {
+    public:
+        /// The current version of the layout.
+        static const Uint32 version;
+
+        /// Checks the data and creates the view on it.
+        /// \param pData Where the prebuilt hardware mesh lies in memory.
+        /// \param size The size of the data in bytes.
+        /// \exception BadDataException if the data is not a complete prebuilt
+        ///            hardware mesh written by this version of bouge on a
+        ///            machine with the same byte order, or if any of its face
+        ///            indices lies outside of the vertices of its submesh.
+        CoreHardwareMeshBinary(const void* pData, std::size_t size);
+        virtual ~CoreHardwareMeshBinary();
+
+        /// \return Whether this has been built from the \a coremesh with exactly
+        ///         these parameters. If not, it is stale and should be rebuilt.
+        bool isBuiltFrom(CoreMeshPtrC coremesh, unsigned int bonesPerMesh, unsigned char bonesPerVertex = 4, unsigned char verticesPerFace = 3, CoreHardwareMesh::PartitionMethod method = CoreHardwareMesh::PartitionGreedy) const;
+
+        const CoreHardwareMeshBinaryHeader& header() const;
+
+        std::size_t streamCount() const;
+        const CoreHardwareMeshBinaryStream& stream(std::size_t idx) const;
+        std::string streamName(std::size_t idx) const;
+
+        std::size_t submeshCount() const;
+        const CoreHardwareMeshBinarySubMesh& submesh(std::size_t idx) const;
+        std::string submeshName(std::size_t idx) const;
+
+        /// \return The name of the bone at index \a idInSubmesh of the bone-palette of submesh \a submeshIdx.
+        std::string boneName(std::size_t submeshIdx, std::size_t idInSubmesh) const;
+
+        std::size_t vertexCount() const;
+        std::size_t vertexStride() const;
+
+        /// \return The interleaved vertices, ready to be sent to the graphics card.
+        const void* vertices() const;
+
+        std::size_t indexCount() const;
+        std::size_t indexSize() const;
+
+        /// \return The face indices, ready to be sent to the graphics card.
+        ///         They are indexSize() bytes each and absolute, that is not
+        ///         relative to the base vertex of their submesh.
+        const void* indices() const;
+
+    private:
+        std::string string(Uint32 offset) const;
+
+        const unsigned char* m_pData;
+        std::size_t m_size;
+    };
+
+} // namespace bouge
+
+#endif // BOUGE_COREHARDWAREMESHBINARY_HPP
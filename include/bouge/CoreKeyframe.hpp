@@ -39,8 +39,6 @@ namespace bouge {
         CoreKeyframe(Quaternion rotation, Vector translation, Vector scale);
         virtual ~CoreKeyframe();
 
-        BOUGE_USER_DATA;
-
         bool hasRotation() const;
         Quaternion rotation() const;
         CoreKeyframe& rotation(Quaternion q);
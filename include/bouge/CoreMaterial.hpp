@@ -56,8 +56,8 @@ namespace bouge {
 
         BOUGE_USER_DATA;
 
-        std::string name() const;
-        CoreMaterial& name(std::string name);
+        const Name& name() const;
+        CoreMaterial& name(const Name& name);
 
         bool hasProprety(const std::string& name) const;
         const std::string& proprety(const std::string& name) const;
@@ -118,7 +118,7 @@ namespace bouge {
         const_iterator end() const;
 
     private:
-        std::string m_sName;
+        Name m_name;
 
         PropretyMap m_propreties;
     };
@@ -27,7 +27,11 @@
 #include <bouge/bougefwd.hpp>
 #include <bouge/Vertex.hpp>
 #include <bouge/Face.hpp>
+#include <bouge/Span.hpp>
 
+#include <map>
+#include <string>
+#include <utility>
 #include <vector>
 
 namespace bouge {
@@ -37,38 +41,192 @@ namespace bouge {
     /// some more properties. You should not use it to render your model,
     /// it is only useful for higher-level processing.
     /// To render your model, create a CoreHardwareMesh.
+    ///
+    /// The vertices are not stored as Vertex objects, but as a structure of
+    /// arrays: one array for the positions, one per generic attribute and the
+    /// influences as bone ids and weights, the bone names being stored only
+    /// once per submesh. The Vertex objects you give and get are built from
+    /// and taken apart into those, so better use the Span accessors when
+    /// going through many vertices.
+    ///
+    /// The same goes for the faces: their vertex indices are all stored one
+    /// after the other in a single array. As long as all faces are triangles,
+    /// that's all there is, else we additionally store where each face starts.
     class BOUGE_API CoreSubMesh
     {
+        struct AttribStream
+        {
+            /// How many floats each vertex has in this attribute.
+            std::size_t coordCount;
+
+            /// coordCount floats per vertex, zeros for those not having it.
+            std::vector<float> coords;
+
+            /// Whether each vertex has this attribute.
+            std::vector<bool> present;
+        };
+        typedef std::map<std::string, AttribStream> AttribStreams;
     public:
         CoreSubMesh(std::string name);
         virtual ~CoreSubMesh();
 
         BOUGE_USER_DATA;
 
-        std::string name() const;
-        CoreSubMesh& name(std::string name);
+#if BOUGE_USE_USERDATA
+        /// User data of the vertices, keyed by the index of the vertex.
+        UserDataTable<std::size_t> vertexUserData;
+        /// User data of the influences, keyed by the index of the vertex and
+        /// the index of the influence within that vertex.
+        UserDataTable<std::pair<std::size_t, std::size_t> > influenceUserData;
+        /// User data of the faces, keyed by the index of the face.
+        UserDataTable<std::size_t> faceUserData;
+#endif
+
+        const Name& name() const;
+        CoreSubMesh& name(const Name& name);
 
         std::size_t vertexCount() const;
         std::size_t faceCount() const;
 
+        /// \exception std::invalid_argument in case one of the vertex's attributes
+        ///            has another size than the same attribute of the other vertices.
         CoreSubMesh& addVertex(Vertex vert);
         Vertex vertex(std::size_t idx) const;
+        /// \exception std::invalid_argument in case one of the vertex's attributes
+        ///            has another size than the same attribute of the other vertices.
         CoreSubMesh& vertex(std::size_t idx, Vertex vtx);
 
+        /// \return The coordinates of all vertices, three per vertex.
+        Span<float> positions() const;
+
+        /// \return The three coordinates of the vertex at index \a idx.
+        /// \exception std::out_of_range in case there is no vertex at the specified index.
+        Span<float> position(std::size_t idx) const;
+
+        /// \return The names of all the generic attributes any of the vertices has.
+        std::vector<std::string> attribNames() const;
+
+        /// \return true if any of the vertices has a generic attribute called \a name.
+        bool hasAttrib(const std::string& name) const;
+
+        /// \return The number of floats every vertex has in the attribute \a name.
+        /// \exception std::invalid_argument in case no vertex has such an attribute.
+        std::size_t attribCoordCount(const std::string& name) const;
+
+        /// \return The attribute \a name of all vertices, attribCoordCount(name)
+        ///         floats per vertex. It is all zeros for vertices not having it.
+        /// \exception std::invalid_argument in case no vertex has such an attribute.
+        Span<float> attribs(const std::string& name) const;
+
+        /// \return The attribute \a name of the vertex at index \a idx.
+        /// \exception std::invalid_argument in case no vertex has such an attribute.
+        /// \exception std::out_of_range in case there is no vertex at the specified index.
+        Span<float> attrib(const std::string& name, std::size_t idx) const;
+
+        /// \return true if the vertex at index \a idx has the attribute \a name.
+        /// \exception std::out_of_range in case there is no vertex at the specified index.
+        bool vertexHasAttrib(const std::string& name, std::size_t idx) const;
+
+        /// \return The number of different bones influencing the vertices.
+        std::size_t boneCount() const;
+
+        /// \return The name of the bone whose id (in this submesh) is \a id.
+        /// \exception std::out_of_range in case there is no bone with that id.
+        const Name& boneName(Uint32 id) const;
+
+        /// \return For every vertex, the index into influenceBones() and
+        ///         influenceWeights() where its influences start. There is one
+        ///         more entry at the end, so the influences of vertex i end
+        ///         where those of vertex i+1 start.
+        Span<Uint32> influenceStarts() const;
+
+        /// \return The ids of the bones of all influences of all vertices, see boneName.
+        Span<Uint32> influenceBones() const;
+
+        /// \return The weights of all influences of all vertices.
+        Span<float> influenceWeights() const;
+
+        /// \return The ids of the bones influencing the vertex at index \a idx.
+        /// \exception std::out_of_range in case there is no vertex at the specified index.
+        Span<Uint32> influenceBones(std::size_t idx) const;
+
+        /// \return The weights of the influences of the vertex at index \a idx.
+        /// \exception std::out_of_range in case there is no vertex at the specified index.
+        Span<float> influenceWeights(std::size_t idx) const;
+
         bool canAddFace(const Face& face, Face::index_t* out_pFailing = 0) const;
         CoreSubMesh& addFace(Face face);
         Face face(std::size_t idx) const;
         CoreSubMesh& face(std::size_t idx, Face vtx);
 
+        /// Adds many triangles at once.
+        /// \param indices The three vertex indices of every triangle, one after the other.
+        /// \return A reference to the current object for chaining operation.
+        /// \exception std::invalid_argument in case the number of indices isn't
+        ///            a multiple of three or one of them is a too big vertex index.
+        ///            In that case, none of the triangles is added.
+        CoreSubMesh& addTriangles(Span<Uint32> indices);
+
+        /// \return The vertex indices of all faces, one after the other. In
+        ///         case allFacesAreTriangles, that's three per face.
+        Span<Uint32> faceIndices() const;
+
+        /// \return The vertex indices of the face at index \a idx.
+        /// \exception std::out_of_range in case there is no face at the specified index.
+        Span<Uint32> faceIndices(std::size_t idx) const;
+
         bool allFacesAreTriangles() const;
 
+        /// \return A hash of all the data of this submesh: its name, vertices
+        ///         (with all influences and attributes) and faces. Use it to
+        ///         find out if data built from this submesh is outdated.
+        Uint32 contentHash() const;
+
     private:
-        std::string m_sName;
+        /// \internal
+        /// \exception std::invalid_argument in case one of the attributes of
+        ///            \a vtx doesn't have the same size as in our streams.
+        void checkAttribs(const Vertex& vtx) const;
+
+        /// \internal
+        /// Stores the attributes of \a vtx as those of vertex \a idx, which
+        /// must already have its (zeroed) place in all the streams.
+        void storeAttribs(std::size_t idx, const Vertex& vtx);
 
-        std::vector<Vertex> m_verts;
-        std::vector<Face> m_faces;
+        /// \internal
+        /// \return The id of the bone \a name, adding it if it isn't known yet.
+        Uint32 boneId(const Name& name);
 
-        bool m_bAllFacesAreTriangles;
+        Name m_name;
+
+        /// Three coordinates per vertex.
+        std::vector<float> m_positions;
+
+        /// One stream per generic attribute.
+        AttribStreams m_attribs;
+
+        /// The influences of vertex i are those from m_influenceStarts[i] to m_influenceStarts[i+1].
+        std::vector<Uint32> m_influenceStarts;
+        std::vector<Uint32> m_influenceBones;
+        std::vector<float> m_influenceWeights;
+
+        /// The bone names, by their id in this submesh.
+        std::vector<Name> m_boneNames;
+        std::map<Name, Uint32> m_boneIds;
+
+        /// \internal
+        /// Starts storing where each face starts, as not all of them will be triangles anymore.
+        void storeFaceStarts();
+        /// \internal
+        /// Stops storing where each face starts if all of them are triangles again.
+        void dropFaceStartsIfAllTriangles();
+
+        /// The vertex indices of all the faces, one after the other.
+        std::vector<Uint32> m_faceIndices;
+
+        /// Where each face starts in m_faceIndices, plus where the next one
+        /// would start. Empty as long as all faces are triangles.
+        std::vector<Uint32> m_faceStarts;
     };
 
     /// The core mesh class in fact is just a container of \a CoreSubMesh objects.
@@ -92,6 +250,10 @@ namespace bouge {
         std::size_t faceCount() const;
         bool allFacesAreTriangles() const;
 
+        /// \return A hash of all the data of all submeshes of this mesh.
+        /// \see CoreSubMesh::contentHash
+        Uint32 contentHash() const;
+
         CoreMesh& add(CoreSubMeshPtr submesh);
         std::size_t submeshCount() const;
         bool hasSubmesh(const std::string& name) const;
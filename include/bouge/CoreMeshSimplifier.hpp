@@ -0,0 +1,121 @@
+////////////////////////////////////////////////////////////
+//
+// Bouge - Modern and flexible skeletal animation library
+// Copyright (C) 2010 Lucas Beyer (pompei2@gmail.com)
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it freely,
+// subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+////////////////////////////////////////////////////////////
+#ifndef BOUGE_COREMESHSIMPLIFIER_HPP
+#define BOUGE_COREMESHSIMPLIFIER_HPP
+
+#include <bouge/bougefwd.hpp>
+
+#include <vector>
+
+namespace bouge {
+
+    /// This class creates levels of detail (LODs) of a CoreMesh by simplifying
+    /// it, that is by removing vertices and faces, trying to change its
+    /// shape as little as possible. Use it for models seen from far away,
+    /// where the full detail would be a waste of vertices.
+    ///
+    /// It works by repeatedly collapsing the edge whose removal changes the
+    /// surface least, measured with quadric error metrics (Garland & Heckbert).
+    /// Every submesh is simplified on its own, and its name is kept, so that
+    /// the materials still apply. The edges at the border of a submesh (and at
+    /// seams, where vertices are duplicated for different attributes) are
+    /// held in place by an additional error term, see boundaryWeight.
+    ///
+    /// The generic attributes and the bone influences of the vertices that
+    /// remain are interpolated from the two vertices of each collapsed edge.
+    ///
+    /// To render a LOD, create its CoreHardwareMesh using the constructor that
+    /// takes the hardware mesh of the full-detail mesh, so they share the bone
+    /// palettes.
+    ///
+    /// \note Submeshes that are not made of triangles only are copied as-is.
+    class BOUGE_API CoreMeshSimplifier
+    {
+    public:
+        CoreMeshSimplifier();
+        virtual ~CoreMeshSimplifier();
+
+        BOUGE_USER_DATA;
+
+        /// \return How much a difference in the generic attributes (for example
+        ///         texture coordinates) of the two vertices of an edge counts
+        ///         against collapsing it, compared to the change of shape.
+        float attribWeight() const;
+
+        /// \param weight How much a difference in the generic attributes counts
+        ///               against collapsing an edge. 0 ignores the attributes.
+        /// \return A reference to the current object for chaining operation.
+        CoreMeshSimplifier& attribWeight(float weight);
+
+        /// \return How strongly the borders of the submeshes are held in place.
+        float boundaryWeight() const;
+
+        /// \param weight How strongly the borders of the submeshes are held in
+        ///               place. 0 lets them move just like the rest, which
+        ///               opens up holes between submeshes and at seams.
+        /// \return A reference to the current object for chaining operation.
+        CoreMeshSimplifier& boundaryWeight(float weight);
+
+        /// \return The maximal number of bones a face of the result may be
+        ///         influenced by, 0 meaning no limit.
+        unsigned int maxBonesPerFace() const;
+
+        /// \param bones The maximal number of bones a face may be influenced by.
+        ///              Set this to the bonesPerMesh of your hardware meshes,
+        ///              as they can't handle faces with more bones than that.
+        ///              0 means no limit.
+        /// \return A reference to the current object for chaining operation.
+        CoreMeshSimplifier& maxBonesPerFace(unsigned int bones);
+
+        /// Creates a simplified version of a mesh.
+        /// \param source The mesh to simplify. It is not modified.
+        /// \param ratio How many of the faces of every submesh to keep, from 0 to 1.
+        ///              If the mesh can't be simplified that much without
+        ///              breaking it, the result has more faces.
+        /// \return The simplified mesh.
+        CoreMeshPtr simplify(CoreMeshPtrC source, float ratio) const;
+
+        /// Creates a chain of levels of detail of a mesh, each one with
+        /// \a ratioPerLevel times as many faces as the previous one. This is
+        /// much faster than calling simplify for each level.
+        /// \param source The mesh to simplify. It is not part of the result.
+        /// \param levelCount How many levels of detail to create.
+        /// \param ratioPerLevel How many of the faces of the previous level to keep.
+        /// \return The \a levelCount levels of detail, from the most to the least detailed.
+        std::vector<CoreMeshPtr> buildLODChain(CoreMeshPtrC source, std::size_t levelCount, float ratioPerLevel = 0.5f) const;
+
+    private:
+        /// \internal
+        /// Simplifies one submesh, creating one simplified submesh for each
+        /// of the face counts in \a faceTargets, which must be decreasing.
+        std::vector<CoreSubMeshPtr> simplify(CoreSubMeshPtrC source, const std::vector<std::size_t>& faceTargets) const;
+
+        float m_attribWeight;
+        float m_boundaryWeight;
+        unsigned int m_maxBonesPerFace;
+    };
+
+} // namespace bouge
+
+#endif // BOUGE_COREMESHSIMPLIFIER_HPP
@@ -25,6 +25,7 @@
 #define BOUGE_COREMODEL_HPP
 
 #include <bouge/bougefwd.hpp>
+#include <bouge/CoreHardwareMesh.hpp>
 
 #include <map>
 #include <set>
@@ -38,7 +39,7 @@ namespace bouge {
     {
         typedef std::map<std::string, CoreMaterialPtr> MaterialMap;
         typedef std::map<std::string, CoreMaterialSetPtr> MaterialSetMap;
-        typedef std::map<std::string, CoreAnimationPtr> AnimationMap;
+        typedef std::map<Name, CoreAnimationPtr> AnimationMap;
     public:
         CoreModel(std::string name);
         virtual ~CoreModel();
@@ -165,12 +166,15 @@ namespace bouge {
         const_materialset_iterator begin_materialset() const;
         const_materialset_iterator end_materialset() const;
 
+        bool hasAnimation(const Name& name) const;
+        /// Doesn't add \a name to the name table, unlike converting it to a Name.
         bool hasAnimation(const std::string& name) const;
-        CoreAnimationPtr animation(const std::string& name);
-        CoreAnimationPtrC animation(const std::string& name) const;
+        bool hasAnimation(const char* name) const;
+        CoreAnimationPtr animation(const Name& name);
+        CoreAnimationPtrC animation(const Name& name) const;
         CoreModel& addAnimation(CoreAnimationPtr mat);
         CoreModel& addAnimations(const std::vector<CoreAnimationPtr>& mats);
-        CoreModel& removeAnimation(const std::string& name);
+        CoreModel& removeAnimation(const Name& name);
         std::size_t animationCount() const;
 
         class BOUGE_API animation_iterator {
@@ -223,7 +227,9 @@ namespace bouge {
         std::set<std::string> missingMaterials(const std::string& in_restrictToMatset = "") const;
         std::set<std::string> missingMatsetSpecs(const std::string& in_restrictToMatset = "") const;
         bool isComplete() const;
-        CoreHardwareMeshPtr buildHardwareMesh(unsigned int bonesPerMesh, unsigned char bonesPerVertex = 4, unsigned char verticesPerFace = 3) const;
+        /// \exception NotExistException if a bone influencing the mesh isn't in the skeleton.
+        BoneBoundsPtr buildBoneBounds() const;
+        CoreHardwareMeshPtr buildHardwareMesh(unsigned int bonesPerMesh, unsigned char bonesPerVertex = 4, unsigned char verticesPerFace = 3, CoreHardwareMesh::PartitionMethod method = CoreHardwareMesh::PartitionGreedy) const;
 
     private:
         std::string m_sName;
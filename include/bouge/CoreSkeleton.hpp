@@ -34,7 +34,7 @@ namespace bouge {
 
     class BOUGE_API CoreSkeleton
     {
-        typedef std::map<std::string, BoneId> BoneNamesMap;
+        typedef std::map<Name, BoneId> BoneNamesMap;
         typedef std::vector<CoreBonePtr> BoneMap;
         typedef std::vector<BoneId> RootBoneNames;
     public:
@@ -48,13 +48,16 @@ namespace bouge {
 
         CoreSkeleton& addRootBone(CoreBonePtr bone);
 
+        bool hasBone(const Name& name) const;
+        /// Doesn't add \a name to the name table, unlike converting it to a Name.
         bool hasBone(const std::string& name) const;
+        bool hasBone(const char* name) const;
         /// \exception NotExistException
-        BoneId boneId(const std::string& name) const;
+        BoneId boneId(const Name& name) const;
         /// \exception NotExistException
-        CoreBonePtr bone(const std::string& name);
+        CoreBonePtr bone(const Name& name);
         /// \exception NotExistException
-        CoreBonePtrC bone(const std::string& name) const;
+        CoreBonePtrC bone(const Name& name) const;
         /// \exception NotExistException
         CoreBonePtr bone(const BoneId& id);
         /// \exception NotExistException
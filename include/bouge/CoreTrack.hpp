@@ -38,20 +38,74 @@ namespace bouge {
     {
         typedef std::map<float, CoreKeyframePtr> KeyframeMap;
     public:
+        /// The ways the keyframes of a track are interpolated in between.
+        enum Interpolation {
+            /// Translations and scales are interpolated linearly, rotations
+            /// using slerp. Smooth motion needs many keyframes.
+            InterpolationLinear,
+
+            /// Translations and scales follow a Catmull-Rom spline (a cubic
+            /// Hermite spline whose tangents come from the neighbouring
+            /// keyframes), rotations use squad. The motion passes through all
+            /// the keyframes smoothly, thus way less keyframes are needed.
+            InterpolationSpline
+        };
+
         CoreTrack();
         virtual ~CoreTrack();
 
-        BOUGE_USER_DATA;
-
-        bool hasRotation() const;
-        Quaternion rotation(float time) const;
-        bool hasTranslation() const;
-        Vector translation(float time) const;
-        bool hasScale() const;
-        Vector scale(float time) const;
-
-        std::size_t keyframeCount() const;
-        float duration() const;
+#if BOUGE_USE_USERDATA
+        /// User data of the keyframes, keyed by the keyframe itself (\c i.keyframe().get()),
+        /// so that it stays attached to its keyframe even if the keyframe's time changes.
+        UserDataTable<const CoreKeyframe*> keyframeUserData;
+#endif
+
+        // Sampling is virtual so that other ways of storing keyframes, like
+        // CompressedCoreTrack or ResampledCoreTrack, can be used wherever a track is.
+        virtual bool hasRotation() const;
+        virtual Quaternion rotation(float time) const;
+        virtual bool hasTranslation() const;
+        virtual Vector translation(float time) const;
+        virtual bool hasScale() const;
+        virtual Vector scale(float time) const;
+
+        virtual std::size_t keyframeCount() const;
+        virtual float duration() const;
+
+        /// \return How the keyframes are interpolated, linear by default.
+        Interpolation interpolation() const;
+
+        /// \param mode How to interpolate the keyframes.
+        /// \return A reference to the current object for chaining operation.
+        CoreTrack& interpolation(Interpolation mode);
+
+        /// Flips the rotation of keyframes so that each one lies in the same
+        /// hemisphere as the one before. As q and -q are the same rotation,
+        /// this changes nothing but the way interpolation goes: always the
+        /// shortest one. It also allows sampling to use the fast
+        /// Quaternion::fastSlerp instead of slerp. This is done at load-time.
+        /// \note Any change to the keyframes undoes this, so call it again
+        ///       after having modified the track.
+        /// \return A reference to the current object for chaining operation.
+        CoreTrack& alignRotations();
+
+        /// \return Whether the rotations are aligned, see alignRotations.
+        bool rotationsAligned() const;
+
+        /// Looks for rotations, translations and scales that stay the same
+        /// throughout the whole track. These are sampled from a single value
+        /// from now on, without looking for keyframes. Those that are the
+        /// identity (no rotation, no translation, a scale of 1) are dropped
+        /// altogether, so that hasRotation, hasTranslation or hasScale tell
+        /// they are not there and the mixer skips them. This is done at
+        /// load-time.
+        /// \note Adding or modifying keyframes undoes this, so call it again
+        ///       after having modified the track. Removing them does not.
+        /// \param tolerance How much any component of a rotation, translation
+        ///                  or scale may differ from the one of the first
+        ///                  keyframe for it to still be the same.
+        /// \return A reference to the current object for chaining operation.
+        CoreTrack& detectConstants(float tolerance = 1e-5f);
 
         class BOUGE_API iterator {
         public:
@@ -73,8 +127,11 @@ namespace bouge {
             KeyframeMap::iterator myIter;
         };
 
+        // Editing is virtual so that tracks which don't hold any keyframe,
+        // like CompressedCoreTrack or ResampledCoreTrack, can refuse it.
+
         /// \return An iterator pointing at the first keyframe.
-        iterator begin();
+        virtual iterator begin();
 
         /// Get the keyframe that is the closest to a given \a time.
         /// \note If the given \a time is behind the last keyframe or in front of
@@ -82,12 +139,12 @@ namespace bouge {
         ///       respectively.
         /// \param time The time to which you want to get the closest keyframe.
         /// \return An iterator pointing at the closes keyframe to \a time.
-        iterator closest(float time);
+        virtual iterator closest(float time);
 
         /// Get the first keyframe that is strictly greater than \a time.
         /// \param time The time after which the keyframe should be.
         /// \return The first keyframe encountered right after \a time.
-        iterator after(float time);
+        virtual iterator after(float time);
 
         /// \return An iterator pointing behind the last keyframe.
         iterator end();
@@ -131,26 +188,59 @@ namespace bouge {
         /// \return An iterator pointing behind the last keyframe.
         const_iterator end() const;
 
-        CoreTrack& add(float time, CoreKeyframePtr keyframe);
-        CoreTrack& remove(iterator who);
-        CoreTrack& removeAllIn(float start, float end);
+        virtual CoreTrack& add(float time, CoreKeyframePtr keyframe);
+        virtual CoreTrack& remove(iterator who);
+        virtual CoreTrack& removeAllIn(float start, float end);
 
-        // We could add crazy stuff like compression, collapsing close keyframes, ...
+        // We could add crazy stuff like collapsing close keyframes, ...
         // but we'll only do this when really needed by someone...
+        // For compression, see CompressedCoreTrack, for sampling at a fixed
+        // rate, see ResampledCoreTrack.
 
     protected:
         CoreTrack& updateDuration();
 
+        /// \internal
+        /// Interpolates between the translations or scales \a from and \a to
+        /// along a Catmull-Rom spline, \a prev and \a next being their
+        /// neighbours (or \a from and \a to themselves at the ends).
+        static Vector spline(const Vector& prev, const Vector& from, const Vector& to, const Vector& next,
+                             float tPrev, float tFrom, float tTo, float tNext, float between);
+
+        /// \internal
+        /// Interpolates between the rotations \a from and \a to using squad,
+        /// \a prev and \a next being their neighbours (or \a from and \a to
+        /// themselves at the ends).
+        static Quaternion spline(const Quaternion& prev, const Quaternion& from, const Quaternion& to, const Quaternion& next,
+                                 float tPrev, float tFrom, float tTo, float tNext, float between);
+
     private:
+        /// \internal What detectConstants found out about a channel.
+        enum Channel {
+            ChannelAnimated,
+            ChannelConstant,
+            ChannelIdentity
+        };
+
         KeyframeMap m_keyframes;
         float m_duration;
 
         const_iterator closestInImpl(float time, float tolerance) const;
         const_iterator closestImpl(float time) const;
+        void keyframesChanged();
 
         bool m_bHasTranslation;
         bool m_bHasRotation;
         bool m_bHasScale;
+        bool m_bRotationsAligned;
+        Interpolation m_interpolation;
+
+        Channel m_rotChannel;
+        Channel m_transChannel;
+        Channel m_scaleChannel;
+        Quaternion m_constRot;
+        Vector m_constTrans;
+        Vector m_constScale;
     };
 
 } // namespace bouge
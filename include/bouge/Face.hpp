@@ -38,8 +38,6 @@ namespace bouge {
     public:
         typedef std::size_t index_t;
 
-        BOUGE_USER_DATA;
-
         /// Creates an arbitrary polygon (aka N-Gon) using the given vertex indices.
         /// \param vertexIndices The indices of the vertexes to use.
         Face(const std::vector<index_t>& vertexIndices);
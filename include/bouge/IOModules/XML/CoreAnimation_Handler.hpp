@@ -52,6 +52,8 @@ namespace bouge {
         void keyframeStart(const XMLAttributes& attributes);
         void keyframeEnd();
 
+        void markerStart(const XMLAttributes& attributes);
+
     private:
         std::vector<CoreAnimationPtr>& m_animsToLoad;
 
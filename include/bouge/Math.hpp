@@ -24,6 +24,8 @@
 #ifndef BOUGE_MATH_HPP
 #define BOUGE_MATH_HPP
 
+#include <bouge/Math/BoundingVolume.hpp>
+#include <bouge/Math/DualQuaternion.hpp>
 #include <bouge/Math/Matrix.hpp>
 #include <bouge/Math/Quaternion.hpp>
 #include <bouge/Math/Util.hpp>
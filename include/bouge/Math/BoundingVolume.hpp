@@ -0,0 +1,115 @@
+////////////////////////////////////////////////////////////
+//
+// Bouge - Modern and flexible skeletal animation library
+// Copyright (C) 2010 Lucas Beyer (pompei2@gmail.com)
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it freely,
+// subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+////////////////////////////////////////////////////////////
+#ifndef BOUGE_BOUNDINGVOLUME_H
+#define BOUGE_BOUNDINGVOLUME_H
+
+#include <bouge/Config.hpp>
+
+#include <string>
+
+namespace bouge {
+    class Vector;
+    class Base4x4Matrix;
+
+/// This class represents an axis aligned bounding box. It may also be empty,
+/// that is contain not even a single point, which is what it is by default.\n
+/// It keeps its corners in plain floats so it can be extended and transformed
+/// without any allocation, as culling happens for lots of objects every frame.
+class BOUGE_API BoundingBox {
+public:
+    /// Creates an empty bounding box.
+    BoundingBox();
+    /// Creates a bounding box spanning from \a in_min to \a in_max.
+    BoundingBox(const Vector& in_min, const Vector& in_max);
+
+    /// \return true if the box doesn't contain any point.
+    bool empty() const;
+
+    /// \return The corner with the smallest coordinates.
+    Vector minCorner() const;
+    /// \return The corner with the biggest coordinates.
+    Vector maxCorner() const;
+    /// \return The point in the middle of the box.
+    Vector center() const;
+    /// \return Half the size of the box along each axis.
+    Vector halfExtents() const;
+
+    /// Grows the box so that it contains the point \a in_p too.
+    /// \return a reference to *this
+    BoundingBox& extend(const float in_p[3]);
+    /// Grows the box so that it contains the point \a in_v too.
+    /// \return a reference to *this
+    BoundingBox& extend(const Vector& in_v);
+    /// Grows the box so that it contains the box \a in_box too.
+    /// \return a reference to *this
+    BoundingBox& extend(const BoundingBox& in_box);
+
+    /// \return The smallest axis aligned box containing this box after it has
+    ///         been transformed by the affine transformation \a in_m.
+    BoundingBox transformed(const Base4x4Matrix& in_m) const;
+
+    /// \return A string-representation of the box.
+    /// \param in_iDecimalPlaces The amount of numbers to print behind the dot.
+    std::string to_s(unsigned int in_iDecimalPlaces = 2) const;
+
+private:
+    float m_min[3];
+    float m_max[3];
+};
+
+/// This class represents a bounding sphere. It may also be empty, which is
+/// what it is by default.
+class BOUGE_API BoundingSphere {
+public:
+    /// Creates an empty bounding sphere.
+    BoundingSphere();
+    /// Creates a sphere around \a in_center.
+    BoundingSphere(const Vector& in_center, float in_fRadius);
+
+    /// \return true if the sphere doesn't contain any point.
+    bool empty() const;
+
+    /// \return The center of the sphere.
+    Vector center() const;
+    /// \return The radius of the sphere.
+    float radius() const;
+
+    /// \return A sphere containing this sphere after it has been transformed
+    ///         by the affine transformation \a in_m. The radius is scaled by
+    ///         the biggest scaling factor of \a in_m, exactly for rotations
+    ///         and scales and by an upper bound of it under shear.
+    BoundingSphere transformed(const Base4x4Matrix& in_m) const;
+
+    /// \return A string-representation of the sphere.
+    /// \param in_iDecimalPlaces The amount of numbers to print behind the dot.
+    std::string to_s(unsigned int in_iDecimalPlaces = 2) const;
+
+private:
+    float m_center[3];
+    float m_radius;
+};
+
+} // namespace bouge
+
+#endif // BOUGE_BOUNDINGVOLUME_H
@@ -0,0 +1,118 @@
+////////////////////////////////////////////////////////////
+//
+// Bouge - Modern and flexible skeletal animation library
+// Copyright (C) 2010 Lucas Beyer (pompei2@gmail.com)
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it freely,
+// subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+////////////////////////////////////////////////////////////
+#ifndef BOUGE_DUALQUATERNION_H
+#define BOUGE_DUALQUATERNION_H
+
+#include <bouge/Config.hpp>
+
+#include <string>
+
+namespace bouge {
+    class Vector;
+    class Quaternion;
+
+/// This class represents a rigid transformation, that is a rotation followed by
+/// a translation, as a unit dual quaternion. It is made of two quaternions: the
+/// real part, which is the rotation, and the dual part, which holds the
+/// translation.\n
+/// Blending dual quaternions, as done in dual quaternion skinning, doesn't
+/// suffer from the "candy wrapper" collapse linear blending of matrices has at
+/// twisting joints. And they only take 8 floats instead of 16.
+/// \note Dual quaternions can't represent any scaling.
+class BOUGE_API DualQuaternion {
+public:
+    ////////////////////////////////////////////
+    // Constructors and assignment operators. //
+    ////////////////////////////////////////////
+
+    /// Creates the identity transformation.
+    DualQuaternion();
+    /// Creates a dual quaternion out of its eight components.
+    /// \param in_dq The real part (x, y, z, w) followed by the dual part (x, y, z, w).
+    DualQuaternion(const float in_dq[8]);
+    /// Creates a dual quaternion that first rotates by \a in_rot and then
+    /// translates by \a in_trans.
+    /// \param in_rot The rotation, it needs to be a unit quaternion.
+    /// \param in_trans The translation.
+    DualQuaternion(const Quaternion& in_rot, const Vector& in_trans);
+
+    ///////////////////////////////////////
+    // Conversion methods and operators. //
+    ///////////////////////////////////////
+
+    /// \return A read-only array of eight floats holding the real part
+    ///         (x, y, z, w) followed by the dual part (x, y, z, w).
+    inline const float *array8f() const {return &m_dq[0];};
+
+    /// \return A string-representation of the dual quaternion.
+    /// \param in_iDecimalPlaces The amount of numbers to print behind the dot.
+    std::string to_s(unsigned int in_iDecimalPlaces = 2) const;
+
+    /// \return The real part, that is the rotation.
+    Quaternion real() const;
+    /// \return The dual part.
+    Quaternion dual() const;
+    /// \return The translation, applied after the rotation.
+    Vector translation() const;
+
+    ///////////////////////////////////////////
+    // Basic dual quaternion calculations.   //
+    ///////////////////////////////////////////
+
+    /// Adds two dual quaternions component-wise, used for blending.
+    /// \note The result needs to be normalized in order to be a transformation again.
+    DualQuaternion operator +(const DualQuaternion& in_dq) const;
+    /// \param in_dq The dual quaternion to add to this one. The result is stored in this one.
+    void operator +=(const DualQuaternion& in_dq);
+    /// \returns This dual quaternion multiplied component-wise by \a in_f.
+    DualQuaternion operator *(float in_f) const;
+
+    /// Concatenates two transformations. Just as with matrices, the result
+    /// first applies \a in_dq and then this.
+    DualQuaternion operator *(const DualQuaternion& in_dq) const;
+
+    /// \return The dot product of the real parts. If it's negative, both
+    ///         represent their rotation on opposite hemispheres and one of
+    ///         them needs to be negated before blending them.
+    float dotReal(const DualQuaternion& in_dq) const;
+
+    /// Makes this a unit dual quaternion again, for example after blending.
+    /// \return a reference to *this
+    DualQuaternion& normalize();
+    /// \return A normalized copy of this dual quaternion.
+    DualQuaternion normalized() const;
+
+    /// Applies this transformation to a point, that is rotates and translates it.
+    Vector transform(const Vector& in_v) const;
+    /// Applies only the rotation of this transformation, as needed for normals.
+    Vector rotate(const Vector& in_v) const;
+
+private:
+    /// The real part (x, y, z, w) followed by the dual part (x, y, z, w).
+    float m_dq[8];
+};
+
+} // namespace bouge
+
+#endif // BOUGE_DUALQUATERNION_H
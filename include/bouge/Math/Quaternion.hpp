@@ -111,6 +111,10 @@ public:
 
     /// \return The angle of rotation.
     float angle() const;
+    /// \return The angle of the rotation taking \a in_q to this one, in
+    ///         [0 ; pi]. Unlike the angle of their quotient, this stays
+    ///         precise for tiny angles.
+    float angleTo(const Quaternion& in_q) const;
 
     /////////////////////////////////////
     // Accessors, getters and setters. //
@@ -246,6 +250,43 @@ public:
     ///       http://number-none.com/product/Understanding%20Slerp,%20Then%20Not%20Using%20It/
     Quaternion slerp(const Quaternion& v2, float between) const;
 
+    /// Approximation of slerp between this and v2: nlerp with a correction of
+    /// its speed, which makes it travel along the curve (nearly) at constant
+    /// speed, too. The angle differs from slerp's by less than 0.001 radians.
+    /// \param v2 The other quaternion with which to interpolate. It must lie in
+    ///           the same hemisphere as this, that is their dot product must
+    ///           not be negative.
+    /// \param between The time of interpolation, in [0, 1]. 0.0f results in this,
+    ///                1.0f results in \a v2. Use slerp to extrapolate.
+    /// \return A quaternion close to the one slerp would return.
+    /// \note This is way FASTER than slerp as it needs no trigonometry at all.
+    Quaternion fastSlerp(const Quaternion& v2, float between) const;
+
+    /// Spherical cubic interpolation ("squad") between this and \a v2, that
+    /// is a smooth curve through a whole sequence of rotations.
+    /// \param a1 The control point of this towards \a v2, see squadControl.
+    /// \param a2 The control point of \a v2 towards this, see squadControl.
+    /// \param v2 The other quaternion with which to interpolate.
+    /// \param between The time of interpolation. 0.0f results in this, 1.0f results in \a v2.
+    /// \return A quaternion resulting from the spherical cubic interpolation of this and \a v2, at time \a between.
+    Quaternion squad(const Quaternion& a1, const Quaternion& a2, const Quaternion& v2, float between) const;
+
+    /// \return The control point to use for squad from \a q towards \a next,
+    ///         so that the curve passing through \a prev, \a q and \a next
+    ///         is smooth at \a q. For the control point from \a q towards
+    ///         \a prev, swap both and use 1-\a towardsNext.
+    ///         At the ends of a sequence, just pass \a q as \a prev or \a next.
+    /// \param towardsNext Which part of the time from \a prev to \a next lies
+    ///                    between \a q and \a next, 0.5 if evenly spaced.
+    static Quaternion squadControl(const Quaternion& prev, const Quaternion& q, const Quaternion& next, float towardsNext = 0.5f);
+
+    /// \return The logarithm of this unit quaternion, that is its rotation
+    ///         axis scaled by half its rotation angle, with w being 0.
+    Quaternion log() const;
+    /// \return The exponential of this quaternion, whose w is assumed to be
+    ///          0. This is the inverse of log.
+    Quaternion exp() const;
+
     ///////////////////////////////////////
     // Quaternion comparison operations. //
     ///////////////////////////////////////
@@ -37,6 +37,13 @@ namespace bouge {
         virtual float operator()(float t) = 0;
         virtual TimeFunction* clone() const = 0;
         virtual ~TimeFunction() {};
+
+        /// \return The value the function approaches when coming to \a t from
+        ///         below. Functions jumping at \a t need to override this.
+        virtual float before(float t) {return (*this)(t);};
+        /// \return The value the function approaches when coming to \a t from
+        ///         above. Functions jumping at \a t need to override this.
+        virtual float after(float t) {return (*this)(t);};
     };
 
     /// This is just a constant over time. Looks like a straight line at height c.
@@ -89,6 +96,8 @@ namespace bouge {
         virtual ~RepeatTF();
         virtual float operator()(float t);
         virtual RepeatTF* clone() const;
+        virtual float before(float t);
+        virtual float after(float t);
 
         const TimeFunction* tf() const;
     private:
@@ -110,6 +119,8 @@ namespace bouge {
         virtual ~CycleTF();
         virtual float operator()(float t);
         virtual CycleTF* clone() const;
+        virtual float before(float t);
+        virtual float after(float t);
 
         const TimeFunction* tf() const;
     private:
@@ -131,6 +142,8 @@ namespace bouge {
         virtual ~HoldTF();
         virtual float operator()(float t);
         virtual HoldTF* clone() const;
+        virtual float before(float t);
+        virtual float after(float t);
 
         const TimeFunction* tf() const;
         float valueFrom() const;
@@ -32,6 +32,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 
 /// Threshold used for floating point comparisons. You may want to redefine it.
 #ifndef D_BOUGE_EPSILON
@@ -90,6 +91,47 @@ inline T fract(T full) {
     return full - (T)((long)full);
 }
 
+/// Converts a float to a IEEE 754 half precision float, rounding to the nearest
+/// and halfway cases away from zero.
+/// Values too big for a half become infinity, values too small become
+/// denormals or zero.
+/// \param in_f The value to convert.
+/// \return The 16 bits of the half precision float, ready to be sent to the graphics card.
+inline unsigned short toHalf(float in_f) {
+    unsigned int bits = 0;
+    std::memcpy(&bits, &in_f, sizeof(bits));
+
+    unsigned short sign = (unsigned short)((bits >> 16) & 0x8000u);
+    unsigned int mantissa = bits & 0x007fffffu;
+    int exponent = (int)((bits >> 23) & 0xffu) - 127 + 15;
+
+    // NaN stays NaN, infinity and too big values become infinity.
+    if(((bits >> 23) & 0xffu) == 0xffu)
+        return (unsigned short)(sign | 0x7c00u | (mantissa ? 0x200u : 0u));
+    if(exponent >= 31)
+        return (unsigned short)(sign | 0x7c00u);
+
+    // Too small even for a denormal.
+    if(exponent <= -11)
+        return sign;
+
+    if(exponent <= 0) {
+        // Denormal: shift the mantissa, including its implicit leading one.
+        mantissa |= 0x00800000u;
+        unsigned int shift = (unsigned int)(14 - exponent);
+        unsigned int half = mantissa >> shift;
+        if((mantissa >> (shift - 1)) & 1u)
+            ++half;
+        return (unsigned short)(sign | half);
+    }
+
+    // Rounding may carry into the exponent, which is just what we want.
+    unsigned int half = ((unsigned int)exponent << 10) | (mantissa >> 13);
+    if(mantissa & 0x00001000u)
+        ++half;
+    return (unsigned short)(sign | std::min(half, 0x7c00u));
+}
+
 /// Returns the next power of two value from \a in_i
 /** Returns the next bigger power of two value from \a in_i
  *
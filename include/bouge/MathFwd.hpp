@@ -31,6 +31,10 @@ namespace bouge {
     class Vector;
 
     class Quaternion;
+    class DualQuaternion;
+
+    class BoundingBox;
+    class BoundingSphere;
 
     class Base4x4Matrix;
     class AffineMatrix;
@@ -39,11 +39,16 @@ namespace bouge {
 
         virtual AnimationPtr play(AnimationPtr anim) = 0;
         virtual AnimationPtr oneshot(AnimationPtr anim) = 0;
+        /// Plays an additive animation (see CoreAnimation::makeAdditive) on
+        /// top of all the others, scaled by its weight.
+        /// \exception std::invalid_argument if the core animation of \a anim
+        ///            isn't additive.
+        virtual AnimationPtr additive(AnimationPtr anim) = 0;
         virtual Mixer& stop(AnimationPtr anim, float fadeOutTime = 0.0f) = 0;
-        virtual Mixer& stop(const std::string& animName, float fadeOutTime = 0.0f) = 0;
-        virtual Mixer& pause(const std::string& animName) = 0;
-        virtual Mixer& resume(const std::string& animName) = 0;
-        virtual bool paused(const std::string& animName) const = 0;
+        virtual Mixer& stop(const Name& animName, float fadeOutTime = 0.0f) = 0;
+        virtual Mixer& pause(const Name& animName) = 0;
+        virtual Mixer& resume(const Name& animName) = 0;
+        virtual bool paused(const Name& animName) const = 0;
 
         virtual Mixer& pauseAll();
         virtual Mixer& resumeAll();
@@ -52,8 +57,18 @@ namespace bouge {
 
         float speed() const;
         Mixer& speed(float speed);
-        virtual float speed(const std::string& animName) const = 0;
-        virtual Mixer& speed(const std::string& animName, float speed) = 0;
+        virtual float speed(const Name& animName) const = 0;
+        virtual Mixer& speed(const Name& animName, float speed) = 0;
+
+        /// \return Where the events of the animations get collected, if anywhere.
+        AnimationEvents* events() const;
+        /// During every update, all markers the played animations go over get
+        /// appended to \a events, in the order they happened in. The buffer
+        /// is never cleared by the mixer, so the same one may collect the
+        /// events of many models; just clear it once you handled a frame.
+        /// \param events The buffer to collect into, or none to stop collecting.
+        /// \return A reference to the current object for chaining operation.
+        Mixer& events(AnimationEvents* events);
 
         virtual void update(float deltaTime) = 0;
 
@@ -67,6 +82,7 @@ namespace bouge {
     private:
         float m_speed;
         bool m_paused;
+        AnimationEvents* m_events;
     };
 
     struct BOUGE_API DummyMixer : public Mixer
@@ -76,16 +92,17 @@ namespace bouge {
 
         AnimationPtr play(AnimationPtr anim);
         AnimationPtr oneshot(AnimationPtr anim);
+        AnimationPtr additive(AnimationPtr anim);
         DummyMixer& stop(AnimationPtr anim, float fadeOutTime = 0.0f) {return *this;};
-        DummyMixer& stop(const std::string& animName, float fadeOutTime = 0.0f) {return *this;};
-        DummyMixer& pause(const std::string& animName) {return *this;};
-        DummyMixer& resume(const std::string& animName) {return *this;};
-        bool paused(const std::string& animName) const {return false;};
+        DummyMixer& stop(const Name& animName, float fadeOutTime = 0.0f) {return *this;};
+        DummyMixer& pause(const Name& animName) {return *this;};
+        DummyMixer& resume(const Name& animName) {return *this;};
+        bool paused(const Name& animName) const {return false;};
 
         DummyMixer& stopAll(float fadeOutTime = 0.0f) {return *this;};
 
-        float speed(const std::string& animName) const {return 1.0f;};
-        DummyMixer& speed(const std::string& animName, float speed) {return *this;};
+        float speed(const Name& animName) const {return 1.0f;};
+        DummyMixer& speed(const Name& animName, float speed) {return *this;};
 
         void update(float deltaTime) {};
 
@@ -100,18 +117,19 @@ namespace bouge {
 
         AnimationPtr play(AnimationPtr anim);
         AnimationPtr oneshot(AnimationPtr anim);
+        AnimationPtr additive(AnimationPtr anim);
         DefaultMixer& stop(AnimationPtr anim, float fadeOutTime = 0.0f);
-        DefaultMixer& stop(const std::string& animName, float fadeOutTime = 0.0f);
-        DefaultMixer& pause(const std::string& animName);
-        DefaultMixer& resume(const std::string& animName);
-        bool paused(const std::string& animName) const;
+        DefaultMixer& stop(const Name& animName, float fadeOutTime = 0.0f);
+        DefaultMixer& pause(const Name& animName);
+        DefaultMixer& resume(const Name& animName);
+        bool paused(const Name& animName) const;
 
         DefaultMixer& pauseAll();
         DefaultMixer& resumeAll();
         DefaultMixer& stopAll(float fadeOutTime = 0.0f);
 
-        float speed(const std::string& animName) const;
-        DefaultMixer& speed(const std::string& animName, float speed);
+        float speed(const Name& animName) const;
+        DefaultMixer& speed(const Name& animName, float speed);
 
         virtual void update(float deltaTime);
 
@@ -120,6 +138,7 @@ namespace bouge {
 
         std::set<AnimationPtr> m_cyclingAnims;
         std::list<AnimationPtr> m_oneshotAnims;
+        std::list<AnimationPtr> m_additiveAnims;
         std::set<AnimationPtr> m_scheduledStop;
 
         void doScheduledStops();
@@ -59,6 +59,9 @@ namespace bouge {
 
         AnimationPtr playCycle(const std::string anim, float speed = 1.0f, float fadeInTime = 0.3f, float weight = 1.0f, TimeFunction* control = 0);
         AnimationPtr playOneShot(const std::string anim, float speed = 1.0f, float fadeInTime = 0.0f, float fadeOutTime = 0.0f, TimeFunction* control = 0);
+        /// \exception std::invalid_argument if \a anim isn't additive, see
+        ///            CoreAnimation::makeAdditive.
+        AnimationPtr playAdditive(const std::string anim, float speed = 1.0f, float fadeInTime = 0.3f, float weight = 1.0f, TimeFunction* control = 0);
         ModelInstance& stop(const std::string anim, float fadeOutTime = 0.3f);
         ModelInstance& stop(AnimationPtr anim, float fadeOutTime = 0.3f);
         ModelInstance& pause(const std::string anim);
@@ -90,7 +93,7 @@ namespace bouge {
 //         ModelInstance& attachMesh(mesh);
 //         ModelInstance& detachMesh();
 
-        CoreAnimationPtrC findAnimToUse(const std::string& name) const;
+        CoreAnimationPtrC findAnimToUse(const Name& name) const;
 
     private:
         CoreModelPtrC m_coremdl;
@@ -99,7 +102,7 @@ namespace bouge {
         std::string m_sMatSet;
 
         // animations attached individually.
-        std::map<std::string, CoreAnimationPtrC> m_attachedAnims;
+        std::map<Name, CoreAnimationPtrC> m_attachedAnims;
 
         // models whose animations to attach.
         std::list<ModelInstancePtrC> m_attachedAnimSources;
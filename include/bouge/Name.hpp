@@ -0,0 +1,89 @@
+////////////////////////////////////////////////////////////
+//
+// Bouge - Modern and flexible skeletal animation library
+// Copyright (C) 2010 Lucas Beyer (pompei2@gmail.com)
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it freely,
+// subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+////////////////////////////////////////////////////////////
+#ifndef BOUGE_NAME_HPP
+#define BOUGE_NAME_HPP
+
+#include <bouge/Config.hpp>
+
+#include <string>
+#include <ostream>
+
+namespace bouge {
+
+    /// An interned name, like the name of a bone, animation, submesh or
+    /// material. All names having the same text share a single copy of it in a
+    /// global table and only carry its id around, thus comparing names, copying
+    /// them and using them as keys in maps is as cheap as with integers.
+    ///
+    /// Names convert implicitly from and to strings, so they can be passed
+    /// wherever a string is expected and the other way round. Note that the
+    /// ordering of names is the order in which they were first seen, not the
+    /// alphabetical one, so it may differ from one run to the next. Sort by
+    /// str() wherever the order is visible to the outside.
+    /// \note Creating a name from a string looks it up in the table, adding it
+    ///       if it's new. Keep the names around instead of creating them from
+    ///       strings over and over in tight loops. The table never shrinks, so
+    ///       use find when merely looking something up by a string which might
+    ///       be unknown. The table may be used from several threads at once.
+    class BOUGE_API Name
+    {
+    public:
+        /// Creates the empty name.
+        Name();
+        Name(const std::string& name);
+        Name(const char* name);
+
+        /// Looks a name up without adding it to the table.
+        /// \return The name having the text \a name, or the empty name if
+        ///         there is none. As every existing name has been created,
+        ///         nothing can be named after an unknown text anyway.
+        static Name find(const std::string& name);
+
+        /// \return The text of this name. It stays valid until the program ends.
+        const std::string& str() const;
+        operator const std::string&() const;
+
+        /// \return The id of this name in the table, unique per text. The empty name has id 0.
+        Uint32 id() const;
+        bool empty() const;
+
+        bool operator==(const Name& other) const { return m_id == other.m_id; }
+        bool operator!=(const Name& other) const { return m_id != other.m_id; }
+        bool operator<(const Name& other) const { return m_id < other.m_id; }
+
+    private:
+        Uint32 m_id;
+    };
+
+    BOUGE_API std::ostream& operator<<(std::ostream& os, const Name& name);
+
+    // Strings don't pick up the implicit conversion when being concatenated.
+    BOUGE_API std::string operator+(const std::string& lhs, const Name& rhs);
+    BOUGE_API std::string operator+(const Name& lhs, const std::string& rhs);
+    BOUGE_API std::string operator+(const char* lhs, const Name& rhs);
+    BOUGE_API std::string operator+(const Name& lhs, const char* rhs);
+
+} // namespace bouge
+
+#endif // BOUGE_NAME_HPP
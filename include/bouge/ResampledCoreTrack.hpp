@@ -0,0 +1,116 @@
+////////////////////////////////////////////////////////////
+//
+// Bouge - Modern and flexible skeletal animation library
+// Copyright (C) 2010 Lucas Beyer (pompei2@gmail.com)
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it freely,
+// subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+////////////////////////////////////////////////////////////
+#ifndef BOUGE_RESAMPLEDCORETRACK_HPP
+#define BOUGE_RESAMPLEDCORETRACK_HPP
+
+#include <bouge/bougefwd.hpp>
+#include <bouge/CoreTrack.hpp>
+#include <bouge/CompressedCoreTrack.hpp>
+
+#include <vector>
+
+namespace bouge {
+
+    /// A track holding samples taken at a fixed rate, for example 30 per
+    /// second, instead of keyframes at arbitrary times. Sampling it doesn't
+    /// need to search for the keyframes around the time anymore, it is just
+    /// an index computation and one interpolation, and no times need to be
+    /// stored at all.\n
+    /// The samples cover the time from 0 to the duration of the source track,
+    /// the rate is rounded up just enough so that the last sample falls
+    /// exactly onto the end. In between, keyframes of the source falling
+    /// between two samples are cut off, see error. Past the end, the last two
+    /// samples are extrapolated, just as CoreTrack does with its last two
+    /// keyframes, so there the source and the resampled track differ.
+    /// The samples are always interpolated linearly, even if the source is
+    /// interpolated using splines; the curve is sampled, though.
+    /// \note A resampled track doesn't hold any CoreKeyframe, so iterating it
+    ///       yields nothing and editing it throws. Use toCoreTrack in order
+    ///       to edit or save it.
+    class BOUGE_API ResampledCoreTrack : public CoreTrack
+    {
+    public:
+        /// Resamples \a source.
+        /// \param source The track to resample, it needs at least one keyframe.
+        ///               It may be any kind of track, even a compressed one.
+        /// \param rate How many samples to take per second.
+        /// \exception std::invalid_argument if \a source has no keyframes or
+        ///            \a rate is not positive.
+        ResampledCoreTrack(const CoreTrack& source, float rate = 30.0f);
+        virtual ~ResampledCoreTrack();
+
+        virtual bool hasRotation() const;
+        virtual Quaternion rotation(float time) const;
+        virtual bool hasTranslation() const;
+        virtual Vector translation(float time) const;
+        virtual bool hasScale() const;
+        virtual Vector scale(float time) const;
+
+        virtual std::size_t keyframeCount() const;
+        virtual float duration() const;
+
+        // There are no keyframes to edit, all of these throw a std::logic_error.
+        // Use toCoreTrack and edit that instead.
+        using CoreTrack::begin;
+        using CoreTrack::closest;
+        using CoreTrack::after;
+        virtual iterator begin();
+        virtual iterator closest(float time);
+        virtual iterator after(float time);
+        virtual CoreTrack& add(float time, CoreKeyframePtr keyframe);
+        virtual CoreTrack& remove(iterator who);
+        virtual CoreTrack& removeAllIn(float start, float end);
+
+        /// \return How many samples per second this track actually holds.
+        float rate() const;
+
+        /// \return How far this track is off from the one it has been
+        ///         resampled from, measured at every keyframe of the source
+        ///         and halfway between each two samples.
+        const CompressionError& error() const;
+
+        /// \return A track with one keyframe per sample.
+        CoreTrackPtr toCoreTrack() const;
+
+    private:
+        /// \internal Finds the sample before \a time and how far \a time is past it.
+        void sampleAt(float time, std::size_t& idx, float& between) const;
+
+        std::size_t m_count;
+        float m_end;
+        float m_rate;
+
+        bool m_bHasRot;
+        bool m_bHasTrans;
+        bool m_bHasScale;
+        std::vector<float> m_rot;
+        std::vector<float> m_trans;
+        std::vector<float> m_scale;
+
+        CompressionError m_error;
+    };
+
+} // namespace bouge
+
+#endif // BOUGE_RESAMPLEDCORETRACK_HPP
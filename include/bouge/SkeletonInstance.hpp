@@ -26,6 +26,7 @@
 
 #include <bouge/bougefwd.hpp>
 #include <bouge/CoreSkeleton.hpp>
+#include <bouge/Math/BoundingVolume.hpp>
 
 #include <vector>
 #include <map>
@@ -46,11 +47,14 @@ namespace bouge {
 
         CoreSkeletonPtrC core() const;
 
+        bool hasBone(const Name& name) const;
+        /// Doesn't add \a name to the name table, unlike converting it to a Name.
         bool hasBone(const std::string& name) const;
+        bool hasBone(const char* name) const;
         /// \exception NotExistException
-        BoneInstancePtr bone(const std::string& name);
+        BoneInstancePtr bone(const Name& name);
         /// \exception NotExistException
-        BoneInstancePtrC bone(const std::string& name) const;
+        BoneInstancePtrC bone(const Name& name) const;
         /// \exception NotExistException
         BoneInstancePtr bone(const BoneId& id);
         /// \exception NotExistException
@@ -62,6 +66,20 @@ namespace bouge {
         BoneMap::size_type boneCount() const;
         std::size_t rootBoneCount() const;
 
+        /// Bounds the current pose of the model by moving each bone's box along
+        /// with the bone, which is way faster than skinning the vertices.
+        /// The result is conservative, as every skinned vertex is a weighted
+        /// average of positions lying within the moved boxes.
+        /// \param bounds The bounds of the mesh, built for this skeleton.
+        /// \param world The transformation from model space into world space.
+        /// \return An axis aligned box in world space containing the whole posed mesh.
+        /// \exception std::invalid_argument if \a bounds has been built for another skeleton.
+        BoundingBox bounds(const BoneBounds& bounds, const AffineMatrix& world) const;
+
+        /// Same as bounds, but returns a sphere, which is cheaper to test.
+        /// \exception std::invalid_argument if \a bounds has been built for another skeleton.
+        BoundingSphere boundingSphere(const BoneBounds& bounds, const AffineMatrix& world) const;
+
         class BOUGE_API iterator {
         public:
             ~iterator();
@@ -0,0 +1,78 @@
+////////////////////////////////////////////////////////////
+//
+// Bouge - Modern and flexible skeletal animation library
+// Copyright (C) 2010 Lucas Beyer (pompei2@gmail.com)
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it freely,
+// subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+////////////////////////////////////////////////////////////
+#ifndef BOUGE_SPAN_HPP
+#define BOUGE_SPAN_HPP
+
+#include <bouge/Config.hpp>
+
+#include <vector>
+
+namespace bouge {
+
+    /// A read-only view on a contiguous range of elements stored somewhere
+    /// else, for looking at the data of bouge's containers without copying it.
+    /// It stays valid only as long as the container it looks into isn't modified.
+    template<class T>
+    class Span
+    {
+    public:
+        typedef T value_type;
+        typedef const T* const_iterator;
+
+        /// Creates an empty span.
+        Span() : m_p(0), m_size(0) { }
+
+        /// Creates a span of the \a size elements starting at \a p.
+        Span(const T* p, std::size_t size) : m_p(size > 0 ? p : 0), m_size(size) { }
+
+        /// Creates a span of the whole content of \a v.
+        Span(const std::vector<T>& v) : m_p(v.empty() ? 0 : &v[0]), m_size(v.size()) { }
+
+        std::size_t size() const { return m_size; }
+        bool empty() const { return m_size == 0; }
+
+        /// \return The \a idx th element. There is no range checking.
+        const T& operator[](std::size_t idx) const { return m_p[idx]; }
+
+        /// \return A pointer to the first element, or null if the span is empty.
+        const T* data() const { return m_p; }
+
+        const_iterator begin() const { return m_p; }
+        const_iterator end() const { return m_p + m_size; }
+
+        /// \return A span of the \a count elements starting at the \a first one
+        ///         of this span. There is no range checking.
+        Span sub(std::size_t first, std::size_t count) const { return Span(m_p + first, count); }
+
+        /// \return A copy of the elements.
+        std::vector<T> copy() const { return std::vector<T>(this->begin(), this->end()); }
+
+    private:
+        const T* m_p;
+        std::size_t m_size;
+    };
+
+} // namespace bouge
+
+#endif // BOUGE_SPAN_HPP
@@ -0,0 +1,201 @@
+////////////////////////////////////////////////////////////
+//
+// Bouge - Modern and flexible skeletal animation library
+// Copyright (C) 2010 Lucas Beyer (pompei2@gmail.com)
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it freely,
+// subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+////////////////////////////////////////////////////////////
+#ifndef BOUGE_STATICBATCHER_HPP
+#define BOUGE_STATICBATCHER_HPP
+
+#include <bouge/bougefwd.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace bouge {
+
+    /// All the geometry of many static model instances that is drawn using the
+    /// same material, already transformed into world space and merged into one
+    /// set of vertex and index buffers, so it can be drawn with one single call.
+    /// The layout of the buffers is just the same as the one of a
+    /// CoreHardwareMesh, that is one buffer for the coordinates and one for
+    /// each generic attribute.
+    class BOUGE_API StaticBatch
+    {
+    public:
+        StaticBatch(CoreMaterialPtrC mat);
+        virtual ~StaticBatch();
+
+        BOUGE_USER_DATA;
+
+        /// \return The material every face of this batch is drawn with.
+        CoreMaterialPtrC material() const;
+
+        /// \return A number that changes every time the content of the batch
+        ///         changes. Remember it when uploading the buffers to the
+        ///         graphics card, in order to know when to upload them again.
+        std::size_t revision() const;
+
+        /// \return The number of vertices there are in this batch.
+        std::size_t vertexCount() const;
+
+        /// \return The number of (triangle) faces there are in this batch.
+        std::size_t faceCount() const;
+
+        /// \return The number of coordinates each vertex has. (Usually 3)
+        std::size_t coordsPerVertex() const;
+
+        /// \return The coordinates of all vertices, in world space.
+        const std::vector<float>& coords() const;
+
+        /// \return A map mapping each generic attribute's name to the number
+        ///         of coordinates that attrib holds per vertex.
+        const std::map<std::string, std::size_t>& attribs() const;
+
+        /// Checks if the attribute \a name is present in this batch.
+        bool hasAttrib(const std::string& name) const;
+
+        /// \return The number of \a name coordinates each vertex has.
+        /// \exception std::invalid_argument in case there is no such attribute.
+        std::size_t attribCoordsPerVertex(const std::string& name) const;
+
+        /// \return The whole list of a vertex attribute's coordinates.
+        /// \exception std::invalid_argument in case there is no such attribute.
+        const std::vector<float>& attrib(const std::string& name) const;
+
+        /// \return The face indices, three per face.
+        const std::vector<Uint32>& faceIndices() const;
+
+        /// \return The size in bytes (2 or 4) of the narrowest index type that
+        ///         can hold the face indices of this batch.
+        std::size_t indexSize() const;
+
+        /// Writes the face indices into a buffer, tightly packed.
+        /// \param where The buffer to write the face indices to. It needs to
+        ///              be (at least) faceIndices().size() * \a indexSize bytes big.
+        /// \param indexSize The size of one index in bytes, that is 2 or 4.
+        /// \exception std::invalid_argument in case an index doesn't fit into \a indexSize bytes.
+        const StaticBatch& writeIndices(void* where, std::size_t indexSize) const;
+
+    private:
+        friend class StaticBatcher;
+
+        /// \internal The part of the buffers that belongs to one instance.
+        struct Piece {
+            std::size_t instance;
+            std::size_t firstVertex;
+            std::size_t vertexCount;
+            std::size_t firstIndex;
+            std::size_t indexCount;
+        };
+
+        bool accepts(const CoreHardwareMesh& hwmesh) const;
+        void append(std::size_t instance, const CoreHardwareMesh& hwmesh, const CoreHardwareSubMesh& submesh, const AffineMatrix& world, const std::string& normalAttrib);
+        void remove(std::size_t instance);
+
+        CoreMaterialPtrC m_mat;
+        std::size_t m_revision;
+
+        std::size_t m_coordsPerVertex;
+        std::vector<float> m_coords;
+        std::map<std::string, std::size_t> m_attribCoordCount;
+        std::map<std::string, std::vector<float> > m_attribs;
+        std::vector<Uint32> m_faceIndices;
+
+        std::vector<Piece> m_pieces;
+    };
+
+    /// Merges many static model instances into few batches, one per material,
+    /// in order to draw lots of static props (trees, rocks, houses, ...) with
+    /// only a handful of draw calls.\n
+    /// The geometry of an instance is transformed into world space once, when
+    /// it is added. Adding an instance only appends to the batches it uses and
+    /// removing one only cuts its part out of them, the rest of the batches
+    /// stays untouched. So only re-upload the batches whose revision changed.
+    /// \note The material set of an instance is looked at when it is added. If
+    ///       you select another one later on, remove and add it again.
+    class BOUGE_API StaticBatcher
+    {
+    public:
+        /// The handle of an instance added to the batcher.
+        typedef std::size_t InstanceId;
+
+        /// \param normalAttrib The name of the generic attribute holding the
+        ///                     normals. It will be rotated along with the
+        ///                     instances, all other attributes are just copied.
+        StaticBatcher(const std::string& normalAttrib = "normal");
+        virtual ~StaticBatcher();
+
+        BOUGE_USER_DATA;
+
+        /// Adds the geometry of a static model instance to the batches.
+        /// \param inst The instance to add. Its core model needs to have a mesh.
+        /// \param world The transformation from the model's into world space.
+        /// \return The handle to use in order to remove the instance again.
+        /// \exception std::invalid_argument if the mesh has other attributes
+        ///            than the geometry already batched with the same material.
+        InstanceId add(StaticModelInstancePtrC inst, const AffineMatrix& world);
+
+        /// Removes the geometry of an instance from the batches again.
+        /// \param id The handle that add returned.
+        /// \return A reference to the current object for chaining operation.
+        /// \exception NotExistException if there is no instance with that handle.
+        StaticBatcher& remove(InstanceId id);
+
+        /// \return true if there is an instance with that handle in the batcher.
+        bool has(InstanceId id) const;
+
+        /// \return The number of instances in the batcher.
+        std::size_t instanceCount() const;
+
+        /// \return The number of batches. Batches never go away, they only
+        ///         become empty, so their indices stay valid.
+        std::size_t batchCount() const;
+
+        /// \return The batch at index \a idx.
+        /// \exception std::out_of_range if there is no batch at that index.
+        const StaticBatch& batch(std::size_t idx) const;
+
+    private:
+        /// \internal The hardware mesh of a core model, built once for all its instances.
+        struct CachedMesh {
+            CoreHardwareMeshPtrC hwmesh;
+            std::size_t users;
+        };
+
+        /// \internal Everything needed to remove an instance again.
+        struct Entry {
+            CoreModelPtrC model;
+            std::vector<std::size_t> batches;
+        };
+
+        std::string m_normalAttrib;
+        InstanceId m_nextId;
+
+        std::vector<StaticBatch> m_batches;
+        std::map<CoreMaterialPtrC, std::size_t> m_batchForMaterial;
+        std::map<CoreModelPtrC, CachedMesh> m_meshes;
+        std::map<InstanceId, Entry> m_instances;
+    };
+
+} // namespace bouge
+
+#endif // BOUGE_STATICBATCHER_HPP
@@ -44,6 +44,8 @@ namespace bouge {
         CoreMaterialPtr materialForSubmesh(const std::string& submesh);
         CoreMaterialPtrC materialForSubmesh(const std::string& submesh) const;
 
+        CoreModelPtrC core() const;
+
     private:
         CoreModelPtr m_coremdl;
         std::string m_sMatSet;
@@ -26,6 +26,8 @@
 
 #include <bouge/Config.hpp>
 
+#include <map>
+
 namespace bouge {
 
 #if BOUGE_USE_USERDATA
@@ -41,6 +43,99 @@ namespace bouge {
     typedef shared_ptr<UserData>::type UserDataPtr;
 
     #define BOUGE_USER_DATA UserDataPtr userData
+
+    /// Holds the user data of small objects which exist in great numbers,
+    /// like vertices, faces or keyframes. Only those objects that really carry
+    /// user data take up space, the objects themselves stay small.
+    /// The table lives in the object owning them and the key identifies the
+    /// object within its owner, for example the index of a vertex.
+    /// The table itself is only allocated once the first user data is set,
+    /// an unused table costs no more than a pointer.
+    template<class Key>
+    class UserDataTable
+    {
+        typedef std::map<Key, UserDataPtr> Table;
+    public:
+        UserDataTable()
+            : m_pTable(0)
+        { }
+
+        UserDataTable(const UserDataTable& other)
+            : m_pTable(other.m_pTable ? new Table(*other.m_pTable) : 0)
+        { }
+
+        UserDataTable& operator=(const UserDataTable& other)
+        {
+            if(this != &other) {
+                Table* pCopy = other.m_pTable ? new Table(*other.m_pTable) : 0;
+                delete m_pTable;
+                m_pTable = pCopy;
+            }
+            return *this;
+        }
+
+        ~UserDataTable()
+        {
+            delete m_pTable;
+        }
+
+        /// \return The user data of the object \a key or an empty pointer if it has none.
+        UserDataPtr get(const Key& key) const
+        {
+            if(!m_pTable)
+                return UserDataPtr();
+
+            typename Table::const_iterator i = m_pTable->find(key);
+            return i == m_pTable->end() ? UserDataPtr() : i->second;
+        }
+
+        /// Sets the user data of the object \a key. Setting an empty pointer removes it.
+        /// \return A reference to the current object for chaining operation.
+        UserDataTable& set(const Key& key, UserDataPtr data)
+        {
+            if(data) {
+                if(!m_pTable)
+                    m_pTable = new Table();
+                (*m_pTable)[key] = data;
+            } else if(m_pTable) {
+                m_pTable->erase(key);
+            }
+            return *this;
+        }
+
+        /// \return Whether the object \a key has any user data.
+        bool has(const Key& key) const
+        {
+            return m_pTable && m_pTable->find(key) != m_pTable->end();
+        }
+
+        /// Removes the user data of all objects in the (inclusive) range [\a first ; \a last].
+        /// \return A reference to the current object for chaining operation.
+        UserDataTable& eraseRange(const Key& first, const Key& last)
+        {
+            if(m_pTable)
+                m_pTable->erase(m_pTable->lower_bound(first), m_pTable->upper_bound(last));
+            return *this;
+        }
+
+        /// \return The number of objects which have user data.
+        std::size_t size() const
+        {
+            return m_pTable ? m_pTable->size() : 0;
+        }
+
+        /// Removes the user data of all objects.
+        /// \return A reference to the current object for chaining operation.
+        UserDataTable& clear()
+        {
+            delete m_pTable;
+            m_pTable = 0;
+            return *this;
+        }
+
+    private:
+        Table* m_pTable;
+    };
 #else
     #define BOUGE_USER_DATA
 #endif
@@ -45,6 +45,11 @@ namespace bouge {
 
     std::string BOUGE_API fast_to_s(std::size_t i);
 
+    /// Computes the (32 bit FNV-1a) hash of a chunk of memory. To hash several
+    /// chunks as if they were one, pass the result of the previous call as \a h.
+    Uint32 BOUGE_API fnv1aHash(const void* pData, std::size_t size, Uint32 h = 2166136261u);
+    Uint32 BOUGE_API fnv1aHash(const std::string& s, Uint32 h = 2166136261u);
+
     template <class T>
     T BOUGE_API to(std::string s)
     {
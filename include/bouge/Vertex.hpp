@@ -40,8 +40,6 @@ namespace bouge {
         float w; ///< The weight of this bone.
         std::string sBoneName; ///< The name of the bone influencing the vertex.
 
-        BOUGE_USER_DATA;
-
         /// Creates a new influence.
         /// \param w The weight value.
         /// \param sBoneName The name of the bone influencing the vertex.
@@ -60,8 +58,6 @@ namespace bouge {
         /// Default destructor.
         virtual ~Vertex();
 
-        BOUGE_USER_DATA;
-
         /// Get a copy of the vertex's coordinates.
         /// \return A copy of this vertex's coordinates. Modifying the copy won't modify the vertex.
         Vector pos() const;
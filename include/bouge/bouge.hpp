@@ -29,14 +29,21 @@
 #include <bouge/Math.hpp>
 
 #include <bouge/Animation.hpp>
+#include <bouge/BoneBounds.hpp>
 #include <bouge/BoneInstance.hpp>
+#include <bouge/BoneMask.hpp>
+#include <bouge/BonePalette.hpp>
+#include <bouge/CompressedCoreTrack.hpp>
 #include <bouge/CoreAnimation.hpp>
+#include <bouge/CoreAnimationReducer.hpp>
 #include <bouge/CoreBone.hpp>
 #include <bouge/CoreHardwareMesh.hpp>
+#include <bouge/CoreHardwareMeshBinary.hpp>
 #include <bouge/CoreKeyframe.hpp>
 #include <bouge/CoreMaterial.hpp>
 #include <bouge/CoreMaterialSet.hpp>
 #include <bouge/CoreMesh.hpp>
+#include <bouge/CoreMeshSimplifier.hpp>
 #include <bouge/CoreModel.hpp>
 #include <bouge/CoreSkeleton.hpp>
 #include <bouge/CoreTrack.hpp>
@@ -44,7 +51,11 @@
 #include <bouge/Face.hpp>
 #include <bouge/Mixer.hpp>
 #include <bouge/ModelInstance.hpp>
+#include <bouge/Name.hpp>
+#include <bouge/ResampledCoreTrack.hpp>
 #include <bouge/SkeletonInstance.hpp>
+#include <bouge/Span.hpp>
+#include <bouge/StaticBatcher.hpp>
 #include <bouge/StaticModelInstance.hpp>
 #include <bouge/UserData.hpp>
 #include <bouge/Util.hpp>
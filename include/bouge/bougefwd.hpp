@@ -26,6 +26,7 @@
 
 #include <bouge/Config.hpp>
 #include <bouge/UserData.hpp>
+#include <bouge/Name.hpp>
 #include <bouge/MathFwd.hpp>
 
 namespace bouge {
@@ -35,9 +36,22 @@ namespace bouge {
     typedef bouge::shared_ptr<const BoneInstance>::type BoneInstancePtrC;
     typedef unsigned int BoneId;
 
+    class BoneBounds;
+    typedef bouge::shared_ptr<BoneBounds>::type BoneBoundsPtr;
+    typedef bouge::shared_ptr<const BoneBounds>::type BoneBoundsPtrC;
+
+    class BoneMask;
+    typedef bouge::shared_ptr<BoneMask>::type BoneMaskPtr;
+    typedef bouge::shared_ptr<const BoneMask>::type BoneMaskPtrC;
+
+    class BonePalette;
+    typedef bouge::shared_ptr<BonePalette>::type BonePalettePtr;
+    typedef bouge::shared_ptr<const BonePalette>::type BonePalettePtrC;
+
     class CoreAnimation;
     typedef bouge::shared_ptr<CoreAnimation>::type CoreAnimationPtr;
     typedef bouge::shared_ptr<const CoreAnimation>::type CoreAnimationPtrC;
+    class CoreAnimationReducer;
 
     class CoreBone;
     typedef bouge::shared_ptr<CoreBone>::type CoreBonePtr;
@@ -46,6 +60,7 @@ namespace bouge {
     class CoreHardwareMesh;
     typedef bouge::shared_ptr<CoreHardwareMesh>::type CoreHardwareMeshPtr;
     typedef bouge::shared_ptr<const CoreHardwareMesh>::type CoreHardwareMeshPtrC;
+    class CoreHardwareMeshBinary;
     class CoreHardwareSubMesh;
     typedef bouge::shared_ptr<CoreHardwareSubMesh>::type CoreHardwareSubMeshPtr;
     typedef bouge::shared_ptr<const CoreHardwareSubMesh>::type CoreHardwareSubMeshPtrC;
@@ -68,6 +83,7 @@ namespace bouge {
     class CoreSubMesh;
     typedef bouge::shared_ptr<CoreSubMesh>::type CoreSubMeshPtr;
     typedef bouge::shared_ptr<const CoreSubMesh>::type CoreSubMeshPtrC;
+    class CoreMeshSimplifier;
 
     class CoreModel;
     typedef bouge::shared_ptr<CoreModel>::type CoreModelPtr;
@@ -80,6 +96,12 @@ namespace bouge {
     class CoreTrack;
     typedef bouge::shared_ptr<CoreTrack>::type CoreTrackPtr;
     typedef bouge::shared_ptr<const CoreTrack>::type CoreTrackPtrC;
+    class CompressedCoreTrack;
+    typedef bouge::shared_ptr<CompressedCoreTrack>::type CompressedCoreTrackPtr;
+    typedef bouge::shared_ptr<const CompressedCoreTrack>::type CompressedCoreTrackPtrC;
+    class ResampledCoreTrack;
+    typedef bouge::shared_ptr<ResampledCoreTrack>::type ResampledCoreTrackPtr;
+    typedef bouge::shared_ptr<const ResampledCoreTrack>::type ResampledCoreTrackPtrC;
 
     class Exception;
     class NotExistException;
@@ -101,6 +123,13 @@ namespace bouge {
     typedef bouge::shared_ptr<StaticModelInstance>::type StaticModelInstancePtr;
     typedef bouge::shared_ptr<const StaticModelInstance>::type StaticModelInstancePtrC;
 
+    class StaticBatch;
+    typedef bouge::shared_ptr<StaticBatch>::type StaticBatchPtr;
+    typedef bouge::shared_ptr<const StaticBatch>::type StaticBatchPtrC;
+    class StaticBatcher;
+    typedef bouge::shared_ptr<StaticBatcher>::type StaticBatcherPtr;
+    typedef bouge::shared_ptr<const StaticBatcher>::type StaticBatcherPtrC;
+
     struct Influence;
     typedef bouge::shared_ptr<Influence>::type InfluencePtr;
     typedef bouge::shared_ptr<const Influence>::type InfluencePtrC;
@@ -26,10 +26,20 @@
 #include <bouge/Math/Util.hpp>
 #include <bouge/Math/TimeFunction.hpp>
 
+#include <algorithm>
+#include <cmath>
+
 namespace bouge {
 
+    AnimationEvent::AnimationEvent(const Animation* anim, const Name& marker, float time)
+        : animation(anim)
+        , marker(marker)
+        , time(time)
+    { }
+
     Animation::Animation(CoreAnimationPtrC core, float speed, TimeFunction* control, TimeFunction* weight)
         : m_timePercent(0.0f)
+        , m_bStarted(false)
         , m_core(core)
         , m_speed(speed)
         , m_control(control)
@@ -50,30 +60,40 @@ namespace bouge {
         }
 
         while(!m_updateCbs.empty()) {
-            delete m_endCbs.front();
-            m_endCbs.pop_front();
+            delete m_updateCbs.front();
+            m_updateCbs.pop_front();
+        }
+
+        while(!m_markerCbs.empty()) {
+            delete m_markerCbs.front();
+            m_markerCbs.pop_front();
         }
 
         delete m_control;
         delete m_weight;
     }
 
-    std::string Animation::name() const
+    const Name& Animation::name() const
     {
         return this->core()->name();
     }
 
-    void Animation::update(float deltaTime)
+    void Animation::update(float deltaTime, AnimationEvents* events)
     {
         if(this->paused())
             return;
 
+        float from = m_timePercent;
         if(nearZero(this->duration())) {
             m_timePercent = 0.0f;
         } else {
             m_timePercent += this->speed()*deltaTime/this->duration();
         }
 
+        if((events || !m_markerCbs.empty()) && m_core->markerCount() > 0 && !nearZero(this->duration()))
+            this->fireMarkers(from, m_timePercent, events);
+        m_bStarted = true;
+
         // Check for callbacks.
         for(std::list<AnimationCallback*>::iterator iCb = m_updateCbs.begin() ; iCb != m_updateCbs.end() ; ++iCb) {
             (*iCb)->operator()(*this);
@@ -119,11 +139,6 @@ namespace bouge {
         return *this;
     }
 
-//     Animation& Animation::addCallback(AnimationCallback* cb, float absoluteTime)
-//     {
-//         m_arbitraryCbs.insert(std::make_pair(absoluteTime, cb));
-//     }
-
     Animation& Animation::addEndCallback(AnimationCallback* cb)
     {
         m_endCbs.push_back(cb);
@@ -136,6 +151,64 @@ namespace bouge {
         return *this;
     }
 
+    Animation& Animation::addMarkerCallback(AnimationMarkerCallback* cb)
+    {
+        m_markerCbs.push_back(cb);
+        return *this;
+    }
+
+    void Animation::fireMarkers(float from, float to, AnimationEvents* events)
+    {
+        // The control function may jump or turn around at every integer raw
+        // time, so we walk the raw times piece by piece, each piece being a
+        // monotonic sweep over the core animation's time.
+        bool fwd = to >= from;
+        bool withStart = !m_bStarted;
+        float a = from;
+        do {
+            float b = fwd ? std::min(std::floor(a) + 1.0f, to) : std::max(std::ceil(a) - 1.0f, to);
+
+            float s = (*m_control)(a), e = s;
+            bool jump = false;
+            if(a != b) {
+                if(std::floor(a) == a) {
+                    s = fwd ? m_control->after(a) : m_control->before(a);
+                    jump = m_control->before(a) != m_control->after(a);
+                }
+                e = std::floor(b) == b ? (fwd ? m_control->before(b) : m_control->after(b)) : (*m_control)(b);
+            }
+
+            // After a jump, the start of the piece has not been played yet.
+            this->fireMarkersBetween(s*this->duration(), e*this->duration(), withStart || jump, events);
+            withStart = false;
+            a = b;
+        } while(a != to);
+    }
+
+    void Animation::fireMarkersBetween(float from, float to, bool withFrom, AnimationEvents* events)
+    {
+        if(from <= to) {
+            CoreAnimation::const_marker_iterator i = withFrom ? m_core->markersFrom(from) : m_core->markersAfter(from);
+            for( ; i != m_core->end_marker() && i.time() <= to ; ++i)
+                this->fireMarker(i.name(), i.time(), events);
+        } else {
+            // Going backwards in time, so are the markers.
+            CoreAnimation::const_marker_iterator i = withFrom ? m_core->markersAfter(from) : m_core->markersFrom(from);
+            while(i != m_core->begin_marker() && (--i).time() >= to)
+                this->fireMarker(i.name(), i.time(), events);
+        }
+    }
+
+    void Animation::fireMarker(const Name& marker, float time, AnimationEvents* events)
+    {
+        if(events)
+            events->push_back(AnimationEvent(this, marker, time));
+
+        for(std::list<AnimationMarkerCallback*>::iterator iCb = m_markerCbs.begin() ; iCb != m_markerCbs.end() ; ++iCb) {
+            (*iCb)->operator()(*this, marker, time);
+        }
+    }
+
     float Animation::timePercent() const
     {
         return (*m_control)(m_timePercent);
@@ -200,4 +273,15 @@ namespace bouge {
         return *this;
     }
 
+    BoneMaskPtrC Animation::mask() const
+    {
+        return m_mask;
+    }
+
+    Animation& Animation::mask(BoneMaskPtrC mask)
+    {
+        m_mask = mask;
+        return *this;
+    }
+
 } // namespace bouge
@@ -0,0 +1,133 @@
+////////////////////////////////////////////////////////////
+//
+// Bouge - Modern and flexible skeletal animation library
+// Copyright (C) 2010 Lucas Beyer (pompei2@gmail.com)
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it freely,
+// subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+////////////////////////////////////////////////////////////
+#include <bouge/BoneBounds.hpp>
+#include <bouge/CoreMesh.hpp>
+#include <bouge/CoreSkeleton.hpp>
+#include <bouge/Math/Vector.hpp>
+#include <bouge/Util.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace bouge {
+
+    /// \internal
+    /// \return For every bone id used by the influences of the submesh, the id
+    ///         of that bone in the skeleton.
+    static std::vector<BoneId> skeletonBoneIds(const CoreSubMesh& submesh, const CoreSkeleton& skel)
+    {
+        Span<Uint32> bones = submesh.influenceBones();
+        Uint32 count = 0;
+        for(std::size_t i = 0 ; i < bones.size() ; ++i) {
+            count = std::max(count, bones[i] + 1);
+        }
+
+        std::vector<BoneId> ret;
+        ret.reserve(count);
+        for(Uint32 i = 0 ; i < count ; ++i) {
+            ret.push_back(skel.boneId(submesh.boneName(i)));
+        }
+        return ret;
+    }
+
+    BoneBounds::BoneBounds(CoreMeshPtrC mesh, CoreSkeletonPtrC skel)
+        : m_boxes(skel->boneCount())
+        , m_spheres(skel->boneCount())
+    {
+        // First the boxes, whose centers then are the centers of the spheres.
+        for(CoreMesh::const_iterator iSubMesh = mesh->begin() ; iSubMesh != mesh->end() ; ++iSubMesh) {
+            Span<float> positions = iSubMesh->positions();
+            Span<Uint32> starts = iSubMesh->influenceStarts();
+            Span<Uint32> bones = iSubMesh->influenceBones();
+            Span<float> weights = iSubMesh->influenceWeights();
+            std::vector<BoneId> skelIds = skeletonBoneIds(**iSubMesh, *skel);
+
+            for(std::size_t iVtx = 0 ; iVtx < iSubMesh->vertexCount() ; ++iVtx) {
+                for(Uint32 i = starts[iVtx] ; i < starts[iVtx+1] ; ++i) {
+                    if(weights[i] != 0.0f)
+                        m_boxes[skelIds[bones[i]]].extend(&positions[3*iVtx]);
+                }
+            }
+        }
+
+        std::vector<Vector> centers;
+        centers.reserve(m_boxes.size());
+        for(std::size_t i = 0 ; i < m_boxes.size() ; ++i) {
+            centers.push_back(m_boxes[i].center());
+        }
+
+        std::vector<float> radii2(m_boxes.size(), 0.0f);
+        for(CoreMesh::const_iterator iSubMesh = mesh->begin() ; iSubMesh != mesh->end() ; ++iSubMesh) {
+            Span<float> positions = iSubMesh->positions();
+            Span<Uint32> starts = iSubMesh->influenceStarts();
+            Span<Uint32> bones = iSubMesh->influenceBones();
+            Span<float> weights = iSubMesh->influenceWeights();
+            std::vector<BoneId> skelIds = skeletonBoneIds(**iSubMesh, *skel);
+
+            for(std::size_t iVtx = 0 ; iVtx < iSubMesh->vertexCount() ; ++iVtx) {
+                for(Uint32 i = starts[iVtx] ; i < starts[iVtx+1] ; ++i) {
+                    if(weights[i] == 0.0f)
+                        continue;
+
+                    BoneId id = skelIds[bones[i]];
+                    const float* c = centers[id].array3f();
+                    const float* p = &positions[3*iVtx];
+                    float d2 = (p[0]-c[0])*(p[0]-c[0]) + (p[1]-c[1])*(p[1]-c[1]) + (p[2]-c[2])*(p[2]-c[2]);
+                    radii2[id] = std::max(radii2[id], d2);
+                }
+            }
+        }
+
+        for(std::size_t i = 0 ; i < m_boxes.size() ; ++i) {
+            if(!m_boxes[i].empty())
+                m_spheres[i] = BoundingSphere(centers[i], std::sqrt(radii2[i]));
+        }
+    }
+
+    BoneBounds::~BoneBounds()
+    { }
+
+    std::size_t BoneBounds::boneCount() const
+    {
+        return m_boxes.size();
+    }
+
+    const BoundingBox& BoneBounds::box(BoneId id) const
+    {
+        if(id >= m_boxes.size())
+            throw std::out_of_range("Bounding box of bone " + to_s(id) + " (max: " + to_s(m_boxes.size()) + ")");
+
+        return m_boxes[id];
+    }
+
+    const BoundingSphere& BoneBounds::sphere(BoneId id) const
+    {
+        if(id >= m_spheres.size())
+            throw std::out_of_range("Bounding sphere of bone " + to_s(id) + " (max: " + to_s(m_spheres.size()) + ")");
+
+        return m_spheres[id];
+    }
+
+} // namespace bouge
@@ -40,7 +40,7 @@ namespace bouge {
     BoneInstance::~BoneInstance()
     { }
 
-    std::string BoneInstance::name() const
+    const Name& BoneInstance::name() const
     {
         return this->core()->name();
     }
@@ -271,6 +271,11 @@ namespace bouge {
         // No one-liner in order to save temporaries
         m_transformationMatrix.setTransformation(m_absoluteRootPos, m_absoluteBoneRot, this->scale());
         m_transformationMatrix *= this->core()->modelSpaceToBoneSpaceMatrix();
+
+        // The same without scale: undo the rest pose's rotation and position,
+        // then rotate and move the bone to where it is now.
+        Quaternion rot = m_absoluteBoneRot * this->core()->absoluteBoneRotation().inv();
+        m_transformationDualQuat = DualQuaternion(rot, m_absoluteRootPos - rot.rotate(this->core()->absoluteRootPosition()));
         m_bDirty = false;
         return *this;
     }
@@ -331,9 +336,14 @@ namespace bouge {
         return this->scale().y() * this->core()->length();
     }
 
-    AffineMatrix BoneInstance::transformMatrix() const
+    const AffineMatrix& BoneInstance::transformMatrix() const
     {
         return m_transformationMatrix;
     }
 
+    const DualQuaternion& BoneInstance::transformDualQuaternion() const
+    {
+        return m_transformationDualQuat;
+    }
+
 }
@@ -0,0 +1,69 @@
+////////////////////////////////////////////////////////////
+//
+// Bouge - Modern and flexible skeletal animation library
+// Copyright (C) 2010 Lucas Beyer (pompei2@gmail.com)
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it freely,
+// subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+////////////////////////////////////////////////////////////
+#include <bouge/BoneMask.hpp>
+#include <bouge/CoreBone.hpp>
+#include <bouge/CoreSkeleton.hpp>
+
+namespace bouge {
+
+    /// \internal Sets the weight of \a bone and all bones below it.
+    static void setSubtree(CoreBonePtrC bone, float weight, std::vector<float>& weights)
+    {
+        weights.at(bone->id()) = weight;
+        for(CoreBone::const_iterator iChild = bone->begin() ; iChild != bone->end() ; ++iChild) {
+            setSubtree(*iChild, weight, weights);
+        }
+    }
+
+    BoneMask::BoneMask(CoreSkeletonPtrC skel, float weight)
+        : m_skel(skel)
+        , m_weights(skel->boneCount(), weight)
+    { }
+
+    BoneMask::~BoneMask()
+    { }
+
+    std::size_t BoneMask::boneCount() const
+    {
+        return m_weights.size();
+    }
+
+    float BoneMask::weight(BoneId id) const
+    {
+        return m_weights.at(id);
+    }
+
+    BoneMask& BoneMask::weight(BoneId id, float weight)
+    {
+        m_weights.at(id) = weight;
+        return *this;
+    }
+
+    BoneMask& BoneMask::subtree(const Name& bone, float weight)
+    {
+        setSubtree(m_skel->bone(bone), weight, m_weights);
+        return *this;
+    }
+
+} // namespace bouge
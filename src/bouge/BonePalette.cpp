@@ -0,0 +1,292 @@
+////////////////////////////////////////////////////////////
+//
+// Bouge - Modern and flexible skeletal animation library
+// Copyright (C) 2010 Lucas Beyer (pompei2@gmail.com)
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it freely,
+// subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+////////////////////////////////////////////////////////////
+#include <bouge/BonePalette.hpp>
+#include <bouge/BoneInstance.hpp>
+#include <bouge/CoreHardwareMesh.hpp>
+#include <bouge/CoreSkeleton.hpp>
+#include <bouge/SkeletonInstance.hpp>
+#include <bouge/Math/Matrix.hpp>
+#include <bouge/Math/DualQuaternion.hpp>
+#include <bouge/Math/Vector.hpp>
+#include <bouge/Util.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace bouge {
+
+    BonePalette::BonePalette(const CoreHardwareMesh& hwmesh, CoreSkeletonPtrC skel)
+        : m_starts(1, 0)
+    {
+        m_starts.reserve(hwmesh.submeshCount() + 1);
+        for(CoreHardwareMesh::const_iterator i = hwmesh.begin() ; i != hwmesh.end() ; ++i) {
+            for(std::size_t iSlot = 0 ; iSlot < i->boneCount() ; ++iSlot) {
+                m_boneIds.push_back(skel->boneId(i->boneName(iSlot)));
+            }
+            m_starts.push_back(m_boneIds.size());
+        }
+    }
+
+    BonePalette::~BonePalette()
+    { }
+
+    std::size_t BonePalette::submeshCount() const
+    {
+        return m_starts.size() - 1;
+    }
+
+    std::size_t BonePalette::maxBoneCount() const
+    {
+        std::size_t ret = 0;
+        for(std::size_t i = 0 ; i < this->submeshCount() ; ++i) {
+            ret = std::max(ret, m_starts[i+1] - m_starts[i]);
+        }
+        return ret;
+    }
+
+    std::size_t BonePalette::slotCount() const
+    {
+        return m_boneIds.size();
+    }
+
+    std::size_t BonePalette::firstSlot(std::size_t submeshIdx) const
+    {
+        if(submeshIdx >= this->submeshCount())
+            throw std::out_of_range("Bone palette of hardware submesh " + to_s(submeshIdx) + " (max: " + to_s(this->submeshCount()) + ")");
+
+        return m_starts[submeshIdx];
+    }
+
+    Span<BoneId> BonePalette::boneIds(std::size_t submeshIdx) const
+    {
+        if(submeshIdx >= this->submeshCount())
+            throw std::out_of_range("Bone palette of hardware submesh " + to_s(submeshIdx) + " (max: " + to_s(this->submeshCount()) + ")");
+
+        return Span<BoneId>(m_boneIds).sub(m_starts[submeshIdx], m_starts[submeshIdx+1] - m_starts[submeshIdx]);
+    }
+
+    std::size_t BonePalette::writeMatrices(std::size_t submeshIdx, SkeletonInstancePtrC skel, float* out) const
+    {
+        Span<BoneId> ids = this->boneIds(submeshIdx);
+        for(std::size_t i = 0 ; i < ids.size() ; ++i) {
+            const float* m = skel->bone(ids[i])->transformMatrix().array16f();
+            std::copy(m, m + 16, out + 16*i);
+        }
+
+        return 16*ids.size();
+    }
+
+    std::size_t BonePalette::writeNormalMatrices(std::size_t submeshIdx, SkeletonInstancePtrC skel, float* out) const
+    {
+        Span<BoneId> ids = this->boneIds(submeshIdx);
+        for(std::size_t i = 0 ; i < ids.size() ; ++i) {
+            const float* im = skel->bone(ids[i])->transformMatrix().array9fInverse();
+            for(std::size_t r = 0 ; r < 3 ; ++r) {
+                for(std::size_t c = 0 ; c < 3 ; ++c) {
+                    out[9*i + 3*r + c] = im[3*c + r];
+                }
+            }
+        }
+
+        return 9*ids.size();
+    }
+
+    std::size_t BonePalette::writeDualQuaternions(std::size_t submeshIdx, SkeletonInstancePtrC skel, float* out) const
+    {
+        Span<BoneId> ids = this->boneIds(submeshIdx);
+        for(std::size_t i = 0 ; i < ids.size() ; ++i) {
+            const float* dq = skel->bone(ids[i])->transformDualQuaternion().array8f();
+            std::copy(dq, dq + 8, out + 8*i);
+        }
+
+        return 8*ids.size();
+    }
+
+    void BonePalette::skinDualQuaternions(const CoreHardwareMesh& hwmesh, SkeletonInstancePtrC skel, float* outCoords, const std::string& normalAttrib, float* outNormals) const
+    {
+        if(hwmesh.submeshCount() != this->submeshCount())
+            throw std::invalid_argument("The hardware mesh has " + to_s(hwmesh.submeshCount()) + " submeshes but the bone palette was built for " + to_s(this->submeshCount()));
+
+        const std::vector<float>& coords = hwmesh.coords();
+        const std::vector<float>& weights = hwmesh.weights();
+        const std::vector<float>& boneIndices = hwmesh.boneIndices();
+        std::size_t nCoords = hwmesh.coordsPerVertex();
+        std::size_t nBones = hwmesh.weightsPerVertex();
+
+        bool bNormals = !normalAttrib.empty();
+        const std::vector<float>* normals = bNormals ? &hwmesh.attrib(normalAttrib) : 0;
+        std::size_t nNormalCoords = bNormals ? hwmesh.attribCoordsPerVertex(normalAttrib) : 0;
+
+        // Keep the extra coordinates (like w) as they are.
+        std::copy(coords.begin(), coords.end(), outCoords);
+        if(bNormals)
+            std::copy(normals->begin(), normals->end(), outNormals);
+
+        std::vector<DualQuaternion> palette;
+        palette.reserve(this->maxBoneCount());
+
+        std::size_t iSubmesh = 0;
+        for(CoreHardwareMesh::const_iterator i = hwmesh.begin() ; i != hwmesh.end() ; ++i, ++iSubmesh) {
+            palette.clear();
+            Span<BoneId> ids = this->boneIds(iSubmesh);
+            for(std::size_t iSlot = 0 ; iSlot < ids.size() ; ++iSlot) {
+                palette.push_back(skel->bone(ids[iSlot])->transformDualQuaternion());
+            }
+
+            // Without any bone, the vertices keep their bind pose coordinates
+            // which have already been copied.
+            if(nBones == 0 || palette.empty())
+                continue;
+
+            for(std::size_t iVtx = i->baseVertex() ; iVtx < i->baseVertex() + i->vertexCount() ; ++iVtx) {
+                // Blend all influences, flipping those whose rotation lies on
+                // the other hemisphere than the first one's, so that the blend
+                // takes the shortest path. The unused slots have a zero weight
+                // and their bone index means nothing, so they are skipped.
+                static const float zero[8] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+                const DualQuaternion* first = 0;
+                DualQuaternion blended(zero);
+                for(std::size_t iBone = 0 ; iBone < nBones ; ++iBone) {
+                    float w = weights[nBones*iVtx + iBone];
+                    if(w == 0.0f)
+                        continue;
+
+                    const DualQuaternion& dq = palette[(std::size_t)boneIndices[nBones*iVtx + iBone]];
+                    if(!first)
+                        first = &dq;
+                    blended += dq * (first->dotReal(dq) < 0.0f ? -w : w);
+                }
+
+                // Not influenced by any bone, keep it where it is.
+                if(!first)
+                    continue;
+
+                blended.normalize();
+
+                Vector v = blended.transform(Vector(coords[nCoords*iVtx], coords[nCoords*iVtx+1], coords[nCoords*iVtx+2]));
+                outCoords[nCoords*iVtx  ] = v.x();
+                outCoords[nCoords*iVtx+1] = v.y();
+                outCoords[nCoords*iVtx+2] = v.z();
+
+                if(bNormals) {
+                    const float* n = &(*normals)[nNormalCoords*iVtx];
+                    Vector nor = blended.rotate(Vector(n[0], n[1], n[2]));
+                    outNormals[nNormalCoords*iVtx  ] = nor.x();
+                    outNormals[nNormalCoords*iVtx+1] = nor.y();
+                    outNormals[nNormalCoords*iVtx+2] = nor.z();
+                }
+            }
+        }
+    }
+
+    std::size_t BonePalette::floatsPerMatrix(MatrixLayout layout)
+    {
+        switch(layout) {
+        case Matrix3x4: return 12;
+        case DualQuaternion8: return 8;
+        default: return 16;
+        }
+    }
+
+    /// \internal Writes the matrix of a single bone in the given layout.
+    /// \return The number of floats written.
+    static std::size_t writeBone(BoneInstancePtrC bone, float* out, BonePalette::MatrixLayout layout)
+    {
+        if(layout == BonePalette::DualQuaternion8) {
+            const float* dq = bone->transformDualQuaternion().array8f();
+            std::copy(dq, dq + 8, out);
+            return 8;
+        }
+
+        const float* m = bone->transformMatrix().array16f();
+        if(layout == BonePalette::Matrix3x4) {
+            // array16f is column after column, we want the rows.
+            for(std::size_t r = 0 ; r < 3 ; ++r) {
+                for(std::size_t c = 0 ; c < 4 ; ++c) {
+                    out[4*r + c] = m[4*c + r];
+                }
+            }
+            return 12;
+        }
+
+        std::copy(m, m + 16, out);
+        return 16;
+    }
+
+    std::size_t BonePalette::writeInstance(SkeletonInstancePtrC skel, float* out, MatrixLayout layout) const
+    {
+        std::size_t written = 0;
+        for(std::size_t i = 0 ; i < m_boneIds.size() ; ++i) {
+            written += writeBone(skel->bone(m_boneIds[i]), out + written, layout);
+        }
+
+        return written;
+    }
+
+    std::size_t BonePalette::writeInstances(const std::vector<SkeletonInstancePtrC>& skels, float* out, MatrixLayout layout) const
+    {
+        std::size_t written = 0;
+        for(std::vector<SkeletonInstancePtrC>::const_iterator i = skels.begin() ; i != skels.end() ; ++i) {
+            written += this->writeInstance(*i, out + written, layout);
+        }
+
+        return written;
+    }
+
+    std::size_t BonePalette::writeInstanceHalf(SkeletonInstancePtrC skel, Uint16* out, MatrixLayout layout) const
+    {
+        float tmp[16];
+        std::size_t written = 0;
+        for(std::size_t i = 0 ; i < m_boneIds.size() ; ++i) {
+            std::size_t n = writeBone(skel->bone(m_boneIds[i]), tmp, layout);
+            for(std::size_t j = 0 ; j < n ; ++j) {
+                out[written++] = toHalf(tmp[j]);
+            }
+        }
+
+        return written;
+    }
+
+    std::size_t BonePalette::writeInstancesHalf(const std::vector<SkeletonInstancePtrC>& skels, Uint16* out, MatrixLayout layout) const
+    {
+        std::size_t written = 0;
+        for(std::vector<SkeletonInstancePtrC>::const_iterator i = skels.begin() ; i != skels.end() ; ++i) {
+            written += this->writeInstanceHalf(*i, out + written, layout);
+        }
+
+        return written;
+    }
+
+    bool BonePalette::hasUniformScale(SkeletonInstancePtrC skel, float epsilon) const
+    {
+        for(std::size_t i = 0 ; i < m_boneIds.size() ; ++i) {
+            Vector s = skel->bone(m_boneIds[i])->scale();
+            if(!nearZero(s.x() - s.y(), epsilon) || !nearZero(s.x() - s.z(), epsilon))
+                return false;
+        }
+
+        return true;
+    }
+
+} // namespace bouge
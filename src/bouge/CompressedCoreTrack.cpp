@@ -0,0 +1,406 @@
+////////////////////////////////////////////////////////////
+//
+// Bouge - Modern and flexible skeletal animation library
+// Copyright (C) 2010 Lucas Beyer (pompei2@gmail.com)
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it freely,
+// subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+////////////////////////////////////////////////////////////
+#include <bouge/CompressedCoreTrack.hpp>
+#include <bouge/CoreKeyframe.hpp>
+#include <bouge/Math/Util.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace bouge {
+
+    CompressionError::CompressionError()
+        : rotation(0.0f)
+        , translation(0.0f)
+        , scale(0.0f)
+    { }
+
+    CompressionError& CompressionError::merge(const CompressionError& other)
+    {
+        rotation = std::max(rotation, other.rotation);
+        translation = std::max(translation, other.translation);
+        scale = std::max(scale, other.scale);
+        return *this;
+    }
+
+    /// \internal The three smallest components of a unit quaternion lie within +-1/sqrt(2).
+    static const float smallestThreeRange = 0.70710678f;
+
+    /// \internal Quantizes \a f, which lies within [min ; min+extent], to 16 bits.
+    static Uint16 quantize16(float f, float min, float extent)
+    {
+        if(extent <= 0.0f)
+            return 0;
+
+        return (Uint16)clamp((f - min) / extent * 65535.0f + 0.5f, 0.0f, 65535.0f);
+    }
+
+    void CompressedCoreTrack::VectorChannel::compress(const std::vector<Vector>& values, float tolerance)
+    {
+        for(int c = 0 ; c < 3 ; ++c) {
+            float lo = values[0].array3f()[c];
+            float hi = lo;
+            for(std::size_t i = 1 ; i < values.size() ; ++i) {
+                lo = std::min(lo, values[i].array3f()[c]);
+                hi = std::max(hi, values[i].array3f()[c]);
+            }
+            min[c] = lo;
+            extent[c] = hi - lo;
+        }
+
+        constant = extent[0] <= tolerance && extent[1] <= tolerance && extent[2] <= tolerance;
+        if(constant) {
+            // Keep the first one exactly, as that's what a single keyframe would give.
+            for(int c = 0 ; c < 3 ; ++c) {
+                min[c] = values[0].array3f()[c];
+                extent[c] = 0.0f;
+            }
+            return;
+        }
+
+        quantized.reserve(3*values.size());
+        for(std::size_t i = 0 ; i < values.size() ; ++i) {
+            for(int c = 0 ; c < 3 ; ++c) {
+                quantized.push_back(quantize16(values[i].array3f()[c], min[c], extent[c]));
+            }
+        }
+    }
+
+    Vector CompressedCoreTrack::VectorChannel::at(std::size_t idx) const
+    {
+        if(constant)
+            return Vector(min[0], min[1], min[2]);
+
+        const Uint16* q = &quantized[3*idx];
+        return Vector(min[0] + extent[0] * (float)q[0] / 65535.0f,
+                      min[1] + extent[1] * (float)q[1] / 65535.0f,
+                      min[2] + extent[2] * (float)q[2] / 65535.0f);
+    }
+
+    /// \internal Packs a unit quaternion into 48 bits: the three smallest
+    /// components using 15 bits each, the two bits telling which one is the
+    /// largest one and its sign go into the highest bit of each word.
+    static void packRotation(const Quaternion& q, std::vector<Uint16>& out)
+    {
+        const float* c = q.array4f();
+        float len = std::sqrt(c[0]*c[0] + c[1]*c[1] + c[2]*c[2] + c[3]*c[3]);
+        float n[4] = {c[0]/len, c[1]/len, c[2]/len, c[3]/len};
+
+        int largest = 0;
+        for(int i = 1 ; i < 4 ; ++i) {
+            if(std::fabs(n[i]) > std::fabs(n[largest]))
+                largest = i;
+        }
+
+        Uint16 words[3];
+        for(int i = 0, j = 0 ; i < 4 ; ++i) {
+            if(i == largest)
+                continue;
+
+            float f = clamp((n[i] + smallestThreeRange) / (2.0f*smallestThreeRange), 0.0f, 1.0f);
+            words[j++] = (Uint16)(f * 32766.0f + 0.5f);
+        }
+
+        words[0] |= (Uint16)((largest & 1) << 15);
+        words[1] |= (Uint16)((largest >> 1) << 15);
+        words[2] |= (Uint16)((n[largest] < 0.0f ? 1 : 0) << 15);
+        out.insert(out.end(), words, words + 3);
+    }
+
+    /// \internal The reverse of packRotation.
+    static Quaternion unpackRotation(const Uint16* words)
+    {
+        int largest = (words[0] >> 15) | ((words[1] >> 15) << 1);
+        bool negative = (words[2] >> 15) != 0;
+
+        float n[4];
+        float sum = 0.0f;
+        for(int i = 0, j = 0 ; i < 4 ; ++i) {
+            if(i == largest)
+                continue;
+
+            n[i] = (float)(words[j++] & 0x7fff) / 32766.0f * 2.0f*smallestThreeRange - smallestThreeRange;
+            sum += n[i]*n[i];
+        }
+
+        n[largest] = std::sqrt(std::max(0.0f, 1.0f - sum));
+        if(negative)
+            n[largest] = -n[largest];
+
+        return Quaternion(n[0], n[1], n[2], n[3]);
+    }
+
+    /// \internal \return The biggest difference of any component of \a a and \a b.
+    static float maxDifference(const Vector& a, const Vector& b)
+    {
+        return std::max(std::fabs(a.x() - b.x()), std::max(std::fabs(a.y() - b.y()), std::fabs(a.z() - b.z())));
+    }
+
+    CompressedCoreTrack::CompressedCoreTrack(const CoreTrack& source, float tolerance)
+        : m_bHasRot(source.hasRotation())
+        , m_bConstRot(false)
+    {
+        if(source.begin() == source.end())
+            throw std::invalid_argument("Can't compress a track without keyframes");
+
+        this->interpolation(source.interpolation());
+
+        std::vector<Quaternion> rots;
+        std::vector<Vector> transs, scales;
+        for(CoreTrack::const_iterator i = source.begin() ; i != source.end() ; ++i) {
+            m_times.push_back(i.time());
+            rots.push_back(i->rotation());
+            transs.push_back(i->translation());
+            scales.push_back(i->scale());
+        }
+
+        // Rotations
+        const float* first = rots[0].array4f();
+        std::copy(first, first + 4, m_constRot);
+        m_bConstRot = true;
+        for(std::size_t i = 1 ; i < rots.size() && m_bConstRot ; ++i) {
+            for(int c = 0 ; c < 4 ; ++c) {
+                if(std::fabs(rots[i].array4f()[c] - first[c]) > tolerance)
+                    m_bConstRot = false;
+            }
+        }
+
+        if(!m_bConstRot) {
+            m_rot.reserve(3*rots.size());
+            for(std::size_t i = 0 ; i < rots.size() ; ++i) {
+                packRotation(rots[i], m_rot);
+            }
+        }
+
+        // Translations and scales
+        m_trans.has = source.hasTranslation();
+        m_trans.compress(transs, tolerance);
+        m_scale.has = source.hasScale();
+        m_scale.compress(scales, tolerance);
+
+        // Now measure what we lost, at the keyframes and in between them.
+        for(std::size_t i = 0 ; i < m_times.size() ; ++i) {
+            float t = m_times[i];
+            for(int half = 0 ; half < 2 ; ++half) {
+                m_error.rotation = std::max(m_error.rotation, source.rotation(t).angleTo(this->rotation(t)));
+                m_error.translation = std::max(m_error.translation, (source.translation(t) - this->translation(t)).len());
+                m_error.scale = std::max(m_error.scale, maxDifference(source.scale(t), this->scale(t)));
+
+                if(i + 1 == m_times.size())
+                    break;
+                t = 0.5f*(m_times[i] + m_times[i+1]);
+            }
+        }
+    }
+
+    CompressedCoreTrack::~CompressedCoreTrack()
+    { }
+
+    void CompressedCoreTrack::keyframesAround(float time, std::size_t& from, std::size_t& to) const
+    {
+        // Just the same as CoreTrack does with its after method.
+        to = std::upper_bound(m_times.begin(), m_times.end(), time) - m_times.begin();
+        if(to == m_times.size())
+            --to;
+
+        from = to == 0 ? 0 : to - 1;
+    }
+
+    void CompressedCoreTrack::neighbours(std::size_t from, std::size_t to, std::size_t& prev, std::size_t& next) const
+    {
+        prev = from == 0 ? from : from - 1;
+        next = to + 1 == m_times.size() ? to : to + 1;
+    }
+
+    Quaternion CompressedCoreTrack::rotationAt(std::size_t idx) const
+    {
+        if(m_bConstRot)
+            return Quaternion(m_constRot[0], m_constRot[1], m_constRot[2], m_constRot[3]);
+
+        return unpackRotation(&m_rot[3*idx]);
+    }
+
+    bool CompressedCoreTrack::hasRotation() const
+    {
+        return m_bHasRot;
+    }
+
+    Quaternion CompressedCoreTrack::rotation(float time) const
+    {
+        if(!this->hasRotation())
+            return Quaternion();
+
+        if(m_bConstRot)
+            return this->rotationAt(0);
+
+        std::size_t from, to;
+        this->keyframesAround(time, from, to);
+        if(from == to)
+            return this->rotationAt(from);
+
+        float between = (time - m_times[from])/(m_times[to] - m_times[from]);
+        if(this->interpolation() == InterpolationSpline && between <= 1.0f) {
+            std::size_t prev, next;
+            this->neighbours(from, to, prev, next);
+            return spline(this->rotationAt(prev), this->rotationAt(from), this->rotationAt(to), this->rotationAt(next),
+                          m_times[prev], m_times[from], m_times[to], m_times[next], between);
+        }
+
+        // The rotations keep their sign, thus when the source track had its
+        // rotations aligned, so do we and we can go the fast way.
+        Quaternion qFrom = this->rotationAt(from), qTo = this->rotationAt(to);
+        if(between <= 1.0f && qFrom.dot(qTo) >= 0.0f)
+            return qFrom.fastSlerp(qTo, between);
+
+        return qFrom.slerp(qTo, between);
+    }
+
+    bool CompressedCoreTrack::hasTranslation() const
+    {
+        return m_trans.has;
+    }
+
+    Vector CompressedCoreTrack::translation(float time) const
+    {
+        if(!this->hasTranslation())
+            return Vector();
+
+        if(m_trans.constant)
+            return m_trans.at(0);
+
+        std::size_t from, to;
+        this->keyframesAround(time, from, to);
+        if(from == to)
+            return m_trans.at(from);
+
+        float between = (time - m_times[from])/(m_times[to] - m_times[from]);
+        if(this->interpolation() == InterpolationSpline && between <= 1.0f) {
+            std::size_t prev, next;
+            this->neighbours(from, to, prev, next);
+            return spline(m_trans.at(prev), m_trans.at(from), m_trans.at(to), m_trans.at(next),
+                          m_times[prev], m_times[from], m_times[to], m_times[next], between);
+        }
+
+        return m_trans.at(from).lerp(m_trans.at(to), between);
+    }
+
+    bool CompressedCoreTrack::hasScale() const
+    {
+        return m_scale.has;
+    }
+
+    Vector CompressedCoreTrack::scale(float time) const
+    {
+        if(!this->hasScale())
+            return Vector(1.0f, 1.0f, 1.0f);
+
+        if(m_scale.constant)
+            return m_scale.at(0);
+
+        std::size_t from, to;
+        this->keyframesAround(time, from, to);
+        if(from == to)
+            return m_scale.at(from);
+
+        float between = (time - m_times[from])/(m_times[to] - m_times[from]);
+        if(this->interpolation() == InterpolationSpline && between <= 1.0f) {
+            std::size_t prev, next;
+            this->neighbours(from, to, prev, next);
+            return spline(m_scale.at(prev), m_scale.at(from), m_scale.at(to), m_scale.at(next),
+                          m_times[prev], m_times[from], m_times[to], m_times[next], between);
+        }
+
+        return m_scale.at(from).lerp(m_scale.at(to), between);
+    }
+
+    std::size_t CompressedCoreTrack::keyframeCount() const
+    {
+        return m_times.size();
+    }
+
+    float CompressedCoreTrack::duration() const
+    {
+        return m_times.back();
+    }
+
+    CoreTrack::iterator CompressedCoreTrack::begin()
+    {
+        throw std::logic_error("Can't edit the keyframes of a compressed track, decompress it first");
+    }
+
+    CoreTrack::iterator CompressedCoreTrack::closest(float)
+    {
+        throw std::logic_error("Can't edit the keyframes of a compressed track, decompress it first");
+    }
+
+    CoreTrack::iterator CompressedCoreTrack::after(float)
+    {
+        throw std::logic_error("Can't edit the keyframes of a compressed track, decompress it first");
+    }
+
+    CoreTrack& CompressedCoreTrack::add(float, CoreKeyframePtr)
+    {
+        throw std::logic_error("Can't add keyframes to a compressed track, decompress it first");
+    }
+
+    CoreTrack& CompressedCoreTrack::remove(iterator)
+    {
+        throw std::logic_error("Can't remove keyframes from a compressed track, decompress it first");
+    }
+
+    CoreTrack& CompressedCoreTrack::removeAllIn(float, float)
+    {
+        throw std::logic_error("Can't remove keyframes from a compressed track, decompress it first");
+    }
+
+    const CompressionError& CompressedCoreTrack::error() const
+    {
+        return m_error;
+    }
+
+    std::size_t CompressedCoreTrack::byteSize() const
+    {
+        return m_times.size()*sizeof(float) + (m_rot.size() + m_trans.quantized.size() + m_scale.quantized.size())*sizeof(Uint16);
+    }
+
+    CoreTrackPtr CompressedCoreTrack::decompress() const
+    {
+        CoreTrackPtr ret(new CoreTrack());
+        ret->interpolation(this->interpolation());
+        for(std::size_t i = 0 ; i < m_times.size() ; ++i) {
+            CoreKeyframePtr kf(new CoreKeyframe());
+            if(this->hasRotation())
+                kf->rotation(this->rotationAt(i));
+            if(this->hasTranslation())
+                kf->translation(m_trans.at(m_trans.constant ? 0 : i));
+            if(this->hasScale())
+                kf->scale(m_scale.at(m_scale.constant ? 0 : i));
+            ret->add(m_times[i], kf);
+        }
+
+        return ret;
+    }
+
+} // namespace bouge
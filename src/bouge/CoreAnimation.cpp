@@ -23,15 +23,23 @@
 ////////////////////////////////////////////////////////////
 #include <bouge/CoreAnimation.hpp>
 #include <bouge/CoreTrack.hpp>
+#include <bouge/CoreKeyframe.hpp>
 #include <bouge/Math/TimeFunction.hpp>
+#include <bouge/Math/Util.hpp>
 
+#include <algorithm>
 #include <stdexcept>
 
 namespace bouge {
 
     CoreAnimation::CoreAnimation(std::string name, TimeFunction* preferredControl)
-        : m_sName(name)
+        : m_name(name)
         , m_preferredControl(preferredControl)
+        , m_bAdditive(false)
+        , m_duration(0.0f)
+        , m_bHasRotation(false)
+        , m_bHasTranslation(false)
+        , m_bHasScale(false)
     {
         if(!m_preferredControl)
             m_preferredControl = new RepeatTF(new LinearTF(1.0f));
@@ -42,27 +50,159 @@ namespace bouge {
         delete m_preferredControl;
     }
 
-    std::string CoreAnimation::name() const
+    const Name& CoreAnimation::name() const
     {
-        return m_sName;
+        return m_name;
     }
 
-    CoreAnimation& CoreAnimation::name(std::string name)
+    CoreAnimation& CoreAnimation::name(const Name& name)
     {
-        m_sName = name;
+        m_name = name;
         return *this;
     }
 
     float CoreAnimation::duration() const
     {
-        float duration = 0.0f;
+        return m_duration;
+    }
+
+    bool CoreAnimation::hasRotation() const
+    {
+        return m_bHasRotation;
+    }
 
-        /// \TODO: If this indeed is a bottleneck (MEASURE!), we might cache that value and add a "recalc" method.
-        for(const_iterator iTrack = this->begin() ; iTrack != this->end() ; ++iTrack) {
-            duration = std::max(duration, iTrack->duration());
+    bool CoreAnimation::hasTranslation() const
+    {
+        return m_bHasTranslation;
+    }
+
+    bool CoreAnimation::hasScale() const
+    {
+        return m_bHasScale;
+    }
+
+    void CoreAnimation::addMetadata(const CoreTrack& track)
+    {
+        m_duration = std::max(m_duration, track.duration());
+        m_bHasRotation = m_bHasRotation || track.hasRotation();
+        m_bHasTranslation = m_bHasTranslation || track.hasTranslation();
+        m_bHasScale = m_bHasScale || track.hasScale();
+    }
+
+    CoreAnimation& CoreAnimation::updateMetadata()
+    {
+        m_duration = 0.0f;
+        m_bHasRotation = m_bHasTranslation = m_bHasScale = false;
+        for(TrackMap::const_iterator i = m_tracks.begin() ; i != m_tracks.end() ; ++i) {
+            this->addMetadata(*i->second);
         }
 
-        return duration;
+        return *this;
+    }
+
+    CompressionError CoreAnimation::compress()
+    {
+        CompressionError ret;
+        for(TrackMap::iterator i = m_tracks.begin() ; i != m_tracks.end() ; ++i) {
+            // Only real keyframes can be compressed. Look at them through a
+            // const track, as the non-const begin() drops the detected constants.
+            const CoreTrack& track = *i->second;
+            if(track.begin() == track.end())
+                continue;
+
+            CompressedCoreTrack* compressed = new CompressedCoreTrack(*i->second);
+            ret.merge(compressed->error());
+            i->second = CoreTrackPtr(compressed);
+        }
+
+        this->updateMetadata();
+        return ret;
+    }
+
+    CompressionError CoreAnimation::resample(float rate)
+    {
+        CompressionError ret;
+        for(TrackMap::iterator i = m_tracks.begin() ; i != m_tracks.end() ; ++i) {
+            if(dynamic_cast<const ResampledCoreTrack*>(i->second.get()) || i->second->keyframeCount() == 0)
+                continue;
+
+            ResampledCoreTrack* resampled = new ResampledCoreTrack(*i->second, rate);
+            ret.merge(resampled->error());
+            i->second = CoreTrackPtr(resampled);
+        }
+
+        this->updateMetadata();
+        return ret;
+    }
+
+    CoreAnimation& CoreAnimation::detectConstants(float tolerance)
+    {
+        for(TrackMap::iterator i = m_tracks.begin() ; i != m_tracks.end() ; ++i) {
+            i->second->detectConstants(tolerance);
+        }
+
+        // Tracks may have dropped some of their channels.
+        return this->updateMetadata();
+    }
+
+    CoreAnimation& CoreAnimation::makeAdditive(CoreAnimationPtrC reference, float referenceTime)
+    {
+        // Check first, so that we don't leave it half-done.
+        for(TrackMap::const_iterator i = m_tracks.begin() ; i != m_tracks.end() ; ++i) {
+            const CoreTrack& track = *i->second;
+            if(track.keyframeCount() > 0 && track.begin() == track.end())
+                throw std::invalid_argument("Can't make the animation '" + this->name() + "' additive: the track of the bone '" + i->first + "' has been compressed or resampled");
+        }
+
+        for(TrackMap::iterator i = m_tracks.begin() ; i != m_tracks.end() ; ++i) {
+            // A bone the reference doesn't move stays in its rest pose there.
+            CoreTrackPtrC ref = i->second;
+            if(reference)
+                ref = reference->hasTrack(i->first) ? reference->track(i->first) : CoreTrackPtrC();
+
+            bool rot = i->second->hasRotation() || (ref && ref->hasRotation());
+            bool trans = i->second->hasTranslation() || (ref && ref->hasTranslation());
+            bool scale = i->second->hasScale() || (ref && ref->hasScale());
+            Quaternion refRotInv = ref ? ref->rotation(referenceTime).inv() : Quaternion();
+            Vector refTrans = ref ? ref->translation(referenceTime) : Vector();
+            Vector refScale = ref ? ref->scale(referenceTime) : Vector(1.0f, 1.0f, 1.0f);
+
+            // The mixer applies rotations as rot * track, translations as
+            // trans + track and scales as scale * track, so undo the
+            // reference the same way.
+            CoreTrack& track = *i->second;
+            for(CoreTrack::iterator k = track.begin() ; k != track.end() ; ++k) {
+                if(rot)
+                    k->rotation(refRotInv * k->rotation());
+                if(trans)
+                    k->translation(k->translation() - refTrans);
+                if(scale) {
+                    Vector s = k->scale();
+                    for(unsigned int c = 0 ; c < 3 ; ++c) {
+                        if(!nearZero(refScale[c]))
+                            s[c] /= refScale[c];
+                    }
+                    k->scale(s);
+                }
+            }
+
+            track.alignRotations().detectConstants();
+        }
+
+        // Tracks may have dropped some of their channels.
+        m_bAdditive = true;
+        return this->updateMetadata();
+    }
+
+    bool CoreAnimation::additive() const
+    {
+        return m_bAdditive;
+    }
+
+    CoreAnimation& CoreAnimation::additive(bool additive)
+    {
+        m_bAdditive = additive;
+        return *this;
     }
 
     const TimeFunction* CoreAnimation::preferredControl() const
@@ -70,12 +210,24 @@ namespace bouge {
         return m_preferredControl;
     }
 
-    bool CoreAnimation::hasTrack(const std::string& bone)
+    bool CoreAnimation::hasTrack(const Name& bone) const
     {
         return m_tracks.find(bone) != m_tracks.end();
     }
 
-    CoreTrackPtr CoreAnimation::track(const std::string& bone)
+    bool CoreAnimation::hasTrack(const std::string& bone) const
+    {
+        // An unknown text can't name anything, but it does find the empty name.
+        Name found = Name::find(bone);
+        return (!found.empty() || bone.empty()) && this->hasTrack(found);
+    }
+
+    bool CoreAnimation::hasTrack(const char* bone) const
+    {
+        return this->hasTrack(std::string(bone));
+    }
+
+    CoreTrackPtr CoreAnimation::track(const Name& bone)
     {
         TrackMap::iterator i = m_tracks.find(bone);
         if(i == m_tracks.end())
@@ -84,7 +236,7 @@ namespace bouge {
         return i->second;
     }
 
-    const CoreTrackPtr CoreAnimation::track(const std::string& bone) const
+    const CoreTrackPtr CoreAnimation::track(const Name& bone) const
     {
         TrackMap::const_iterator i = m_tracks.find(bone);
         if(i == m_tracks.end())
@@ -93,9 +245,17 @@ namespace bouge {
         return i->second;
     }
 
-    CoreAnimation& CoreAnimation::track(const std::string& bone, CoreTrackPtr track)
+    CoreAnimation& CoreAnimation::track(const Name& bone, CoreTrackPtr track)
     {
-        m_tracks[bone] = track;
+        std::pair<TrackMap::iterator, bool> added = m_tracks.insert(std::make_pair(bone, track));
+        if(added.second) {
+            this->addMetadata(*track);
+        } else {
+            // Replacing a track may make the animation shorter.
+            added.first->second = track;
+            this->updateMetadata();
+        }
+
         return *this;
     }
 
@@ -144,7 +304,7 @@ namespace bouge {
         return iterator(myIter--);
     }
 
-    std::string CoreAnimation::iterator::bone() const
+    const Name& CoreAnimation::iterator::bone() const
     {
         return myIter->first;
     }
@@ -209,7 +369,7 @@ namespace bouge {
         return const_iterator(myIter--);
     }
 
-    std::string CoreAnimation::const_iterator::bone() const
+    const Name& CoreAnimation::const_iterator::bone() const
     {
         return myIter->first;
     }
@@ -234,4 +394,91 @@ namespace bouge {
         return const_iterator(m_tracks.end());
     }
 
+    CoreAnimation& CoreAnimation::addMarker(float time, const Name& name)
+    {
+        m_markers.insert(std::make_pair(time, name));
+        return *this;
+    }
+
+    CoreAnimation& CoreAnimation::removeAllMarkers()
+    {
+        m_markers.clear();
+        return *this;
+    }
+
+    std::size_t CoreAnimation::markerCount() const
+    {
+        return m_markers.size();
+    }
+
+    CoreAnimation::const_marker_iterator::const_marker_iterator(MarkerMap::const_iterator me)
+        : myIter(me)
+    { }
+
+    CoreAnimation::const_marker_iterator::const_marker_iterator()
+    { }
+
+    CoreAnimation::const_marker_iterator::~const_marker_iterator()
+    { }
+
+    bool CoreAnimation::const_marker_iterator::operator==(const_marker_iterator other) const
+    {
+        return myIter == other.myIter;
+    }
+
+    bool CoreAnimation::const_marker_iterator::operator!=(const_marker_iterator other) const
+    {
+        return myIter != other.myIter;
+    }
+
+    CoreAnimation::const_marker_iterator& CoreAnimation::const_marker_iterator::operator++()
+    {
+        return ++myIter, *this;
+    }
+
+    CoreAnimation::const_marker_iterator CoreAnimation::const_marker_iterator::operator++(int)
+    {
+        return const_marker_iterator(myIter++);
+    }
+
+    CoreAnimation::const_marker_iterator& CoreAnimation::const_marker_iterator::operator--()
+    {
+        return --myIter, *this;
+    }
+
+    CoreAnimation::const_marker_iterator CoreAnimation::const_marker_iterator::operator--(int)
+    {
+        return const_marker_iterator(myIter--);
+    }
+
+    float CoreAnimation::const_marker_iterator::time() const
+    {
+        return myIter->first;
+    }
+
+    const Name& CoreAnimation::const_marker_iterator::name() const
+    {
+        return myIter->second;
+    }
+
+    CoreAnimation::const_marker_iterator CoreAnimation::begin_marker() const
+    {
+        return const_marker_iterator(m_markers.begin());
+    }
+
+    CoreAnimation::const_marker_iterator CoreAnimation::end_marker() const
+    {
+        return const_marker_iterator(m_markers.end());
+    }
+
+    CoreAnimation::const_marker_iterator CoreAnimation::markersFrom(float time) const
+    {
+        return const_marker_iterator(m_markers.lower_bound(time));
+    }
+
+    CoreAnimation::const_marker_iterator CoreAnimation::markersAfter(float time) const
+    {
+        return const_marker_iterator(m_markers.upper_bound(time));
+    }
+
 }
@@ -0,0 +1,229 @@
+////////////////////////////////////////////////////////////
+//
+// Bouge - Modern and flexible skeletal animation library
+// Copyright (C) 2010 Lucas Beyer (pompei2@gmail.com)
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it freely,
+// subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+////////////////////////////////////////////////////////////
+#include <bouge/CoreAnimationReducer.hpp>
+#include <bouge/CoreAnimation.hpp>
+#include <bouge/CoreBone.hpp>
+#include <bouge/CoreKeyframe.hpp>
+#include <bouge/CoreSkeleton.hpp>
+#include <bouge/CoreTrack.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <vector>
+
+namespace bouge {
+
+    KeyframeReduction::KeyframeReduction()
+        : keyframesBefore(0)
+        , keyframesAfter(0)
+        , maxError(0.0f)
+    { }
+
+    /// \internal \return The biggest difference of any component of \a a and \a b.
+    static float maxDifference(const Vector& a, const Vector& b)
+    {
+        return std::max(std::fabs(a.x() - b.x()), std::max(std::fabs(a.y() - b.y()), std::fabs(a.z() - b.z())));
+    }
+
+    /// \internal
+    /// Walks all the bones below \a bone, finding how far away from \a origin
+    /// the farthest bone tip is and how many bones the longest chain has.
+    static void measureChildren(CoreBonePtrC bone, const Vector& origin, float& reach, std::size_t& chain)
+    {
+        reach = std::max(reach, (bone->absoluteRootPosition() - origin).len() + bone->length());
+
+        std::size_t longest = 0;
+        for(CoreBone::const_iterator iChild = bone->begin() ; iChild != bone->end() ; ++iChild) {
+            std::size_t childChain = 0;
+            measureChildren(*iChild, origin, reach, childChain);
+            longest = std::max(longest, childChain);
+        }
+
+        chain = longest + 1;
+    }
+
+    CoreAnimationReducer::CoreAnimationReducer()
+        : m_positionTolerance(0.001f)
+        , m_rotationTolerance(0.001f)
+    { }
+
+    CoreAnimationReducer::~CoreAnimationReducer()
+    { }
+
+    float CoreAnimationReducer::positionTolerance() const
+    {
+        return m_positionTolerance;
+    }
+
+    CoreAnimationReducer& CoreAnimationReducer::positionTolerance(float tolerance)
+    {
+        m_positionTolerance = tolerance;
+        return *this;
+    }
+
+    float CoreAnimationReducer::rotationTolerance() const
+    {
+        return m_rotationTolerance;
+    }
+
+    CoreAnimationReducer& CoreAnimationReducer::rotationTolerance(float tolerance)
+    {
+        m_rotationTolerance = tolerance;
+        return *this;
+    }
+
+    KeyframeReduction CoreAnimationReducer::reduce(CoreAnimationPtr anim, CoreSkeletonPtrC skel) const
+    {
+        KeyframeReduction ret;
+        std::map<Name, float> errors;
+
+        for(CoreAnimation::iterator iTrack = anim->begin() ; iTrack != anim->end() ; ++iTrack) {
+            ret.keyframesBefore += iTrack->keyframeCount();
+
+            // Compressed and resampled tracks have no keyframes we could remove,
+            // and we only know how to check linear interpolation.
+            const CoreTrack& track = *iTrack.track();
+            if(track.begin() != track.end() && track.interpolation() == CoreTrack::InterpolationLinear) {
+                TrackTolerance tolerance = {m_positionTolerance, 0.0f, 0.0f};
+                if(skel && skel->hasBone(iTrack.bone())) {
+                    CoreBonePtrC bone = skel->bone(iTrack.bone());
+
+                    std::size_t chain = 0;
+                    measureChildren(bone, bone->absoluteRootPosition(), tolerance.reach, chain);
+                    for(CoreBonePtrC parent = bone ; parent->hasParent() ; parent = parent->parent()) {
+                        ++chain;
+                    }
+
+                    tolerance.distance = m_positionTolerance / (float)chain;
+                    tolerance.length = bone->length();
+                }
+
+                errors[iTrack.bone()] = this->reduce(*iTrack.track(), tolerance);
+            }
+
+            ret.keyframesAfter += iTrack->keyframeCount();
+        }
+
+        // The tracks have been changed through the iterator.
+        anim->updateMetadata();
+
+        // The errors of a bone and of all its parents add up.
+        for(std::map<Name, float>::iterator i = errors.begin() ; i != errors.end() ; ++i) {
+            float error = i->second;
+            if(skel && skel->hasBone(i->first)) {
+                for(CoreBonePtrC bone = skel->bone(i->first) ; bone->hasParent() ; ) {
+                    bone = bone->parent();
+                    std::map<Name, float>::iterator parent = errors.find(bone->name());
+                    if(parent != errors.end())
+                        error += parent->second;
+                }
+            }
+
+            ret.maxError = std::max(ret.maxError, error);
+        }
+
+        return ret;
+    }
+
+    float CoreAnimationReducer::reduce(CoreTrack& track, const TrackTolerance& tolerance) const
+    {
+        // Removing keyframes undoes the alignment, remember it.
+        bool aligned = track.rotationsAligned();
+
+        std::vector<float> times;
+        std::vector<Quaternion> rots;
+        std::vector<Vector> transs, scales;
+        const CoreTrack& constTrack = track;
+        for(CoreTrack::const_iterator i = constTrack.begin() ; i != constTrack.end() ; ++i) {
+            times.push_back(i.time());
+            rots.push_back(i->rotation());
+            transs.push_back(i->translation());
+            scales.push_back(i->scale());
+        }
+
+        if(times.size() < 3)
+            return 0.0f;
+
+        // Going forward, look how far we can get from the last kept keyframe
+        // by interpolating, checking all the keyframes we'd skip against the
+        // original ones, so that the errors don't pile up.
+        std::vector<bool> keep(times.size(), false);
+        keep.front() = keep.back() = true;
+
+        float maxError = 0.0f;
+        float anchorError = 0.0f;
+        std::size_t anchor = 0;
+        for(std::size_t end = 2 ; end < times.size() ; ++end) {
+            float error = 0.0f;
+            bool fits = true;
+            for(std::size_t i = anchor + 1 ; i < end && fits ; ++i) {
+                float between = (times[i] - times[anchor])/(times[end] - times[anchor]);
+
+                // Interpolate just the way the track will do. Once aligned
+                // again, it would go the other way between far apart ones.
+                float angle = 0.0f;
+                if(track.hasRotation() && aligned && rots[anchor].dot(rots[end]) < 0.0f)
+                    fits = false;
+                else if(track.hasRotation() && aligned)
+                    angle = rots[anchor].fastSlerp(rots[end], between).angleTo(rots[i]);
+                else if(track.hasRotation())
+                    angle = rots[anchor].slerp(rots[end], between).angleTo(rots[i]);
+                float dist = 0.0f;
+                if(track.hasTranslation())
+                    dist = (transs[anchor].lerp(transs[end], between) - transs[i]).len();
+                float scale = 0.0f;
+                if(track.hasScale())
+                    scale = maxDifference(scales[anchor].lerp(scales[end], between), scales[i]);
+
+                float modelSpace = dist + angle*tolerance.reach + scale*tolerance.length;
+                fits = fits && angle <= m_rotationTolerance && modelSpace <= tolerance.distance;
+                error = std::max(error, modelSpace);
+            }
+
+            if(fits) {
+                anchorError = error;
+            } else {
+                // The previous one is the farthest we can go, keep it.
+                anchor = end - 1;
+                keep[anchor] = true;
+                maxError = std::max(maxError, anchorError);
+                anchorError = 0.0f;
+            }
+        }
+        maxError = std::max(maxError, anchorError);
+
+        // Going by time keeps the constants the track found, if any.
+        for(std::size_t idx = 0 ; idx < times.size() ; ++idx) {
+            if(!keep[idx])
+                track.removeAllIn(times[idx], times[idx]);
+        }
+
+        if(aligned)
+            track.alignRotations();
+
+        return maxError;
+    }
+
+} // namespace bouge
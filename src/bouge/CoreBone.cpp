@@ -29,7 +29,7 @@ namespace bouge
 {
 
     CoreBone::CoreBone(std::string name, Vector relativeRootPosition, Quaternion relativeBoneRotation, float length)
-        : m_sName(name)
+        : m_name(name)
         , m_relativeRootPosition(relativeRootPosition)
         , m_relativeBoneRotation(relativeBoneRotation)
         , m_boneLength(length)
@@ -80,7 +80,7 @@ namespace bouge
     {
         ChildrenMap::const_iterator i = m_children.find(name);
         if(i == m_children.end())
-            throw std::logic_error("Trying to get the inexistent child named " + name + " of the bone " + m_sName);
+            throw std::logic_error("Trying to get the inexistent child named " + name + " of the bone " + m_name.str());
 
         return i->second;
     }
@@ -89,7 +89,7 @@ namespace bouge
     {
         ChildrenMap::iterator i = m_children.find(name);
         if(i == m_children.end())
-            throw std::logic_error("Trying to get the inexistent child named " + name + " of the bone " + m_sName);
+            throw std::logic_error("Trying to get the inexistent child named " + name + " of the bone " + m_name.str());
 
         return i->second;
     }
@@ -102,7 +102,7 @@ namespace bouge
     CoreBonePtrC CoreBone::parent() const
     {
         if(!this->hasParent())
-            throw std::logic_error("Trying to get the parent of the root bone " + m_sName);
+            throw std::logic_error("Trying to get the parent of the root bone " + m_name.str());
 
         return m_pParent;
     }
@@ -110,7 +110,7 @@ namespace bouge
     CoreBonePtr CoreBone::parent()
     {
         if(!this->hasParent())
-            throw std::logic_error("Trying to get the parent of the root bone " + m_sName);
+            throw std::logic_error("Trying to get the parent of the root bone " + m_name.str());
 
         return m_pParent;
     }
@@ -124,21 +124,21 @@ namespace bouge
         return *this;
     }
 
-    std::string CoreBone::name() const
+    const Name& CoreBone::name() const
     {
-        return m_sName;
+        return m_name;
     }
 
-    CoreBone& CoreBone::name(std::string name)
+    CoreBone& CoreBone::name(const Name& name)
     {
         // We also need to rename it in our parent.
         if(m_pParent) {
-            m_pParent->removeChild(m_sName);
+            m_pParent->removeChild(m_name);
             m_pParent->addChild(CoreBonePtr(this));
         }
 
         // Finally, we can rename ourselves.
-        m_sName = name;
+        m_name = name;
         return *this;
     }
 
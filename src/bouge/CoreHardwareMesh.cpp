@@ -22,10 +22,14 @@
 //
 ////////////////////////////////////////////////////////////
 #include <bouge/CoreHardwareMesh.hpp>
+#include <bouge/CoreHardwareMeshBinary.hpp>
 #include <bouge/CoreMesh.hpp>
 #include <bouge/Face.hpp>
 #include <bouge/Util.hpp>
 
+#include <algorithm>
+#include <cstring>
+#include <fstream>
 #include <stdexcept>
 #include <set>
 #include <vector>
@@ -33,16 +37,25 @@
 
 namespace bouge {
 
-    CoreHardwareSubMesh::CoreHardwareSubMesh(std::size_t startIdx, std::string submeshName)
+    /// \internal
+    /// \return The size of the smallest index type that can address \a vertexCount vertices.
+    static std::size_t narrowestIndexSize(std::size_t vertexCount)
+    {
+        return vertexCount <= 0x10000 ? sizeof(Uint16) : sizeof(Uint32);
+    }
+
+    CoreHardwareSubMesh::CoreHardwareSubMesh(std::size_t startIdx, const Name& submeshName)
         : m_faceCount(0)
         , m_startIdx(startIdx)
+        , m_baseVertex(0)
+        , m_vertexCount(0)
         , m_submeshName(submeshName)
     { }
 
     CoreHardwareSubMesh::~CoreHardwareSubMesh()
     { }
 
-    std::string CoreHardwareSubMesh::submeshName() const
+    const Name& CoreHardwareSubMesh::submeshName() const
     {
         return m_submeshName;
     }
@@ -57,26 +70,41 @@ namespace bouge {
         return m_startIdx;
     }
 
+    std::size_t CoreHardwareSubMesh::baseVertex() const
+    {
+        return m_baseVertex;
+    }
+
+    std::size_t CoreHardwareSubMesh::vertexCount() const
+    {
+        return m_vertexCount;
+    }
+
+    std::size_t CoreHardwareSubMesh::indexSize() const
+    {
+        return narrowestIndexSize(m_vertexCount);
+    }
+
     std::size_t CoreHardwareSubMesh::boneCount() const
     {
         return m_boneIdInSubmeshToName.size();
     }
 
-    bool CoreHardwareSubMesh::hasBone(const std::string& name) const
+    bool CoreHardwareSubMesh::hasBone(const Name& name) const
     {
         return m_boneNameToIdInSubmesh.find(name) != m_boneNameToIdInSubmesh.end();
     }
 
-    unsigned int CoreHardwareSubMesh::boneId(const std::string& name) const
+    unsigned int CoreHardwareSubMesh::boneId(const Name& name) const
     {
-        std::map<std::string, unsigned int>::const_iterator i = m_boneNameToIdInSubmesh.find(name);
+        std::map<Name, unsigned int>::const_iterator i = m_boneNameToIdInSubmesh.find(name);
         if(i == m_boneNameToIdInSubmesh.end())
             throw NotExistException("id of bone", name, "hardware submesh", m_submeshName, __FILE__, __LINE__);
 
         return i->second;
     }
 
-    std::string CoreHardwareSubMesh::boneName(std::size_t idInSubmesh) const
+    const Name& CoreHardwareSubMesh::boneName(std::size_t idInSubmesh) const
     {
         if(idInSubmesh >= m_boneIdInSubmeshToName.size())
             throw NotExistException("bone name of bone with id", to_s(idInSubmesh), "hardware submesh", m_submeshName, __FILE__, __LINE__);
@@ -94,10 +122,10 @@ namespace bouge {
         for(std::vector<Face::index_t>::const_iterator i = f.idxs().begin() ; i != f.idxs().end() ; ++i) {
             Vertex vtx = coreSubMesh->vertex(*i);
             for(std::size_t i = 0 ; i < vtx.influenceCount() ; ++i) {
-                std::string sBoneName = vtx.influence(i).sBoneName;
+                Name boneName = vtx.influence(i).sBoneName;
 
                 // In case the bone is not yet in, and we met our "bone quota", we can't add this face anymore.
-                if(!this->hasBone(sBoneName) && m_boneIdInSubmeshToName.size() >= bonesPerMesh)
+                if(!this->hasBone(boneName) && m_boneIdInSubmeshToName.size() >= bonesPerMesh)
                     return false;
             }
         }
@@ -112,24 +140,69 @@ namespace bouge {
         for(std::vector<Face::index_t>::const_iterator i = f.idxs().begin() ; i != f.idxs().end() ; ++i) {
             Vertex vtx = coreSubMesh->vertex(*i);
             for(std::size_t i = 0 ; i < vtx.influenceCount() ; ++i) {
-                std::string sBoneName = vtx.influence(i).sBoneName;
+                Name boneName = vtx.influence(i).sBoneName;
 
                 // Already in? ignore.
-                if(this->hasBone(sBoneName))
+                if(this->hasBone(boneName))
                     continue;
 
                 // Not yet in? assign a new ID to the bone name.
-                m_boneNameToIdInSubmesh[sBoneName] = m_boneIdInSubmeshToName.size();
-                m_boneIdInSubmeshToName.push_back(sBoneName);
+                this->addBone(boneName);
             }
         }
 
         m_faceCount++;
     }
 
-    CoreHardwareMesh::CoreHardwareMesh(CoreMeshPtrC coremesh, unsigned int bonesPerMesh, unsigned char bonesPerVertex, unsigned char verticesPerFace)
+    void CoreHardwareSubMesh::addBone(const Name& name)
+    {
+        m_boneNameToIdInSubmesh[name] = m_boneIdInSubmeshToName.size();
+        m_boneIdInSubmeshToName.push_back(name);
+    }
+
+    /// \internal
+    /// All the data of a submesh the construction of the hardware mesh needs,
+    /// copied out of the submesh once into flat arrays. The bones are numbered
+    /// locally (per submesh), so that after this, we never need to copy a
+    /// Vertex or to compare bone names anymore.
+    struct CoreHardwareMesh::FlatSubMesh
+    {
+        /// The name of every local bone id.
+        std::vector<Name> boneNames;
+
+        /// The local ids of all the bones influencing a vertex are found in
+        /// \a vertexBones, from \a vertexBoneStart[vtx] to \a vertexBoneStart[vtx+1].
+        std::vector<std::size_t> vertexBoneStart;
+        std::vector<std::size_t> vertexBones;
+
+        /// Three coordinates per vertex.
+        std::vector<float> coords;
+
+        /// bonesPerVertex weights per vertex, already padded with zeroes.
+        std::vector<float> weights;
+
+        /// The generic attributes, in the order of m_genericAttribCoordCount.
+        std::vector< std::vector<float> > attribs;
+
+        /// The indices of the faces we can use (those having verticesPerFace vertices).
+        std::vector<std::size_t> validFaces;
+
+        /// verticesPerFace vertex indices per face (garbage for non-valid faces).
+        std::vector<Face::index_t> faceVerts;
+
+        /// The local ids of all the bones influencing a face, sorted and unique,
+        /// are in \a faceBones from \a faceBoneStart[face] to \a faceBoneStart[face+1].
+        std::vector<std::size_t> faceBoneStart;
+        std::vector<std::size_t> faceBones;
+    };
+
+    CoreHardwareMesh::CoreHardwareMesh(CoreMeshPtrC coremesh, unsigned int bonesPerMesh, unsigned char bonesPerVertex, unsigned char verticesPerFace, PartitionMethod method)
         : m_weightsPerVertex(bonesPerVertex)
         , m_verticesPerFace(verticesPerFace)
+        , m_partitionMethod(method)
+        , m_duplicatedVertexCount(0)
+        , m_bonesPerMesh(bonesPerMesh)
+        , m_sourceHash(coremesh->contentHash())
     {
         // The hardware mesh needs all the vertices to have the same attributes,
         // and all the attributes to have the same amount of coordinates.
@@ -139,12 +212,9 @@ namespace bouge {
         // submesh. If some submesh has less attributes than another one, they
         // will be added to it.
         for(CoreMesh::const_iterator submesh = coremesh->begin() ; submesh != coremesh->end() ; ++submesh) {
-            if(submesh->vertexCount() > 0) {
-                Vertex vtx = submesh->vertex(0);
-
-                for(Vertex::iterator i = vtx.begin() ; i != vtx.end() ; ++i) {
-                    m_genericAttribCoordCount[i.name()] = i.value().size();
-                }
+            std::vector<std::string> names = submesh->attribNames();
+            for(std::vector<std::string>::const_iterator i = names.begin() ; i != names.end() ; ++i) {
+                m_genericAttribCoordCount[*i] = submesh->attribCoordCount(*i);
             }
         }
 
@@ -170,194 +240,653 @@ namespace bouge {
         // they are influenced by the exact same bones, just in different
         // hardware submeshes, that is with different IDs.
         //
+        // Which faces end up together in a hardware submesh is decided by the
+        // partition method, see CoreHardwareMesh::partition for the details.
+        //
         // And here a high-level python-style overview of the algorithm:
         //
         // currentVertexId = 0
         // bmap = map FROM bone name TO bone id in hw mesh
         // vmap = map FROM old vertex id in model TO new vertex id in buffer
         // for submesh in model:
-        //     hw = new hardware mesh
-        //
-        //     for face in submesh:
-        //         if can't add face to hw:
-        //             hw = new hardware mesh
-        //             clear bmap, vmap
+        //     for cluster in partition(submesh):
+        //         hw = new hardware mesh
+        //         clear bmap, vmap
         //
-        //         add face to hw # Also gives the bones used in face their "local" id
+        //         for face in cluster:
+        //             add face to hw # Also gives the bones used in face their "local" id
         //
-        //         for vtxid in face:
-        //             if vtxid not in vmap:    # vertex not in data, add!
-        //                 for influence in vertex(vtxid):
-        //                     boneid = get influence id in hw
-        //                     add boneid to data
-        //                 add vertex data
-        //                 add to vmap: vtxid -> currentVertexId
-        //                 currentVertexId += 1
+        //             for vtxid in face:
+        //                 if vtxid not in vmap:    # vertex not in data, add!
+        //                     for influence in vertex(vtxid):
+        //                         boneid = get influence id in hw
+        //                         add boneid to data
+        //                     add vertex data
+        //                     add to vmap: vtxid -> currentVertexId
+        //                     currentVertexId += 1
         //
-        //             vtxid = vmap[vtxid]      # vertex is in data, use!
+        //                 vtxid = vmap[vtxid]      # vertex is in data, use!
         //
         // Hmm I hope this is more or less understandeable. Or at least that I
         // will be able to understand that later on :)
         //
+        // In order to be fast enough for big meshes, all the work is done on
+        // the flattened submesh (see FlatSubMesh) and the "maps" are plain
+        // arrays indexed by the local bone/vertex ids. To "clear" them, we
+        // don't touch them but mark the valid entries with the number of the
+        // current cluster (a "stamp") instead.
+        //
         // The "test/splitting" model is a good test/example for this when setting
         // bones per mesh to two (2).
 
-        // The index at which the FACES of the submesh start.
-        std::size_t startIdx = 0;
-
         // We still take all the submeshes into the same buffers. It's just the
         // material and bone-palette that changes, that is shaders and uniforms.
         // All the vertex attributes are the same, so that's fine.
         for(CoreMesh::const_iterator iSubMesh = coremesh->begin() ; iSubMesh != coremesh->end() ; ++iSubMesh)  {
+            FlatSubMesh flat;
+            this->flatten(flat, *iSubMesh, coremesh->name(), bonesPerMesh, bonesPerVertex, verticesPerFace);
 
-            // Add face-by-face to a submesh. If the submesh can't take the
-            // next face (too many bones or different material), we create a new
-            // submesh and start from that one.
-            m_submeshes.push_back(CoreHardwareSubMesh(startIdx, iSubMesh->name()));
-
-            // Maps an "original" vertex ID to a "new" vertex ID.
-            std::map<Face::index_t, Face::index_t> vtxmap;
+            // Find out which faces go together into which hardware submesh.
+            FaceClusters clusters = this->partition(flat, bonesPerMesh, method);
+            this->emit(flat, iSubMesh->name(), clusters, std::vector<const CoreHardwareSubMesh*>());
+        }
+    }
 
-            for(std::size_t i = 0 ; i < iSubMesh->faceCount() ; ++i) {
-                Face f = iSubMesh->face(i);
+    CoreHardwareMesh::CoreHardwareMesh(CoreMeshPtrC lod, const CoreHardwareMesh& paletteSource)
+        : m_genericAttribCoordCount(paletteSource.m_genericAttribCoordCount)
+        , m_weightsPerVertex(paletteSource.m_weightsPerVertex)
+        , m_verticesPerFace(paletteSource.m_verticesPerFace)
+        , m_partitionMethod(paletteSource.m_partitionMethod)
+        , m_duplicatedVertexCount(0)
+        , m_bonesPerMesh(paletteSource.m_bonesPerMesh)
+        , m_sourceHash(lod->contentHash())
+    {
+        // This works just like the other constructor, except that we first
+        // try to put the faces into the hardware submeshes of paletteSource.
+        for(CoreMesh::const_iterator iSubMesh = lod->begin() ; iSubMesh != lod->end() ; ++iSubMesh)  {
+            FlatSubMesh flat;
+            this->flatten(flat, *iSubMesh, lod->name(), m_bonesPerMesh, m_weightsPerVertex, m_verticesPerFace);
+
+            std::vector<const CoreHardwareSubMesh*> palettes;
+            FaceClusters clusters = this->partitionLike(flat, iSubMesh->name(), paletteSource, palettes);
+            this->emit(flat, iSubMesh->name(), clusters, palettes);
+        }
+    }
 
-                // Skip all non-conforming faces.
-                if(f.idxs().size() != verticesPerFace)
-                    continue;
+    void CoreHardwareMesh::emit(const FlatSubMesh& flat, const Name& submeshName, const FaceClusters& clusters, const std::vector<const CoreHardwareSubMesh*>& palettes)
+    {
+        unsigned int bonesPerVertex = m_weightsPerVertex;
+        unsigned int verticesPerFace = m_verticesPerFace;
 
-                // Also faces that have more different bone influences than we
-                // can handle per hardware mesh are bad - they wouldn't fit into
-                // a hardware mesh! There's nothing we could do about that.
-                // (OK, we could split faces, but wtf...)
-                std::size_t bonesInFace = this->totalDifferentBoneCount(f, *iSubMesh);
-                if(bonesInFace > bonesPerMesh && bonesPerMesh > 0) {
-                    throw BadDataException("We got a face (#" + to_s(i) + ") in the hardware mesh of " + coremesh->name() + " that has more bone influences (" + to_s(bonesInFace) + ") than we can handle in a hardware mesh (" + to_s(bonesPerMesh) + "). Either crank up the bone per hw mesh count or split that face.", __FILE__, __LINE__);
-                }
+        // We'll write the attributes one after the other, always in the same order.
+        std::vector< std::vector<float>* > attribBuffers;
+        std::vector<std::size_t> attribSizes;
+        for(GenericAttribsCoords::iterator i = m_genericAttribCoordCount.begin() ; i != m_genericAttribCoordCount.end() ; ++i) {
+            attribBuffers.push_back(&m_genericAttribs[i->first]);
+            attribSizes.push_back(i->second);
+        }
 
-                // Check if it still fits in the current submesh or if we need a new one.
-                if(!m_submeshes.back().canAddFace(f, *iSubMesh, bonesPerMesh)) {
-                    m_submeshes.push_back(CoreHardwareSubMesh(startIdx, iSubMesh->name()));
+        // To seed a palette, we need to find the local ids of its bones.
+        std::map<Name, std::size_t> localBoneIds;
+        if(!palettes.empty()) {
+            for(std::size_t i = 0 ; i < flat.boneNames.size() ; ++i) {
+                localBoneIds[flat.boneNames[i]] = i;
+            }
+        }
 
-                    // When we start a new hardware submesh, we need not to have
-                    // references to vertices from other hardware submeshes. We
-                    // want them all new (even if copied).
-                    vtxmap.clear();
+        // Avoid the buffers growing over and over again.
+        std::size_t maxNewVerts = verticesPerFace*flat.validFaces.size();
+        m_verts.reserve(m_verts.size() + 3*maxNewVerts);
+        m_weights.reserve(m_weights.size() + bonesPerVertex*maxNewVerts);
+        m_boneIndices.reserve(m_boneIndices.size() + bonesPerVertex*maxNewVerts);
+        m_faceIndices.reserve(m_faceIndices.size() + maxNewVerts);
+
+        std::size_t nVerts = flat.vertexBoneStart.size() - 1;
+
+        // The "vmap": for each original vertex, its id in our buffers.
+        std::vector<std::size_t> vtxNewId(nVerts, 0);
+        std::vector<std::size_t> vtxStamps(nVerts, 0);
+
+        // The "bmap": for each local bone, its index in the bone palette.
+        std::vector<std::size_t> boneSlot(flat.boneNames.size(), 0);
+        std::vector<std::size_t> boneStamps(flat.boneNames.size(), 0);
+
+        // Remembers which original vertices are already in our buffers, so
+        // we can count how many of them we had to duplicate.
+        std::vector<bool> vtxUsed(nVerts, false);
+
+        std::size_t stamp = 0;
+        for(FaceClusters::const_iterator iCluster = clusters.begin() ; iCluster != clusters.end() ; ++iCluster) {
+            ++stamp;
+            m_submeshes.push_back(CoreHardwareSubMesh(m_faceIndices.size(), submeshName));
+            CoreHardwareSubMesh& hwSubMesh = m_submeshes.back();
+            hwSubMesh.m_baseVertex = this->vertexCount();
+
+            // If we got a palette to use, the cluster starts out with
+            // exactly its bones, in exactly its order.
+            std::size_t iClusterIdx = iCluster - clusters.begin();
+            const CoreHardwareSubMesh* pPalette = iClusterIdx < palettes.size() ? palettes[iClusterIdx] : 0;
+            for(std::size_t iSlot = 0 ; pPalette && iSlot < pPalette->boneCount() ; ++iSlot) {
+                std::map<Name, std::size_t>::const_iterator iLocal = localBoneIds.find(pPalette->m_boneIdInSubmeshToName[iSlot]);
+                if(iLocal != localBoneIds.end()) {
+                    boneStamps[iLocal->second] = stamp;
+                    boneSlot[iLocal->second] = iSlot;
                 }
+                hwSubMesh.addBone(pPalette->m_boneIdInSubmeshToName[iSlot]);
+            }
 
-                // Add it to the latest submesh
-                m_submeshes.back().addFace(f, *iSubMesh);
+            for(std::vector<std::size_t>::const_iterator iFace = iCluster->begin() ; iFace != iCluster->end() ; ++iFace) {
+                hwSubMesh.m_faceCount++;
 
-                // and then to our own data.
                 for(unsigned char i = 0 ; i < verticesPerFace ; ++i) {
-                    Face::index_t vtxId = f.idxs()[i];
-
-                    // If we already added this vertex, get its new id:
-                    if(vtxmap.find(vtxId) == vtxmap.end()) {
-                        // Determine the id the vertex will have when added to
-                        // our buffers:
-                        Face::index_t effectiveId = this->vertexCount();
-
-                        // Now, before we can add the vertex to our data, we
-                        // probably have to adjust its influences ids.
-                        // That is, we need to convert the bone Id from a name
-                        // (string) to an index in the hardware mesh's bone palette.
-                        Vertex vtx = iSubMesh->vertex(vtxId);
+                    Face::index_t vtxId = flat.faceVerts[*iFace*verticesPerFace + i];
+                    std::size_t firstBone = flat.vertexBoneStart[vtxId];
+                    std::size_t nBones = flat.vertexBoneStart[vtxId+1] - firstBone;
+
+                    // Give the bones used in the face their id in the palette.
+                    for(std::size_t iBone = firstBone ; iBone < firstBone + nBones ; ++iBone) {
+                        std::size_t localBone = flat.vertexBones[iBone];
+                        if(boneStamps[localBone] != stamp) {
+                            boneStamps[localBone] = stamp;
+                            boneSlot[localBone] = hwSubMesh.boneCount();
+                            hwSubMesh.addBone(flat.boneNames[localBone]);
+                        }
+                    }
+
+                    // If we already added this vertex, we know its new id.
+                    if(vtxStamps[vtxId] != stamp) {
+                        if(nBones == 0 && bonesPerVertex > 0) {
+                            // In this case, we'd need to add one influence to it.
+                            // We need to do that in order not to have all
+                            // weights be 0.0 and thus the vertex ending up
+                            // in the origin.
+                            // But we'd have to add that bone to the skeleton ...
+                            // How to solve this dilemma?
+                            throw BadDataException("We got a vertex (" + to_s(vtxId) + ") without any influences in submesh " + submeshName + ". This is bad, please fix it, for example by creating a 'root bone' which influences it, but doesn't move.", __FILE__, __LINE__);
+                        }
+
+                        // Convert the bone Ids from local ones to indices in
+                        // the hardware mesh's bone palette. In case the vertex
+                        // doesn't have that much bones, we just add '0'.
                         for(unsigned int iBone = 0 ; iBone < bonesPerVertex ; ++iBone) {
-                            if(iBone < vtx.influenceCount()) {
-                                // We can assume the submesh has that bone, as we
-                                // just added the face a few lines earlier.
-                                float boneId = (float)m_submeshes.back().boneId(vtx.influence(iBone).sBoneName);
-                                m_boneIndices.push_back(boneId);
-                            } else if(vtx.influenceCount() == 0) {
-                                // In this case, we add one influence to it.
-                                // We need to do that in order not to have all
-                                // weights be 0.0 and thus the vertex ending up
-                                // in the origin.
-                                // Hopefully, ... TODO
-                                throw BadDataException("We got a vertex (" + to_s(vtxId) + ") without any influences in submesh " + iSubMesh->name() + ". This is bad, please fix it, for example by creating a 'root bone' which influences it, but doesn't move.", __FILE__, __LINE__);
-                                // But we'd have to add that bone to the skeleton ...
-                                // How to solve this dilemma?
-//                                 vtx.addInfluence(Influence(1.0f, "__bicali__dummy__"));
-//                                 m_boneIndices.push_back(0.0f);
-                            } else {
-                                // In case the bone doesn't have that much bones,
-                                // we just add '0' to the indices.
+                            if(iBone < nBones)
+                                m_boneIndices.push_back((float)boneSlot[flat.vertexBones[firstBone + iBone]]);
+                            else
                                 m_boneIndices.push_back(0.0f);
-                            }
                         }
 
                         // Now add the vertex to our data:
-                        this->addVertex(vtx, bonesPerVertex, iSubMesh->name());
+                        vtxNewId[vtxId] = this->vertexCount();
+                        vtxStamps[vtxId] = stamp;
+
+                        m_verts.insert(m_verts.end(), flat.coords.begin() + 3*vtxId, flat.coords.begin() + 3*vtxId + 3);
+                        m_weights.insert(m_weights.end(), flat.weights.begin() + bonesPerVertex*vtxId, flat.weights.begin() + bonesPerVertex*(vtxId+1));
+                        for(std::size_t iAttrib = 0 ; iAttrib < attribBuffers.size() ; ++iAttrib) {
+                            std::vector<float>::const_iterator iFirst = flat.attribs[iAttrib].begin() + attribSizes[iAttrib]*vtxId;
+                            attribBuffers[iAttrib]->insert(attribBuffers[iAttrib]->end(), iFirst, iFirst + attribSizes[iAttrib]);
+                        }
 
-                        // Need to add it to the map, in case another face
-                        // references this vertex, so we don't add it twice.
-                        vtxmap[vtxId] = effectiveId;
+                        // Was it already added to another hardware submesh?
+                        if(vtxUsed[vtxId])
+                            m_duplicatedVertexCount++;
+                        vtxUsed[vtxId] = true;
                     }
 
                     // Now we got the "real", "new" id of this vertex. That is
                     // its effective id in our buffers. Add that to the faces info.
-                    m_faceIndices.push_back(vtxmap[vtxId]);
-                    startIdx++;
+                    m_faceIndices.push_back((Uint32)vtxNewId[vtxId]);
                 } // For all vertices of the face.
 
-            } // for all faces
+            } // for all faces of the cluster
+
+            hwSubMesh.m_vertexCount = this->vertexCount() - hwSubMesh.m_baseVertex;
 
-        } // for all submeshes
+        } // for all clusters
     }
 
-    std::size_t CoreHardwareMesh::totalDifferentBoneCount(const Face& f, CoreSubMeshPtrC submesh)
+    void CoreHardwareMesh::flatten(FlatSubMesh& flat, CoreSubMeshPtrC submesh, const std::string& meshName, unsigned int bonesPerMesh, unsigned char bonesPerVertex, unsigned char verticesPerFace) const
     {
-        std::set<std::string> influences;
-        for(std::vector<Face::index_t>::const_iterator iVertex =  f.idxs().begin() ; iVertex != f.idxs().end() ; ++iVertex) {
-            Vertex vtx = submesh->vertex(*iVertex);
+        std::size_t nVerts = submesh->vertexCount();
+        std::size_t nFaces = submesh->faceCount();
+
+        // The submesh already stores its vertices as arrays, with the bones
+        // numbered locally. We can take most of it as-is.
+        Span<float> positions = submesh->positions();
+        flat.coords.assign(positions.begin(), positions.end());
+
+        for(std::size_t iBone = 0 ; iBone < submesh->boneCount() ; ++iBone) {
+            flat.boneNames.push_back(submesh->boneName(iBone));
+        }
+
+        Span<Uint32> influenceStarts = submesh->influenceStarts();
+        Span<Uint32> influenceBones = submesh->influenceBones();
+        Span<float> influenceWeights = submesh->influenceWeights();
+        flat.vertexBoneStart.assign(influenceStarts.begin(), influenceStarts.end());
+        flat.vertexBones.assign(influenceBones.begin(), influenceBones.end());
+
+        // Copy the weights of the influences of each vertex.
+        // If the vertex has less influences than specified, we add more with weight 0.0.
+        // If it has more, we just ignore the redundant ones.
+        flat.weights.reserve(bonesPerVertex*nVerts);
+        for(std::size_t iVtx = 0 ; iVtx < nVerts ; ++iVtx) {
+            std::size_t nInfluences = influenceStarts[iVtx+1] - influenceStarts[iVtx];
+            for(unsigned int i = 0 ; i < bonesPerVertex ; ++i) {
+                if(i < nInfluences)
+                    flat.weights.push_back(influenceWeights[influenceStarts[iVtx] + i]);
+                else
+                    flat.weights.push_back(0.0f);
+            }
+        }
 
-            for(std::size_t iInfluence = 0 ; iInfluence < vtx.influenceCount() ; ++iInfluence) {
-                influences.insert(vtx.influence(iInfluence).sBoneName);
+        // Add all the generic attributes. All the vertices of a submesh have
+        // the same dimension for an attribute, but we still need to check
+        // that it is the same across the submeshes.
+        flat.attribs.resize(m_genericAttribCoordCount.size());
+        std::size_t iAttrib = 0;
+        for(GenericAttribsCoords::const_iterator attribCoordCount = m_genericAttribCoordCount.begin() ; attribCoordCount != m_genericAttribCoordCount.end() ; ++attribCoordCount, ++iAttrib) {
+            if(submesh->hasAttrib(attribCoordCount->first)) {
+                // This means the vertices' attribute has the wrong dimension! STOP HERE!
+                std::size_t coordCount = submesh->attribCoordCount(attribCoordCount->first);
+                if(coordCount != attribCoordCount->second)
+                    throw BadDataException("Vertex with wrong-sized attribute '" + attribCoordCount->first + "' in submesh '" + submesh->name() + "' (dimension is " + to_s(coordCount) + " but should be " + to_s(attribCoordCount->second) +")", __FILE__, __LINE__);
+
+                // Vertices not having it are already zero in there.
+                Span<float> attrib = submesh->attribs(attribCoordCount->first);
+                flat.attribs[iAttrib].assign(attrib.begin(), attrib.end());
+            } else {
+                // If the vertices don't have the attribute, we just throw dummys in.
+                flat.attribs[iAttrib].assign(attribCoordCount->second*nVerts, 0.0f);
             }
         }
 
-        return influences.size();
+        // Then, collect the vertices and the set of bones of every face.
+        flat.faceVerts.resize(verticesPerFace*nFaces, 0);
+        flat.faceBoneStart.reserve(nFaces + 1);
+        for(std::size_t iFace = 0 ; iFace < nFaces ; ++iFace) {
+            flat.faceBoneStart.push_back(flat.faceBones.size());
+
+            Span<Uint32> f = submesh->faceIndices(iFace);
+
+            // Skip all non-conforming faces.
+            if(f.size() != verticesPerFace)
+                continue;
+
+            std::size_t firstBone = flat.faceBones.size();
+            for(unsigned char i = 0 ; i < verticesPerFace ; ++i) {
+                Uint32 vtxId = f[i];
+                if(vtxId >= nVerts)
+                    throw std::out_of_range("Face " + to_s(iFace) + " of submesh " + submesh->name() + " uses vertex " + to_s(vtxId) + " but there are only " + to_s(nVerts));
+
+                flat.faceVerts[iFace*verticesPerFace + i] = vtxId;
+                flat.faceBones.insert(flat.faceBones.end(), flat.vertexBones.begin() + flat.vertexBoneStart[vtxId], flat.vertexBones.begin() + flat.vertexBoneStart[vtxId+1]);
+            }
+
+            std::sort(flat.faceBones.begin() + firstBone, flat.faceBones.end());
+            flat.faceBones.erase(std::unique(flat.faceBones.begin() + firstBone, flat.faceBones.end()), flat.faceBones.end());
+
+            // Also faces that have more different bone influences than we
+            // can handle per hardware mesh are bad - they wouldn't fit into
+            // a hardware mesh! There's nothing we could do about that.
+            // (OK, we could split faces, but wtf...)
+            std::size_t bonesInFace = flat.faceBones.size() - firstBone;
+            if(bonesInFace > bonesPerMesh && bonesPerMesh > 0) {
+                throw BadDataException("We got a face (#" + to_s(iFace) + ") in the hardware mesh of " + meshName + " that has more bone influences (" + to_s(bonesInFace) + ") than we can handle in a hardware mesh (" + to_s(bonesPerMesh) + "). Either crank up the bone per hw mesh count or split that face.", __FILE__, __LINE__);
+            }
+
+            flat.validFaces.push_back(iFace);
+        }
+        flat.faceBoneStart.push_back(flat.faceBones.size());
     }
 
-    void CoreHardwareMesh::addVertex(Vertex vtx, unsigned char bonesPerVertex, const std::string& submeshDiagnosticName)
+    /// \internal
+    /// \return How many of the (local) bones of face \a iFace are not yet marked with \a stamp.
+    static std::size_t newBoneCount(const std::vector<std::size_t>& faceBoneStart, const std::vector<std::size_t>& faceBones, std::size_t iFace, const std::vector<std::size_t>& boneStamps, std::size_t stamp)
     {
-        m_verts.push_back(vtx.pos().x());
-        m_verts.push_back(vtx.pos().y());
-        m_verts.push_back(vtx.pos().z());
+        std::size_t count = 0;
+        for(std::size_t i = faceBoneStart[iFace] ; i < faceBoneStart[iFace+1] ; ++i) {
+            if(boneStamps[faceBones[i]] != stamp)
+                count++;
+        }
+        return count;
+    }
 
-        // Copy the weights of the influences of each vertex.
-        // If the vertex has less influences than specified, we add more with weight 0.0.
-        // If it has more, we just ignore the redundant ones.
-        for(unsigned int i = 0 ; i < bonesPerVertex ; ++i) {
-            if(i < vtx.influenceCount())
-                m_weights.push_back(vtx.influence(i).w);
-            else
-                m_weights.push_back(0.0f);
+    /// \internal
+    /// Marks all the (local) bones of face \a iFace with \a stamp.
+    /// \return How many of them were not marked yet.
+    static std::size_t markBones(const std::vector<std::size_t>& faceBoneStart, const std::vector<std::size_t>& faceBones, std::size_t iFace, std::vector<std::size_t>& boneStamps, std::size_t stamp)
+    {
+        std::size_t count = 0;
+        for(std::size_t i = faceBoneStart[iFace] ; i < faceBoneStart[iFace+1] ; ++i) {
+            if(boneStamps[faceBones[i]] != stamp) {
+                boneStamps[faceBones[i]] = stamp;
+                count++;
+            }
         }
+        return count;
+    }
 
-        // Add all the generic attributes. We do several checks to ensure
-        // we have the same amount of attributes in each vertex and they
-        // have the same dimension across vertices.
-        for(GenericAttribsCoords::iterator attribCoordCount = m_genericAttribCoordCount.begin() ; attribCoordCount != m_genericAttribCoordCount.end() ; ++attribCoordCount) {
-            if(vtx.hasAttrib(attribCoordCount->first)) {
-                std::vector<float> attrib = vtx.attrib(attribCoordCount->first);
+    CoreHardwareMesh::FaceClusters CoreHardwareMesh::partition(const FlatSubMesh& flat, unsigned int bonesPerMesh, PartitionMethod method) const
+    {
+        FaceClusters clusters;
 
-                // This means the vertex's attribute has the wrong dimension! STOP HERE!
-                if(attrib.size() != attribCoordCount->second)
-                    throw BadDataException("Vertex with wrong-sized attribute '" + attribCoordCount->first + "' in submesh '" + submeshDiagnosticName + "' (dimension is " + to_s(attrib.size()) + " but should be " + to_s(attribCoordCount->second) +")", __FILE__, __LINE__);
+        const std::vector<std::size_t>& validFaces = flat.validFaces;
+        const std::vector<std::size_t>& faceBoneStart = flat.faceBoneStart;
+        const std::vector<std::size_t>& faceBones = flat.faceBones;
+        std::size_t verticesPerFace = m_verticesPerFace;
+        std::size_t nVerts = flat.vertexBoneStart.size() - 1;
+        std::size_t nFaces = faceBoneStart.size() - 1;
 
-                // If it got the correct size, copy over all the values.
-                for(std::vector<float>::iterator i = attrib.begin() ; i != attrib.end() ; ++i) {
-                    m_genericAttribs[attribCoordCount->first].push_back(*i);
+        // No need to split anything if it all fits. Note that we always create
+        // at least one (maybe empty) hardware submesh per submesh.
+        if(bonesPerMesh == 0 || flat.boneNames.size() <= bonesPerMesh || validFaces.empty()) {
+            clusters.push_back(validFaces);
+            return clusters;
+        }
+
+        // The bones of the cluster being built are the ones marked with its
+        // stamp. This way, we never need to clear that list.
+        std::vector<std::size_t> boneStamps(flat.boneNames.size(), 0);
+        std::size_t stamp = 1;
+        std::size_t boneCount = 0;
+
+        if(method == PartitionGreedy) {
+            // Add face-by-face to a cluster. If the cluster can't take the next
+            // face (too many bones), we create a new cluster and go on with it.
+            clusters.push_back(std::vector<std::size_t>());
+            for(std::vector<std::size_t>::const_iterator iFace = validFaces.begin() ; iFace != validFaces.end() ; ++iFace) {
+                if(boneCount + newBoneCount(faceBoneStart, faceBones, *iFace, boneStamps, stamp) > bonesPerMesh) {
+                    clusters.push_back(std::vector<std::size_t>());
+                    stamp++;
+                    boneCount = 0;
                 }
 
-            } else {
-                // If the vertex doesn't have the attribute, we just throw dummys in.
-                for(std::size_t i = 0 ; i < attribCoordCount->second ; ++i) {
-                    m_genericAttribs[attribCoordCount->first].push_back(0.0f);
+                boneCount += markBones(faceBoneStart, faceBones, *iFace, boneStamps, stamp);
+                clusters.back().push_back(*iFace);
+            }
+
+            return clusters;
+        }
+
+        // Bone affinity: we grow the clusters over the surface of the mesh,
+        // as neighbouring faces tend to be influenced by the same bones. The
+        // face we take next is always the one of the neighbours (the "frontier")
+        // which adds the least new bones to the palette. Amongst those, we take
+        // the one that shares most vertices with the cluster, as every vertex
+        // shared with another cluster needs to be duplicated.
+        //
+        // When no neighbour fits anymore, we look through the whole submesh:
+        // all faces whose bones are already in the palette are taken for free,
+        // else we take the one adding the least new bones and go on growing from
+        // there. Once nothing fits anymore, the cluster is done.
+        //
+        // As the palette of a cluster only ever grows, a face that doesn't fit
+        // anymore won't fit again before the next cluster. So that search only
+        // goes through the faces which are still free and may still fit, the
+        // others are put aside until the next cluster starts.
+
+        // Which faces use a vertex, in order to find the neighbours of a face.
+        // Again, the faces of vertex v are from vertexFaceStart[v] to vertexFaceStart[v+1].
+        std::vector<std::size_t> vertexFaceStart(nVerts + 1, 0);
+        for(std::vector<std::size_t>::const_iterator iFace = validFaces.begin() ; iFace != validFaces.end() ; ++iFace) {
+            for(std::size_t i = 0 ; i < verticesPerFace ; ++i) {
+                vertexFaceStart[flat.faceVerts[*iFace*verticesPerFace + i] + 1]++;
+            }
+        }
+        for(std::size_t iVtx = 0 ; iVtx < nVerts ; ++iVtx) {
+            vertexFaceStart[iVtx+1] += vertexFaceStart[iVtx];
+        }
+        std::vector<std::size_t> vertexFaces(vertexFaceStart.back());
+        std::vector<std::size_t> fill(vertexFaceStart.begin(), vertexFaceStart.end() - 1);
+        for(std::vector<std::size_t>::const_iterator iFace = validFaces.begin() ; iFace != validFaces.end() ; ++iFace) {
+            for(std::size_t i = 0 ; i < verticesPerFace ; ++i) {
+                vertexFaces[fill[flat.faceVerts[*iFace*verticesPerFace + i]]++] = *iFace;
+            }
+        }
+
+        // The vertices of the current cluster are marked with its stamp too.
+        std::vector<std::size_t> vertexStamps(nVerts, 0);
+        std::vector<bool> assigned(nFaces, false);
+        std::size_t remaining = validFaces.size();
+        std::vector<std::size_t>::const_iterator iSeed = validFaces.begin();
+
+        // Both are kept sorted by face index, so that ties are broken the same
+        // way no matter how often the faces have been put aside.
+        std::vector<std::size_t> candidates(validFaces.begin(), validFaces.end());
+        std::vector<std::size_t> putAside;
+
+        for(stamp = 1 ; remaining > 0 ; ++stamp) {
+            clusters.push_back(std::vector<std::size_t>());
+            boneCount = 0;
+            std::set<std::size_t> frontier;
+
+            if(!putAside.empty()) {
+                std::sort(putAside.begin(), putAside.end());
+                std::size_t nCandidates = candidates.size();
+                candidates.insert(candidates.end(), putAside.begin(), putAside.end());
+                std::inplace_merge(candidates.begin(), candidates.begin() + nCandidates, candidates.end());
+                putAside.clear();
+            }
+
+            // Seed the cluster with the first face that's still free.
+            while(assigned[*iSeed])
+                ++iSeed;
+            std::vector<std::size_t> toTake(1, *iSeed);
+
+            while(!toTake.empty()) {
+                for(std::vector<std::size_t>::const_iterator iFace = toTake.begin() ; iFace != toTake.end() ; ++iFace) {
+                    assigned[*iFace] = true;
+                    remaining--;
+                    clusters.back().push_back(*iFace);
+                    boneCount += markBones(faceBoneStart, faceBones, *iFace, boneStamps, stamp);
+                    frontier.erase(*iFace);
+
+                    for(std::size_t i = 0 ; i < verticesPerFace ; ++i) {
+                        Face::index_t vtxId = flat.faceVerts[*iFace*verticesPerFace + i];
+                        vertexStamps[vtxId] = stamp;
+                        for(std::size_t iNeighbour = vertexFaceStart[vtxId] ; iNeighbour < vertexFaceStart[vtxId+1] ; ++iNeighbour) {
+                            if(!assigned[vertexFaces[iNeighbour]])
+                                frontier.insert(vertexFaces[iNeighbour]);
+                        }
+                    }
+                }
+                toTake.clear();
+
+                if(remaining == 0)
+                    break;
+
+                // Find the best fitting neighbour.
+                bool bFound = false;
+                std::size_t best = 0, bestNew = 0, bestShared = 0;
+                for(std::set<std::size_t>::const_iterator iFace = frontier.begin() ; iFace != frontier.end() ; ++iFace) {
+                    std::size_t nNew = newBoneCount(faceBoneStart, faceBones, *iFace, boneStamps, stamp);
+                    if(boneCount + nNew > bonesPerMesh)
+                        continue;
+
+                    std::size_t nShared = 0;
+                    for(std::size_t i = 0 ; i < verticesPerFace ; ++i) {
+                        if(vertexStamps[flat.faceVerts[*iFace*verticesPerFace + i]] == stamp)
+                            nShared++;
+                    }
+
+                    if(!bFound || nNew < bestNew || (nNew == bestNew && nShared > bestShared)) {
+                        bFound = true;
+                        best = *iFace;
+                        bestNew = nNew;
+                        bestShared = nShared;
+                    }
+                }
+
+                if(bFound) {
+                    toTake.push_back(best);
+                    continue;
                 }
+
+                // None of the neighbours fits, look at all the rest. The faces
+                // taken or not fitting anymore are dropped from the candidates
+                // on the way.
+                std::size_t nKept = 0;
+                for(std::size_t i = 0 ; i < candidates.size() ; ++i) {
+                    std::size_t iFace = candidates[i];
+                    if(assigned[iFace])
+                        continue;
+
+                    std::size_t nNew = newBoneCount(faceBoneStart, faceBones, iFace, boneStamps, stamp);
+                    if(boneCount + nNew > bonesPerMesh) {
+                        putAside.push_back(iFace);
+                        continue;
+                    }
+
+                    candidates[nKept++] = iFace;
+                    if(nNew == 0) {
+                        toTake.push_back(iFace);
+                    } else if(!bFound || nNew < bestNew) {
+                        bFound = true;
+                        best = iFace;
+                        bestNew = nNew;
+                    }
+                }
+                candidates.resize(nKept);
+
+                if(toTake.empty() && bFound)
+                    toTake.push_back(best);
             }
         }
+
+        return clusters;
+    }
+
+    CoreHardwareMesh::FaceClusters CoreHardwareMesh::partitionLike(FlatSubMesh& flat, const Name& submeshName, const CoreHardwareMesh& reference, std::vector<const CoreHardwareSubMesh*>& palettes) const
+    {
+        FaceClusters clusters;
+
+        // The hardware submeshes of the reference that come from the same
+        // submesh, and which of our local bones are in their palette.
+        std::vector<const CoreHardwareSubMesh*> candidates;
+        std::vector< std::vector<bool> > candidateHasBone;
+        for(SubMeshContainer::const_iterator i = reference.m_submeshes.begin() ; i != reference.m_submeshes.end() ; ++i) {
+            if(i->submeshName() != submeshName)
+                continue;
+
+            candidates.push_back(&*i);
+            candidateHasBone.push_back(std::vector<bool>(flat.boneNames.size(), false));
+            for(std::size_t iBone = 0 ; iBone < flat.boneNames.size() ; ++iBone) {
+                candidateHasBone.back()[iBone] = i->hasBone(flat.boneNames[iBone]);
+            }
+        }
+
+        // Every face goes into the first of those whose palette has all its bones.
+        FaceClusters byCandidate(candidates.size());
+        std::vector<std::size_t> leftovers;
+        for(std::vector<std::size_t>::const_iterator iFace = flat.validFaces.begin() ; iFace != flat.validFaces.end() ; ++iFace) {
+            std::size_t iCandidate = 0;
+            for( ; iCandidate < candidates.size() ; ++iCandidate) {
+                std::size_t i = flat.faceBoneStart[*iFace];
+                while(i < flat.faceBoneStart[*iFace+1] && candidateHasBone[iCandidate][flat.faceBones[i]])
+                    ++i;
+
+                if(i == flat.faceBoneStart[*iFace+1])
+                    break;
+            }
+
+            if(iCandidate < candidates.size())
+                byCandidate[iCandidate].push_back(*iFace);
+            else
+                leftovers.push_back(*iFace);
+        }
+
+        for(std::size_t iCandidate = 0 ; iCandidate < candidates.size() ; ++iCandidate) {
+            if(byCandidate[iCandidate].empty())
+                continue;
+
+            clusters.push_back(std::vector<std::size_t>());
+            clusters.back().swap(byCandidate[iCandidate]);
+            palettes.push_back(candidates[iCandidate]);
+        }
+
+        // The faces that fit nowhere get new hardware submeshes, split the
+        // usual way. For that, we make them be the only valid faces for a moment.
+        if(!leftovers.empty() || clusters.empty()) {
+            flat.validFaces.swap(leftovers);
+            FaceClusters rest = this->partition(flat, m_bonesPerMesh, m_partitionMethod);
+            flat.validFaces.swap(leftovers);
+            clusters.insert(clusters.end(), rest.begin(), rest.end());
+        }
+
+        return clusters;
+    }
+
+    /// \internal
+    /// Checks that the stream \a idx of \a prebuilt is the one we expect there.
+    /// \exception BadDataException if it isn't.
+    static void checkPrebuiltStream(const CoreHardwareMeshBinary& prebuilt, std::size_t idx, const std::string& name, std::size_t coordCount)
+    {
+        if(prebuilt.streamCount() <= idx)
+            throw BadDataException("The prebuilt hardware mesh has only " + to_s(prebuilt.streamCount()) + " streams, but the stream '" + name + "' should be at index " + to_s(idx), __FILE__, __LINE__);
+
+        if(prebuilt.streamName(idx) != name)
+            throw BadDataException("The stream " + to_s(idx) + " of the prebuilt hardware mesh is '" + prebuilt.streamName(idx) + "' but should be '" + name + "'", __FILE__, __LINE__);
+
+        if(prebuilt.stream(idx).coordCount != coordCount)
+            throw BadDataException("The stream '" + name + "' of the prebuilt hardware mesh has " + to_s(prebuilt.stream(idx).coordCount) + " coordinates per vertex but should have " + to_s(coordCount), __FILE__, __LINE__);
+    }
+
+    CoreHardwareMesh::CoreHardwareMesh(const CoreHardwareMeshBinary& prebuilt)
+        : m_weightsPerVertex(prebuilt.header().bonesPerVertex)
+        , m_verticesPerFace(prebuilt.header().verticesPerFace)
+        , m_partitionMethod((PartitionMethod)prebuilt.header().partitionMethod)
+        , m_duplicatedVertexCount(prebuilt.header().duplicatedVertexCount)
+        , m_bonesPerMesh(prebuilt.header().bonesPerMesh)
+        , m_sourceHash(prebuilt.header().sourceHash)
+    {
+        for(std::size_t i = 0 ; i < prebuilt.submeshCount() ; ++i) {
+            m_submeshes.push_back(CoreHardwareSubMesh(prebuilt.submesh(i).startIndex, prebuilt.submeshName(i)));
+            m_submeshes.back().m_faceCount = prebuilt.submesh(i).faceCount;
+            m_submeshes.back().m_baseVertex = prebuilt.submesh(i).baseVertex;
+            m_submeshes.back().m_vertexCount = prebuilt.submesh(i).vertexCount;
+
+            for(std::size_t iBone = 0 ; iBone < prebuilt.submesh(i).boneCount ; ++iBone) {
+                m_submeshes.back().addBone(prebuilt.boneName(i, iBone));
+            }
+        }
+
+        // De-interleave all the streams into our buffers. The first three are
+        // always the coordinates, weights and bone indices.
+        checkPrebuiltStream(prebuilt, 0, "pos", this->coordsPerVertex());
+        checkPrebuiltStream(prebuilt, 1, "weights", this->weightsPerVertex());
+        checkPrebuiltStream(prebuilt, 2, "bones", this->boneIndicesPerVertex());
+
+        std::size_t nVerts = prebuilt.vertexCount();
+        const char* pVerts = reinterpret_cast<const char*>(prebuilt.vertices());
+        for(std::size_t iStream = 0 ; iStream < prebuilt.streamCount() ; ++iStream) {
+            const CoreHardwareMeshBinaryStream& stream = prebuilt.stream(iStream);
+
+            std::vector<float>* pDest = 0;
+            if(iStream == 0) {
+                pDest = &m_verts;
+            } else if(iStream == 1) {
+                pDest = &m_weights;
+            } else if(iStream == 2) {
+                pDest = &m_boneIndices;
+            } else {
+                std::string sName = prebuilt.streamName(iStream);
+                m_genericAttribCoordCount[sName] = stream.coordCount;
+                pDest = &m_genericAttribs[sName];
+            }
+
+            pDest->resize(nVerts*stream.coordCount);
+            for(std::size_t iVtx = 0 ; iVtx < nVerts ; ++iVtx) {
+                std::memcpy(&(*pDest)[iVtx*stream.coordCount], pVerts + iVtx*prebuilt.vertexStride() + stream.offsetInVertex, stream.coordCount*sizeof(float));
+            }
+        }
+
+        m_faceIndices.resize(prebuilt.indexCount());
+        if(prebuilt.indexSize() == sizeof(Uint16)) {
+            const Uint16* pIndices = reinterpret_cast<const Uint16*>(prebuilt.indices());
+            std::copy(pIndices, pIndices + prebuilt.indexCount(), m_faceIndices.begin());
+        } else {
+            const Uint32* pIndices = reinterpret_cast<const Uint32*>(prebuilt.indices());
+            std::copy(pIndices, pIndices + prebuilt.indexCount(), m_faceIndices.begin());
+        }
     }
 
     CoreHardwareMesh::~CoreHardwareMesh()
@@ -368,6 +897,175 @@ namespace bouge {
         return m_submeshes.size();
     }
 
+    CoreHardwareMesh::PartitionMethod CoreHardwareMesh::partitionMethod() const
+    {
+        return m_partitionMethod;
+    }
+
+    std::size_t CoreHardwareMesh::duplicatedVertexCount() const
+    {
+        return m_duplicatedVertexCount;
+    }
+
+    unsigned int CoreHardwareMesh::bonesPerMesh() const
+    {
+        return m_bonesPerMesh;
+    }
+
+    Uint32 CoreHardwareMesh::sourceHash() const
+    {
+        return m_sourceHash;
+    }
+
+    /// \internal
+    /// \return \a offset rounded up to the next multiple of 16.
+    static Uint32 align16(std::size_t offset)
+    {
+        return (Uint32)((offset + 15) & ~(std::size_t)15);
+    }
+
+    /// \internal
+    /// Adds \a s to the \a strings section in case it's not in yet.
+    /// \return The offset of \a s in the \a strings section.
+    static Uint32 addString(std::vector<char>& strings, std::map<std::string, Uint32>& known, const std::string& s)
+    {
+        std::map<std::string, Uint32>::iterator i = known.find(s);
+        if(i != known.end())
+            return i->second;
+
+        Uint32 offset = strings.size();
+        strings.insert(strings.end(), s.begin(), s.end());
+        strings.push_back('\0');
+        known[s] = offset;
+        return offset;
+    }
+
+    std::vector<char> CoreHardwareMesh::saveBinary() const
+    {
+        std::vector<char> strings;
+        std::map<std::string, Uint32> knownStrings;
+
+        // First, describe all the streams interleaved into one vertex.
+        std::vector<CoreHardwareMeshBinaryStream> streams;
+        std::vector<const std::vector<float>*> streamData;
+
+        CoreHardwareMeshBinaryStream stream;
+        stream.offsetInVertex = 0;
+
+        stream.name = addString(strings, knownStrings, "pos");
+        stream.coordCount = this->coordsPerVertex();
+        streams.push_back(stream);
+        streamData.push_back(&m_verts);
+        stream.offsetInVertex += stream.coordCount*sizeof(float);
+
+        stream.name = addString(strings, knownStrings, "weights");
+        stream.coordCount = this->weightsPerVertex();
+        streams.push_back(stream);
+        streamData.push_back(&m_weights);
+        stream.offsetInVertex += stream.coordCount*sizeof(float);
+
+        stream.name = addString(strings, knownStrings, "bones");
+        stream.coordCount = this->boneIndicesPerVertex();
+        streams.push_back(stream);
+        streamData.push_back(&m_boneIndices);
+        stream.offsetInVertex += stream.coordCount*sizeof(float);
+
+        for(GenericAttribsCoords::const_iterator i = m_genericAttribCoordCount.begin() ; i != m_genericAttribCoordCount.end() ; ++i) {
+            stream.name = addString(strings, knownStrings, i->first);
+            stream.coordCount = i->second;
+            streams.push_back(stream);
+            streamData.push_back(&this->attrib(i->first));
+            stream.offsetInVertex += stream.coordCount*sizeof(float);
+        }
+
+        // Then, the submeshes and their bone palettes.
+        std::vector<CoreHardwareMeshBinarySubMesh> submeshes;
+        std::vector<Uint32> palette;
+        for(SubMeshContainer::const_iterator i = m_submeshes.begin() ; i != m_submeshes.end() ; ++i) {
+            CoreHardwareMeshBinarySubMesh submesh;
+            submesh.name = addString(strings, knownStrings, i->submeshName());
+            submesh.startIndex = i->startIndex();
+            submesh.faceCount = i->faceCount();
+            submesh.baseVertex = i->baseVertex();
+            submesh.vertexCount = i->vertexCount();
+            submesh.firstBone = palette.size();
+            submesh.boneCount = i->boneCount();
+            submeshes.push_back(submesh);
+
+            for(std::size_t iBone = 0 ; iBone < i->boneCount() ; ++iBone) {
+                palette.push_back(addString(strings, knownStrings, i->boneName(iBone)));
+            }
+        }
+
+        // Now that we know all the sizes, we can lay the sections out.
+        CoreHardwareMeshBinaryHeader h;
+        std::memset(&h, 0, sizeof(h));
+        std::memcpy(h.magic, "BOUGEHWM", sizeof(h.magic));
+        h.version = CoreHardwareMeshBinary::version;
+        h.byteOrderMark = 0x01020304;
+        h.sourceHash = m_sourceHash;
+        h.bonesPerMesh = m_bonesPerMesh;
+        h.bonesPerVertex = m_weightsPerVertex;
+        h.verticesPerFace = m_verticesPerFace;
+        h.partitionMethod = m_partitionMethod;
+        h.vertexCount = this->vertexCount();
+        h.vertexStride = stream.offsetInVertex;
+        h.indexCount = m_faceIndices.size();
+        h.indexSize = this->indexSize();
+        h.duplicatedVertexCount = m_duplicatedVertexCount;
+        h.streamCount = streams.size();
+        h.streamsOffset = align16(sizeof(h));
+        h.submeshCount = submeshes.size();
+        h.submeshesOffset = align16(h.streamsOffset + streams.size()*sizeof(CoreHardwareMeshBinaryStream));
+        h.paletteSize = palette.size();
+        h.paletteOffset = align16(h.submeshesOffset + submeshes.size()*sizeof(CoreHardwareMeshBinarySubMesh));
+        h.stringsSize = strings.size();
+        h.stringsOffset = align16(h.paletteOffset + palette.size()*sizeof(Uint32));
+        h.verticesOffset = align16(h.stringsOffset + strings.size());
+        h.indicesOffset = align16(h.verticesOffset + (std::size_t)h.vertexCount*h.vertexStride);
+        h.totalSize = align16(h.indicesOffset + (std::size_t)h.indexCount*h.indexSize);
+
+        std::vector<char> ret(h.totalSize, 0);
+        std::memcpy(&ret[0], &h, sizeof(h));
+        if(!streams.empty())
+            std::memcpy(&ret[h.streamsOffset], &streams[0], streams.size()*sizeof(CoreHardwareMeshBinaryStream));
+        if(!submeshes.empty())
+            std::memcpy(&ret[h.submeshesOffset], &submeshes[0], submeshes.size()*sizeof(CoreHardwareMeshBinarySubMesh));
+        if(!palette.empty())
+            std::memcpy(&ret[h.paletteOffset], &palette[0], palette.size()*sizeof(Uint32));
+        if(!strings.empty())
+            std::memcpy(&ret[h.stringsOffset], &strings[0], strings.size());
+
+        // Interleave all the streams.
+        for(std::size_t iStream = 0 ; iStream < streams.size() ; ++iStream) {
+            std::size_t nCoords = streams[iStream].coordCount;
+            for(std::size_t iVtx = 0 ; iVtx < h.vertexCount && nCoords > 0 ; ++iVtx) {
+                std::memcpy(&ret[h.verticesOffset + iVtx*h.vertexStride + streams[iStream].offsetInVertex], &(*streamData[iStream])[iVtx*nCoords], nCoords*sizeof(float));
+            }
+        }
+
+        // The indices are stored in the narrowest possible type.
+        if(!m_faceIndices.empty())
+            this->writeIndices(&ret[h.indicesOffset], h.indexSize);
+
+        return ret;
+    }
+
+    const CoreHardwareMesh& CoreHardwareMesh::saveBinary(const std::string& sFileName) const
+    {
+        std::vector<char> data = this->saveBinary();
+        std::ofstream out(sFileName.c_str(), std::ios::binary);
+        if(!out)
+            throw std::runtime_error("Couldn't open '" + sFileName + "' to save the hardware mesh in");
+
+        out.write(&data[0], data.size());
+        out.close();
+        if(out.fail())
+            throw std::runtime_error("Couldn't write the hardware mesh to '" + sFileName + "'");
+
+        return *this;
+    }
+
     CoreHardwareMesh::iterator::iterator(SubMeshContainer::iterator me)
         : myIter(me)
     { }
@@ -513,7 +1211,7 @@ namespace bouge {
     {
         std::size_t iFirstIdx = 3*idx;
 
-        if(iFirstIdx + 3 >= m_verts.size())
+        if(iFirstIdx + 3 > m_verts.size())
             throw std::out_of_range("Vertex " + to_s(idx) + " doesn't exist, there are only " + to_s(this->vertexCount()));
 
         return Vector(&m_verts[iFirstIdx], &m_verts[iFirstIdx+3]);
@@ -523,7 +1221,7 @@ namespace bouge {
     {
         std::size_t iFirstIdx = 3*idx;
 
-        if(iFirstIdx + 3 >= m_verts.size())
+        if(iFirstIdx + 3 > m_verts.size())
             throw std::out_of_range("Vertex " + to_s(idx) + " doesn't exist, there are only " + to_s(this->vertexCount()));
 
         m_verts[iFirstIdx+0] = vtx.x();
@@ -589,7 +1287,7 @@ namespace bouge {
         std::size_t iAttribSize = iAttribCoordCount->second;
         std::size_t iFirstIdx = iAttribSize*idx;
 
-        if(iFirstIdx + iAttribSize >= iAttrib->second.size())
+        if(iFirstIdx + iAttribSize > iAttrib->second.size())
             throw std::out_of_range("Vertex " + to_s(idx) + " doesn't exist, there are only " + to_s(this->vertexCount()));
 
         std::vector<float> ret;
@@ -609,7 +1307,7 @@ namespace bouge {
         std::size_t iAttribSize = this->attribCoordsPerVertex(name);
         std::size_t iFirstIdx = iAttribSize*idx;
 
-        if(iFirstIdx + iAttribSize >= iAttrib->second.size())
+        if(iFirstIdx + iAttribSize > iAttrib->second.size())
             throw std::out_of_range("Vertex " + to_s(idx) + " doesn't exist, there are only " + to_s(this->vertexCount()));
 
         for(std::size_t i = 0 ; i < iAttribSize ; ++i) {
@@ -674,7 +1372,7 @@ namespace bouge {
         }
 
         std::vector<float> ret(this->weightsPerVertex());
-        std::copy(&m_weights[startIdx], &m_weights[endIdx], ret.begin());
+        std::copy(m_weights.begin() + startIdx, m_weights.begin() + endIdx + 1, ret.begin());
         return ret;
     }
 
@@ -682,7 +1380,7 @@ namespace bouge {
     {
         std::size_t iFirstIdx = this->weightsPerVertex()*idx;
 
-        if(iFirstIdx + this->weightsPerVertex() >= m_weights.size())
+        if(iFirstIdx + this->weightsPerVertex() > m_weights.size())
             throw std::out_of_range("Vertex " + to_s(idx) + " doesn't exist, there are only " + to_s(this->vertexCount()));
 
         for(std::size_t i = 0 ; i < this->weightsPerVertex() && i < weights.size() ; ++i) {
@@ -734,7 +1432,7 @@ namespace bouge {
         }
 
         std::vector<float> ret(this->boneIndicesPerVertex());
-        std::copy(&m_boneIndices[startIdx], &m_boneIndices[endIdx], ret.begin());
+        std::copy(m_boneIndices.begin() + startIdx, m_boneIndices.begin() + endIdx + 1, ret.begin());
         return ret;
     }
 
@@ -742,7 +1440,7 @@ namespace bouge {
     {
         std::size_t iFirstIdx = this->boneIndicesPerVertex()*idx;
 
-        if(iFirstIdx + this->boneIndicesPerVertex() >= m_boneIndices.size())
+        if(iFirstIdx + this->boneIndicesPerVertex() > m_boneIndices.size())
             throw std::out_of_range("Vertex " + to_s(idx) + " doesn't exist, there are only " + to_s(this->vertexCount()));
 
         for(std::size_t i = 0 ; i < this->boneIndicesPerVertex() && i < indices.size() ; ++i) {
@@ -784,25 +1482,36 @@ namespace bouge {
         return m_verticesPerFace;
     }
 
-    std::vector<BOUGE_FACE_INDEX_TYPE> CoreHardwareMesh::faceIndices(std::size_t idx) const
+    std::size_t CoreHardwareMesh::indexSize() const
+    {
+        return narrowestIndexSize(this->vertexCount());
+    }
+
+    std::size_t CoreHardwareMesh::relativeIndexSize() const
+    {
+        std::size_t ret = narrowestIndexSize(0);
+        for(SubMeshContainer::const_iterator i = m_submeshes.begin() ; i != m_submeshes.end() ; ++i) {
+            ret = std::max(ret, i->indexSize());
+        }
+        return ret;
+    }
+
+    std::vector<Uint32> CoreHardwareMesh::faceIndices(std::size_t idx) const
     {
         std::size_t startIdx = idx * this->indicesPerFace();
-        std::size_t endIdx = startIdx + this->indicesPerFace() - 1;
 
-        if(endIdx >= m_faceIndices.size()) {
+        if(startIdx + this->indicesPerFace() > m_faceIndices.size()) {
             throw std::out_of_range("Get face indices " + to_s(idx) + " (max: " + to_s(this->faceCount()) + ") in core hardware mesh");
         }
 
-        std::vector<BOUGE_FACE_INDEX_TYPE> ret(this->indicesPerFace());
-        std::copy(&m_faceIndices[startIdx], &m_faceIndices[endIdx], ret.begin());
-        return ret;
+        return std::vector<Uint32>(m_faceIndices.begin() + startIdx, m_faceIndices.begin() + startIdx + this->indicesPerFace());
     }
 
-    CoreHardwareMesh& CoreHardwareMesh::faceIndices(std::size_t idx, const std::vector<BOUGE_FACE_INDEX_TYPE>& indices)
+    CoreHardwareMesh& CoreHardwareMesh::faceIndices(std::size_t idx, const std::vector<Uint32>& indices)
     {
         std::size_t iFirstIdx = this->indicesPerFace()*idx;
 
-        if(iFirstIdx + this->indicesPerFace() >= m_faceIndices.size())
+        if(iFirstIdx + this->indicesPerFace() > m_faceIndices.size())
             throw std::out_of_range("Face " + to_s(idx) + " doesn't exist, there are only " + to_s(this->faceCount()));
 
         for(std::size_t i = 0 ; i < this->indicesPerFace() && i < indices.size() ; ++i) {
@@ -812,26 +1521,65 @@ namespace bouge {
         return *this;
     }
 
-    std::vector<BOUGE_FACE_INDEX_TYPE>& CoreHardwareMesh::faceIndices()
+    std::vector<Uint32>& CoreHardwareMesh::faceIndices()
     {
         return m_faceIndices;
     }
 
-    const std::vector<BOUGE_FACE_INDEX_TYPE>& CoreHardwareMesh::faceIndices() const
+    const std::vector<Uint32>& CoreHardwareMesh::faceIndices() const
     {
         return m_faceIndices;
     }
 
+    /// \internal
+    /// Writes the \a count indices starting at \a first into \a where, as
+    /// \a IndexT, subtracting \a base from all of them.
+    template<class IndexT>
+    static void writeIndicesAs(char* where, std::size_t stride, std::vector<Uint32>::const_iterator first, std::size_t count, std::size_t base)
+    {
+        for(std::size_t i = 0 ; i < count ; ++i, ++first) {
+            Uint32 idx = *first - (Uint32)base;
+            if(*first < base || (Uint32)(IndexT)idx != idx)
+                throw std::invalid_argument("The face index " + to_s(*first) + " (base " + to_s(base) + ") doesn't fit into " + to_s(sizeof(IndexT)) + " bytes");
+
+            *reinterpret_cast<IndexT*>(where + i*stride) = (IndexT)idx;
+        }
+    }
+
+    const CoreHardwareMesh& CoreHardwareMesh::writeIndices(void* where, std::size_t indexSize, bool bRelativeToBaseVertex) const
+    {
+        if(indexSize != sizeof(Uint16) && indexSize != sizeof(Uint32))
+            throw std::invalid_argument("Indices can only be " + to_s(sizeof(Uint16)) + " or " + to_s(sizeof(Uint32)) + " bytes big, not " + to_s(indexSize));
+
+        char* p = (char*)where;
+
+        if(!bRelativeToBaseVertex) {
+            if(indexSize == sizeof(Uint16))
+                writeIndicesAs<Uint16>(p, indexSize, m_faceIndices.begin(), m_faceIndices.size(), 0);
+            else
+                writeIndicesAs<Uint32>(p, indexSize, m_faceIndices.begin(), m_faceIndices.size(), 0);
+
+            return *this;
+        }
+
+        for(SubMeshContainer::const_iterator i = m_submeshes.begin() ; i != m_submeshes.end() ; ++i) {
+            std::size_t count = i->faceCount()*this->indicesPerFace();
+            if(indexSize == sizeof(Uint16))
+                writeIndicesAs<Uint16>(p + i->startIndex()*indexSize, indexSize, m_faceIndices.begin() + i->startIndex(), count, i->baseVertex());
+            else
+                writeIndicesAs<Uint32>(p + i->startIndex()*indexSize, indexSize, m_faceIndices.begin() + i->startIndex(), count, i->baseVertex());
+        }
+
+        return *this;
+    }
+
     const CoreHardwareMesh& CoreHardwareMesh::writeFaceIndices(BOUGE_FACE_INDEX_TYPE* where, std::size_t stride) const
     {
         // There is a little pointer magic involved to get the stride right...
         char* p = (char*)where;
-        for(std::vector<BOUGE_FACE_INDEX_TYPE>::const_iterator iFace = m_faceIndices.begin() ; iFace != m_faceIndices.end() ; ++iFace) {
+        for(std::size_t iFace = 0 ; iFace < this->faceCount() ; ++iFace) {
             // For every face, we write its X indices straight one after the other.
-            for(std::size_t jFaceIndex = 0 ; jFaceIndex < this->indicesPerFace() ; ++jFaceIndex) {
-                ((BOUGE_FACE_INDEX_TYPE*)p)[jFaceIndex] = *iFace;
-                ++iFace;
-            }
+            writeIndicesAs<BOUGE_FACE_INDEX_TYPE>(p, sizeof(BOUGE_FACE_INDEX_TYPE), m_faceIndices.begin() + iFace*this->indicesPerFace(), this->indicesPerFace(), 0);
 
             // Then, we skip "stride" bytes.
             p += stride;
@@ -0,0 +1,236 @@
+////////////////////////////////////////////////////////////
+//
+// Bouge - Modern and flexible skeletal animation library
+// Copyright (C) 2010 Lucas Beyer (pompei2@gmail.com)
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it freely,
+// subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+////////////////////////////////////////////////////////////
+#include <bouge/CoreHardwareMeshBinary.hpp>
+#include <bouge/CoreMesh.hpp>
+#include <bouge/Exception.hpp>
+#include <bouge/Util.hpp>
+
+#include <cstring>
+#include <stdexcept>
+
+namespace bouge {
+
+    const Uint32 CoreHardwareMeshBinary::version = 2;
+
+    /// \internal
+    /// \return true if the section of \a count elements of \a elemSize bytes at
+    ///         \a offset lies completely inside of the \a size bytes.
+    static bool sectionFits(Uint32 offset, Uint32 count, std::size_t elemSize, std::size_t size)
+    {
+        if(offset > size)
+            return false;
+
+        return count <= (size - offset) / (elemSize == 0 ? 1 : elemSize);
+    }
+
+    /// \internal
+    /// \return true if all the \a count indices of \a indexSize bytes at \a pIndices
+    ///         lie within [\a first, \a end).
+    static bool indicesIn(const unsigned char* pIndices, std::size_t count, std::size_t indexSize, Uint32 first, Uint32 end)
+    {
+        if(indexSize == sizeof(Uint16)) {
+            const Uint16* p = reinterpret_cast<const Uint16*>(pIndices);
+            for(std::size_t i = 0 ; i < count ; ++i) {
+                if(p[i] < first || p[i] >= end)
+                    return false;
+            }
+        } else {
+            const Uint32* p = reinterpret_cast<const Uint32*>(pIndices);
+            for(std::size_t i = 0 ; i < count ; ++i) {
+                if(p[i] < first || p[i] >= end)
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    CoreHardwareMeshBinary::CoreHardwareMeshBinary(const void* pData, std::size_t size)
+        : m_pData(reinterpret_cast<const unsigned char*>(pData))
+        , m_size(size)
+    {
+        if(m_pData == 0 || size < sizeof(CoreHardwareMeshBinaryHeader))
+            throw BadDataException("The prebuilt hardware mesh is too small (" + to_s(size) + " bytes) to even hold its header", __FILE__, __LINE__);
+
+        if(reinterpret_cast<std::size_t>(pData) % sizeof(Uint32) != 0)
+            throw BadDataException("The prebuilt hardware mesh is not aligned to " + to_s(sizeof(Uint32)) + " bytes", __FILE__, __LINE__);
+
+        const CoreHardwareMeshBinaryHeader& h = this->header();
+        if(std::memcmp(h.magic, "BOUGEHWM", sizeof(h.magic)) != 0)
+            throw BadDataException("This is not a prebuilt hardware mesh (wrong magic)", __FILE__, __LINE__);
+
+        if(h.byteOrderMark != 0x01020304)
+            throw BadDataException("The prebuilt hardware mesh has been written on a machine with a different byte order", __FILE__, __LINE__);
+
+        if(h.version != version)
+            throw BadDataException("The prebuilt hardware mesh has version " + to_s(h.version) + " but we can only read version " + to_s(version), __FILE__, __LINE__);
+
+        if(h.indexSize != sizeof(Uint16) && h.indexSize != sizeof(Uint32))
+            throw BadDataException("The prebuilt hardware mesh uses " + to_s(h.indexSize) + " bytes per face index, but only " + to_s(sizeof(Uint16)) + " or " + to_s(sizeof(Uint32)) + " are possible", __FILE__, __LINE__);
+
+        // Check that all the sections are where they should be, so we never
+        // need to check that again in the accessors.
+        if(h.totalSize > size
+        || !sectionFits(h.streamsOffset, h.streamCount, sizeof(CoreHardwareMeshBinaryStream), h.totalSize)
+        || !sectionFits(h.submeshesOffset, h.submeshCount, sizeof(CoreHardwareMeshBinarySubMesh), h.totalSize)
+        || !sectionFits(h.paletteOffset, h.paletteSize, sizeof(Uint32), h.totalSize)
+        || !sectionFits(h.stringsOffset, h.stringsSize, 1, h.totalSize)
+        || !sectionFits(h.verticesOffset, h.vertexCount, h.vertexStride, h.totalSize)
+        || !sectionFits(h.indicesOffset, h.indexCount, h.indexSize, h.totalSize))
+            throw BadDataException("The prebuilt hardware mesh is truncated or corrupt", __FILE__, __LINE__);
+
+        for(std::size_t i = 0 ; i < this->streamCount() ; ++i) {
+            const CoreHardwareMeshBinaryStream& s = this->stream(i);
+            if(s.offsetInVertex + s.coordCount*sizeof(float) > h.vertexStride)
+                throw BadDataException("The stream " + to_s(i) + " of the prebuilt hardware mesh doesn't fit into a vertex", __FILE__, __LINE__);
+        }
+
+        for(std::size_t i = 0 ; i < this->submeshCount() ; ++i) {
+            const CoreHardwareMeshBinarySubMesh& s = this->submesh(i);
+            if(s.firstBone > h.paletteSize || s.boneCount > h.paletteSize - s.firstBone
+            || s.startIndex > h.indexCount || (std::size_t)s.faceCount*h.verticesPerFace > h.indexCount - s.startIndex
+            || s.baseVertex > h.vertexCount || s.vertexCount > h.vertexCount - s.baseVertex)
+                throw BadDataException("The submesh " + to_s(i) + " of the prebuilt hardware mesh is corrupt", __FILE__, __LINE__);
+
+            // The indices go straight to the graphics card, they better stay
+            // within the vertices of their submesh.
+            const unsigned char* pIndices = m_pData + h.indicesOffset + s.startIndex*h.indexSize;
+            if(!indicesIn(pIndices, s.faceCount*h.verticesPerFace, h.indexSize, s.baseVertex, s.baseVertex + s.vertexCount))
+                throw BadDataException("The submesh " + to_s(i) + " of the prebuilt hardware mesh has face indices out of its vertices", __FILE__, __LINE__);
+        }
+
+        // Just in case some aren't part of any submesh.
+        if(!indicesIn(m_pData + h.indicesOffset, h.indexCount, h.indexSize, 0, h.vertexCount))
+            throw BadDataException("The prebuilt hardware mesh has face indices out of its vertices", __FILE__, __LINE__);
+    }
+
+    CoreHardwareMeshBinary::~CoreHardwareMeshBinary()
+    { }
+
+    bool CoreHardwareMeshBinary::isBuiltFrom(CoreMeshPtrC coremesh, unsigned int bonesPerMesh, unsigned char bonesPerVertex, unsigned char verticesPerFace, CoreHardwareMesh::PartitionMethod method) const
+    {
+        const CoreHardwareMeshBinaryHeader& h = this->header();
+        return h.bonesPerMesh == bonesPerMesh
+            && h.bonesPerVertex == bonesPerVertex
+            && h.verticesPerFace == verticesPerFace
+            && h.partitionMethod == (Uint32)method
+            && h.sourceHash == coremesh->contentHash();
+    }
+
+    const CoreHardwareMeshBinaryHeader& CoreHardwareMeshBinary::header() const
+    {
+        return *reinterpret_cast<const CoreHardwareMeshBinaryHeader*>(m_pData);
+    }
+
+    std::size_t CoreHardwareMeshBinary::streamCount() const
+    {
+        return this->header().streamCount;
+    }
+
+    const CoreHardwareMeshBinaryStream& CoreHardwareMeshBinary::stream(std::size_t idx) const
+    {
+        if(idx >= this->streamCount())
+            throw std::out_of_range("Stream " + to_s(idx) + " doesn't exist, there are only " + to_s(this->streamCount()));
+
+        return reinterpret_cast<const CoreHardwareMeshBinaryStream*>(m_pData + this->header().streamsOffset)[idx];
+    }
+
+    std::string CoreHardwareMeshBinary::streamName(std::size_t idx) const
+    {
+        return this->string(this->stream(idx).name);
+    }
+
+    std::size_t CoreHardwareMeshBinary::submeshCount() const
+    {
+        return this->header().submeshCount;
+    }
+
+    const CoreHardwareMeshBinarySubMesh& CoreHardwareMeshBinary::submesh(std::size_t idx) const
+    {
+        if(idx >= this->submeshCount())
+            throw std::out_of_range("Submesh " + to_s(idx) + " doesn't exist, there are only " + to_s(this->submeshCount()));
+
+        return reinterpret_cast<const CoreHardwareMeshBinarySubMesh*>(m_pData + this->header().submeshesOffset)[idx];
+    }
+
+    std::string CoreHardwareMeshBinary::submeshName(std::size_t idx) const
+    {
+        return this->string(this->submesh(idx).name);
+    }
+
+    std::string CoreHardwareMeshBinary::boneName(std::size_t submeshIdx, std::size_t idInSubmesh) const
+    {
+        const CoreHardwareMeshBinarySubMesh& s = this->submesh(submeshIdx);
+        if(idInSubmesh >= s.boneCount)
+            throw NotExistException("bone name of bone with id", to_s(idInSubmesh), "prebuilt hardware submesh", to_s(submeshIdx), __FILE__, __LINE__);
+
+        const Uint32* palette = reinterpret_cast<const Uint32*>(m_pData + this->header().paletteOffset);
+        return this->string(palette[s.firstBone + idInSubmesh]);
+    }
+
+    std::size_t CoreHardwareMeshBinary::vertexCount() const
+    {
+        return this->header().vertexCount;
+    }
+
+    std::size_t CoreHardwareMeshBinary::vertexStride() const
+    {
+        return this->header().vertexStride;
+    }
+
+    const void* CoreHardwareMeshBinary::vertices() const
+    {
+        return m_pData + this->header().verticesOffset;
+    }
+
+    std::size_t CoreHardwareMeshBinary::indexCount() const
+    {
+        return this->header().indexCount;
+    }
+
+    std::size_t CoreHardwareMeshBinary::indexSize() const
+    {
+        return this->header().indexSize;
+    }
+
+    const void* CoreHardwareMeshBinary::indices() const
+    {
+        return m_pData + this->header().indicesOffset;
+    }
+
+    std::string CoreHardwareMeshBinary::string(Uint32 offset) const
+    {
+        const CoreHardwareMeshBinaryHeader& h = this->header();
+        if(offset >= h.stringsSize)
+            throw BadDataException("String at " + to_s(offset) + " is out of the strings section of the prebuilt hardware mesh", __FILE__, __LINE__);
+
+        const char* pBegin = reinterpret_cast<const char*>(m_pData + h.stringsOffset + offset);
+        const void* pEnd = std::memchr(pBegin, '\0', h.stringsSize - offset);
+        if(pEnd == 0)
+            throw BadDataException("String at " + to_s(offset) + " of the prebuilt hardware mesh is not terminated", __FILE__, __LINE__);
+
+        return std::string(pBegin, reinterpret_cast<const char*>(pEnd));
+    }
+
+} // namespace bouge
@@ -56,20 +56,20 @@ namespace bouge
     }
 
     CoreMaterial::CoreMaterial(std::string name)
-        : m_sName(name)
+        : m_name(name)
     { }
 
     CoreMaterial::~CoreMaterial()
     { }
 
-    std::string CoreMaterial::name() const
+    const Name& CoreMaterial::name() const
     {
-        return m_sName;
+        return m_name;
     }
 
-    CoreMaterial& CoreMaterial::name(std::string name)
+    CoreMaterial& CoreMaterial::name(const Name& name)
     {
-        m_sName = name;
+        m_name = name;
         return *this;
     }
 
@@ -95,7 +95,7 @@ namespace bouge
     {
         PropretyMap::const_iterator i = m_propreties.find(name);
         if(i == m_propreties.end())
-            throw std::invalid_argument("No proprety named " + name + " found in the material " + m_sName);
+            throw std::invalid_argument("No proprety named " + name + " found in the material " + m_name.str());
 
         return i->second.valAsFvec();
     }
@@ -24,43 +24,63 @@
 #include <bouge/CoreMesh.hpp>
 #include <bouge/Util.hpp>
 
+#include <algorithm>
 #include <stdexcept>
 
 namespace bouge
 {
 
     CoreSubMesh::CoreSubMesh(std::string name)
-        : m_sName(name)
-        , m_bAllFacesAreTriangles(true)
+        : m_name(name)
+        , m_influenceStarts(1, 0)
     { }
 
     CoreSubMesh::~CoreSubMesh()
     { }
 
-    std::string CoreSubMesh::name() const
+    const Name& CoreSubMesh::name() const
     {
-        return m_sName;
+        return m_name;
     }
 
-    CoreSubMesh& CoreSubMesh::name(std::string name)
+    CoreSubMesh& CoreSubMesh::name(const Name& name)
     {
-        m_sName = name;
+        m_name = name;
         return *this;
     }
 
     std::size_t CoreSubMesh::vertexCount() const
     {
-        return m_verts.size();
+        return m_positions.size() / 3;
     }
 
     std::size_t CoreSubMesh::faceCount() const
     {
-        return m_faces.size();
+        return m_faceStarts.empty() ? m_faceIndices.size() / 3 : m_faceStarts.size() - 1;
     }
 
     CoreSubMesh& CoreSubMesh::addVertex(Vertex vert)
     {
-        m_verts.push_back(vert);
+        this->checkAttribs(vert);
+
+        std::size_t idx = this->vertexCount();
+        m_positions.push_back(vert.pos().x());
+        m_positions.push_back(vert.pos().y());
+        m_positions.push_back(vert.pos().z());
+
+        for(AttribStreams::iterator i = m_attribs.begin() ; i != m_attribs.end() ; ++i) {
+            i->second.coords.resize(i->second.coords.size() + i->second.coordCount, 0.0f);
+            i->second.present.push_back(false);
+        }
+        this->storeAttribs(idx, vert);
+
+        for(std::size_t i = 0 ; i < vert.influenceCount() ; ++i) {
+            Influence inf = vert.influence(i);
+            m_influenceBones.push_back(this->boneId(inf.sBoneName));
+            m_influenceWeights.push_back(inf.w);
+        }
+        m_influenceStarts.push_back(m_influenceBones.size());
+
         return *this;
     }
 
@@ -69,7 +89,21 @@ namespace bouge
         if(idx >= this->vertexCount())
             throw std::out_of_range("Get vertex " + to_s(idx) + " (max: " + to_s(this->vertexCount()) + ") in core mesh");
 
-        return m_verts[idx];
+        Vertex ret(Vector(&m_positions[3*idx]));
+
+        for(Uint32 i = m_influenceStarts[idx] ; i < m_influenceStarts[idx+1] ; ++i) {
+            ret.addInfluence(Influence(m_influenceWeights[i], m_boneNames[m_influenceBones[i]]));
+        }
+
+        for(AttribStreams::const_iterator i = m_attribs.begin() ; i != m_attribs.end() ; ++i) {
+            if(!i->second.present[idx])
+                continue;
+
+            std::vector<float>::const_iterator iFirst = i->second.coords.begin() + idx*i->second.coordCount;
+            ret.attrib(i->first, std::vector<float>(iFirst, iFirst + i->second.coordCount));
+        }
+
+        return ret;
     }
 
     CoreSubMesh& CoreSubMesh::vertex(std::size_t idx, Vertex vtx)
@@ -77,14 +111,189 @@ namespace bouge
         if(idx >= this->vertexCount())
             throw std::out_of_range("Set vertex " + to_s(idx) + " (max: " + to_s(this->vertexCount()) + ") in core mesh");
 
-        m_verts[idx] = vtx;
+        this->checkAttribs(vtx);
+
+        m_positions[3*idx    ] = vtx.pos().x();
+        m_positions[3*idx + 1] = vtx.pos().y();
+        m_positions[3*idx + 2] = vtx.pos().z();
+
+        for(AttribStreams::iterator i = m_attribs.begin() ; i != m_attribs.end() ; ++i) {
+            std::fill(i->second.coords.begin() + idx*i->second.coordCount, i->second.coords.begin() + (idx+1)*i->second.coordCount, 0.0f);
+            i->second.present[idx] = false;
+        }
+        this->storeAttribs(idx, vtx);
+
+        // Replace the old influences by the new ones, moving all the following ones.
+        std::vector<Uint32> bones;
+        std::vector<float> weights;
+        for(std::size_t i = 0 ; i < vtx.influenceCount() ; ++i) {
+            Influence inf = vtx.influence(i);
+            bones.push_back(this->boneId(inf.sBoneName));
+            weights.push_back(inf.w);
+        }
+
+        Uint32 first = m_influenceStarts[idx];
+        Uint32 oldCount = m_influenceStarts[idx+1] - first;
+        m_influenceBones.erase(m_influenceBones.begin() + first, m_influenceBones.begin() + first + oldCount);
+        m_influenceBones.insert(m_influenceBones.begin() + first, bones.begin(), bones.end());
+        m_influenceWeights.erase(m_influenceWeights.begin() + first, m_influenceWeights.begin() + first + oldCount);
+        m_influenceWeights.insert(m_influenceWeights.begin() + first, weights.begin(), weights.end());
+        for(std::size_t i = idx + 1 ; i < m_influenceStarts.size() ; ++i) {
+            m_influenceStarts[i] = m_influenceStarts[i] - oldCount + bones.size();
+        }
+
         return *this;
     }
 
+    void CoreSubMesh::checkAttribs(const Vertex& vtx) const
+    {
+        for(Vertex::const_iterator i = vtx.begin() ; i != vtx.end() ; ++i) {
+            AttribStreams::const_iterator iStream = m_attribs.find(i.name());
+            if(iStream != m_attribs.end() && iStream->second.coordCount != i.value().size())
+                throw std::invalid_argument("Vertex with wrong-sized attribute '" + i.name() + "' in submesh '" + m_name.str() + "' (dimension is " + to_s(i.value().size()) + " but should be " + to_s(iStream->second.coordCount) + ")");
+        }
+    }
+
+    void CoreSubMesh::storeAttribs(std::size_t idx, const Vertex& vtx)
+    {
+        for(Vertex::const_iterator i = vtx.begin() ; i != vtx.end() ; ++i) {
+            AttribStreams::iterator iStream = m_attribs.find(i.name());
+
+            // The first vertex having this attribute creates its stream.
+            if(iStream == m_attribs.end()) {
+                iStream = m_attribs.insert(std::make_pair(i.name(), AttribStream())).first;
+                iStream->second.coordCount = i.value().size();
+                iStream->second.coords.resize(this->vertexCount()*iStream->second.coordCount, 0.0f);
+                iStream->second.present.resize(this->vertexCount(), false);
+            }
+
+            std::copy(i.value().begin(), i.value().end(), iStream->second.coords.begin() + idx*iStream->second.coordCount);
+            iStream->second.present[idx] = true;
+        }
+    }
+
+    Uint32 CoreSubMesh::boneId(const Name& name)
+    {
+        std::map<Name, Uint32>::iterator i = m_boneIds.find(name);
+        if(i != m_boneIds.end())
+            return i->second;
+
+        m_boneIds[name] = m_boneNames.size();
+        m_boneNames.push_back(name);
+        return m_boneNames.size() - 1;
+    }
+
+    Span<float> CoreSubMesh::positions() const
+    {
+        return Span<float>(m_positions);
+    }
+
+    Span<float> CoreSubMesh::position(std::size_t idx) const
+    {
+        if(idx >= this->vertexCount())
+            throw std::out_of_range("Get position of vertex " + to_s(idx) + " (max: " + to_s(this->vertexCount()) + ") in core mesh");
+
+        return Span<float>(&m_positions[3*idx], 3);
+    }
+
+    std::vector<std::string> CoreSubMesh::attribNames() const
+    {
+        std::vector<std::string> ret;
+        for(AttribStreams::const_iterator i = m_attribs.begin() ; i != m_attribs.end() ; ++i) {
+            ret.push_back(i->first);
+        }
+        return ret;
+    }
+
+    bool CoreSubMesh::hasAttrib(const std::string& name) const
+    {
+        return m_attribs.find(name) != m_attribs.end();
+    }
+
+    std::size_t CoreSubMesh::attribCoordCount(const std::string& name) const
+    {
+        AttribStreams::const_iterator i = m_attribs.find(name);
+        if(i == m_attribs.end())
+            throw std::invalid_argument("No generic attribute '" + name + "' in the submesh " + m_name.str());
+
+        return i->second.coordCount;
+    }
+
+    Span<float> CoreSubMesh::attribs(const std::string& name) const
+    {
+        AttribStreams::const_iterator i = m_attribs.find(name);
+        if(i == m_attribs.end())
+            throw std::invalid_argument("No generic attribute '" + name + "' in the submesh " + m_name.str());
+
+        return Span<float>(i->second.coords);
+    }
+
+    Span<float> CoreSubMesh::attrib(const std::string& name, std::size_t idx) const
+    {
+        if(idx >= this->vertexCount())
+            throw std::out_of_range("Get attribute of vertex " + to_s(idx) + " (max: " + to_s(this->vertexCount()) + ") in core mesh");
+
+        std::size_t coordCount = this->attribCoordCount(name);
+        return this->attribs(name).sub(idx*coordCount, coordCount);
+    }
+
+    bool CoreSubMesh::vertexHasAttrib(const std::string& name, std::size_t idx) const
+    {
+        if(idx >= this->vertexCount())
+            throw std::out_of_range("Get attribute of vertex " + to_s(idx) + " (max: " + to_s(this->vertexCount()) + ") in core mesh");
+
+        AttribStreams::const_iterator i = m_attribs.find(name);
+        return i != m_attribs.end() && i->second.present[idx];
+    }
+
+    std::size_t CoreSubMesh::boneCount() const
+    {
+        return m_boneNames.size();
+    }
+
+    const Name& CoreSubMesh::boneName(Uint32 id) const
+    {
+        if(id >= m_boneNames.size())
+            throw std::out_of_range("Get name of bone " + to_s(id) + " (max: " + to_s(m_boneNames.size()) + ") in core mesh");
+
+        return m_boneNames[id];
+    }
+
+    Span<Uint32> CoreSubMesh::influenceStarts() const
+    {
+        return Span<Uint32>(m_influenceStarts);
+    }
+
+    Span<Uint32> CoreSubMesh::influenceBones() const
+    {
+        return Span<Uint32>(m_influenceBones);
+    }
+
+    Span<float> CoreSubMesh::influenceWeights() const
+    {
+        return Span<float>(m_influenceWeights);
+    }
+
+    Span<Uint32> CoreSubMesh::influenceBones(std::size_t idx) const
+    {
+        if(idx >= this->vertexCount())
+            throw std::out_of_range("Get influences of vertex " + to_s(idx) + " (max: " + to_s(this->vertexCount()) + ") in core mesh");
+
+        return this->influenceBones().sub(m_influenceStarts[idx], m_influenceStarts[idx+1] - m_influenceStarts[idx]);
+    }
+
+    Span<float> CoreSubMesh::influenceWeights(std::size_t idx) const
+    {
+        if(idx >= this->vertexCount())
+            throw std::out_of_range("Get influences of vertex " + to_s(idx) + " (max: " + to_s(this->vertexCount()) + ") in core mesh");
+
+        return this->influenceWeights().sub(m_influenceStarts[idx], m_influenceStarts[idx+1] - m_influenceStarts[idx]);
+    }
+
     bool CoreSubMesh::canAddFace(const Face& face, Face::index_t* out_pFailing) const
     {
         for(std::vector<Face::index_t>::const_iterator i = face.idxs().begin() ; i != face.idxs().end() ; ++i) {
-            if(*i >= m_verts.size()) {
+            if(*i >= this->vertexCount()) {
                 if(out_pFailing) {
                     *out_pFailing = *i;
                 }
@@ -101,11 +310,13 @@ namespace bouge
         if(!this->canAddFace(face, &failing))
             throw std::invalid_argument("Face containing a too big vertex index (" + to_s(failing) + ", max: " + to_s(this->vertexCount()) + ")");
 
-        m_faces.push_back(face);
+        // Now check if still all faces are triangles.
+        if(!face.isTriangle() && m_faceStarts.empty())
+            this->storeFaceStarts();
 
-        // Now check if still all faces are polys.
-        if(!face.isTriangle())
-            m_bAllFacesAreTriangles = false;
+        m_faceIndices.insert(m_faceIndices.end(), face.idxs().begin(), face.idxs().end());
+        if(!m_faceStarts.empty())
+            m_faceStarts.push_back(m_faceIndices.size());
 
         return *this;
     }
@@ -115,7 +326,8 @@ namespace bouge
         if(idx >= this->faceCount())
             throw std::out_of_range("Get face " + to_s(idx) + " (max: " + to_s(this->faceCount()) + ") in core mesh");
 
-        return m_faces[idx];
+        Span<Uint32> idxs = this->faceIndices(idx);
+        return Face(std::vector<Face::index_t>(idxs.begin(), idxs.end()));
     }
 
     CoreSubMesh& CoreSubMesh::face(std::size_t idx, Face face)
@@ -123,13 +335,126 @@ namespace bouge
         if(idx >= this->faceCount())
             throw std::out_of_range("Set face " + to_s(idx) + " (max: " + to_s(this->faceCount()) + ") in core mesh");
 
-        m_faces[idx] = face;
+        Face::index_t failing;
+        if(!this->canAddFace(face, &failing))
+            throw std::invalid_argument("Face containing a too big vertex index (" + to_s(failing) + ", max: " + to_s(this->vertexCount()) + ")");
+
+        if(!face.isTriangle() && m_faceStarts.empty())
+            this->storeFaceStarts();
+
+        // Same size? Just overwrite it. Else, move all the following faces.
+        std::size_t first = m_faceStarts.empty() ? 3*idx : m_faceStarts[idx];
+        std::size_t oldCount = m_faceStarts.empty() ? 3 : m_faceStarts[idx+1] - first;
+        if(oldCount == face.idxs().size()) {
+            std::copy(face.idxs().begin(), face.idxs().end(), m_faceIndices.begin() + first);
+        } else {
+            m_faceIndices.erase(m_faceIndices.begin() + first, m_faceIndices.begin() + first + oldCount);
+            m_faceIndices.insert(m_faceIndices.begin() + first, face.idxs().begin(), face.idxs().end());
+            for(std::size_t i = idx + 1 ; i < m_faceStarts.size() ; ++i) {
+                m_faceStarts[i] = m_faceStarts[i] - oldCount + face.idxs().size();
+            }
+        }
+
+        // That may have been the last face which wasn't a triangle.
+        if(face.isTriangle() && oldCount != 3)
+            this->dropFaceStartsIfAllTriangles();
+
+        return *this;
+    }
+
+    CoreSubMesh& CoreSubMesh::addTriangles(Span<Uint32> indices)
+    {
+        if(indices.size() % 3 != 0)
+            throw std::invalid_argument("Adding triangles from " + to_s(indices.size()) + " indices, which is not a multiple of three");
+
+        for(Span<Uint32>::const_iterator i = indices.begin() ; i != indices.end() ; ++i) {
+            if(*i >= this->vertexCount())
+                throw std::invalid_argument("Face containing a too big vertex index (" + to_s(*i) + ", max: " + to_s(this->vertexCount()) + ")");
+        }
+
+        m_faceIndices.insert(m_faceIndices.end(), indices.begin(), indices.end());
+        for(std::size_t i = 0 ; !m_faceStarts.empty() && i < indices.size() / 3 ; ++i) {
+            m_faceStarts.push_back(m_faceStarts.back() + 3);
+        }
+
         return *this;
     }
 
+    Span<Uint32> CoreSubMesh::faceIndices() const
+    {
+        return Span<Uint32>(m_faceIndices);
+    }
+
+    Span<Uint32> CoreSubMesh::faceIndices(std::size_t idx) const
+    {
+        if(idx >= this->faceCount())
+            throw std::out_of_range("Get face " + to_s(idx) + " (max: " + to_s(this->faceCount()) + ") in core mesh");
+
+        if(m_faceStarts.empty())
+            return this->faceIndices().sub(3*idx, 3);
+
+        return this->faceIndices().sub(m_faceStarts[idx], m_faceStarts[idx+1] - m_faceStarts[idx]);
+    }
+
+    void CoreSubMesh::storeFaceStarts()
+    {
+        std::size_t nFaces = this->faceCount();
+        m_faceStarts.reserve(nFaces + 1);
+        for(std::size_t i = 0 ; i <= nFaces ; ++i) {
+            m_faceStarts.push_back(3*i);
+        }
+    }
+
+    void CoreSubMesh::dropFaceStartsIfAllTriangles()
+    {
+        for(std::size_t i = 0 ; i + 1 < m_faceStarts.size() ; ++i) {
+            if(m_faceStarts[i+1] - m_faceStarts[i] != 3)
+                return;
+        }
+
+        m_faceStarts.clear();
+    }
+
     bool CoreSubMesh::allFacesAreTriangles() const
     {
-        return m_bAllFacesAreTriangles;
+        return m_faceStarts.empty();
+    }
+
+    Uint32 CoreSubMesh::contentHash() const
+    {
+        Uint32 h = fnv1aHash(m_name);
+
+        for(std::size_t iVtx = 0 ; iVtx < this->vertexCount() ; ++iVtx) {
+            h = fnv1aHash(&m_positions[3*iVtx], 3*sizeof(float), h);
+
+            Uint32 nInfluences = m_influenceStarts[iVtx+1] - m_influenceStarts[iVtx];
+            h = fnv1aHash(&nInfluences, sizeof(nInfluences), h);
+            for(Uint32 i = m_influenceStarts[iVtx] ; i < m_influenceStarts[iVtx+1] ; ++i) {
+                h = fnv1aHash(&m_influenceWeights[i], sizeof(float), h);
+                h = fnv1aHash(m_boneNames[m_influenceBones[i]], h);
+            }
+
+            for(AttribStreams::const_iterator iAttrib = m_attribs.begin() ; iAttrib != m_attribs.end() ; ++iAttrib) {
+                if(!iAttrib->second.present[iVtx])
+                    continue;
+
+                h = fnv1aHash(iAttrib->first, h);
+                Uint32 nCoords = iAttrib->second.coordCount;
+                h = fnv1aHash(&nCoords, sizeof(nCoords), h);
+                if(nCoords > 0)
+                    h = fnv1aHash(&iAttrib->second.coords[iVtx*nCoords], nCoords*sizeof(float), h);
+            }
+        }
+
+        for(std::size_t iFace = 0 ; iFace < this->faceCount() ; ++iFace) {
+            Span<Uint32> idxs = this->faceIndices(iFace);
+            Uint32 nIdxs = idxs.size();
+            h = fnv1aHash(&nIdxs, sizeof(nIdxs), h);
+            if(nIdxs > 0)
+                h = fnv1aHash(idxs.data(), nIdxs*sizeof(Uint32), h);
+        }
+
+        return h;
     }
 
     CoreMesh::CoreMesh(std::string name)
@@ -185,6 +510,18 @@ namespace bouge
         return true;
     }
 
+    Uint32 CoreMesh::contentHash() const
+    {
+        // The name of the mesh itself doesn't matter, only its contents.
+        Uint32 nSubMeshes = this->submeshCount();
+        Uint32 h = fnv1aHash(&nSubMeshes, sizeof(nSubMeshes));
+        for(const_iterator i = this->begin() ; i != this->end() ; ++i) {
+            Uint32 hSubMesh = i->contentHash();
+            h = fnv1aHash(&hSubMesh, sizeof(hSubMesh), h);
+        }
+        return h;
+    }
+
     CoreMesh& CoreMesh::add(CoreSubMeshPtr submesh)
     {
         m_submeshes[submesh->name()] = submesh;
@@ -0,0 +1,692 @@
+////////////////////////////////////////////////////////////
+//
+// Bouge - Modern and flexible skeletal animation library
+// Copyright (C) 2010 Lucas Beyer (pompei2@gmail.com)
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it freely,
+// subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+////////////////////////////////////////////////////////////
+#include <bouge/CoreMeshSimplifier.hpp>
+#include <bouge/CoreMesh.hpp>
+#include <bouge/Util.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+namespace bouge {
+
+    /// \internal
+    /// A quadric error, that is the symmetric 4x4 matrix summing up the squared
+    /// distances to a set of planes. Only its upper triangle is stored.
+    struct SimplifyQuadric
+    {
+        double m[10];
+
+        SimplifyQuadric()
+        {
+            std::fill(m, m + 10, 0.0);
+        }
+
+        /// Adds the plane ax + by + cz + d = 0, with (a,b,c) being of unit length.
+        void addPlane(double a, double b, double c, double d, double w)
+        {
+            m[0] += w*a*a; m[1] += w*a*b; m[2] += w*a*c; m[3] += w*a*d;
+                           m[4] += w*b*b; m[5] += w*b*c; m[6] += w*b*d;
+                                          m[7] += w*c*c; m[8] += w*c*d;
+                                                         m[9] += w*d*d;
+        }
+
+        SimplifyQuadric operator+(const SimplifyQuadric& o) const
+        {
+            SimplifyQuadric ret;
+            for(int i = 0 ; i < 10 ; ++i) {
+                ret.m[i] = m[i] + o.m[i];
+            }
+            return ret;
+        }
+
+        /// \return The sum of the squared (weighted) distances of point \a p to all the planes.
+        double error(const double* p) const
+        {
+            double x = p[0], y = p[1], z = p[2];
+            return m[0]*x*x + 2.0*m[1]*x*y + 2.0*m[2]*x*z + 2.0*m[3]*x
+                 + m[4]*y*y + 2.0*m[5]*y*z + 2.0*m[6]*y
+                 + m[7]*z*z + 2.0*m[8]*z
+                 + m[9];
+        }
+
+        /// Finds the point with the least error, if there is a single one.
+        /// \return false if there is no single such point (flat or straight areas).
+        bool optimum(double* p) const
+        {
+            // Solve the 3x3 system A p = -b using Cramer's rule.
+            double a00 = m[0], a01 = m[1], a02 = m[2];
+            double a11 = m[4], a12 = m[5], a22 = m[7];
+            double b0 = -m[3], b1 = -m[6], b2 = -m[8];
+
+            double c00 = a11*a22 - a12*a12;
+            double c01 = a02*a12 - a01*a22;
+            double c02 = a01*a12 - a02*a11;
+            double det = a00*c00 + a01*c01 + a02*c02;
+
+            double scale = std::fabs(a00) + std::fabs(a11) + std::fabs(a22);
+            if(std::fabs(det) <= 1e-9*scale*scale*scale)
+                return false;
+
+            p[0] = (b0*c00 + b1*c01 + b2*c02) / det;
+            p[1] = (b0*c01 + b1*(a00*a22 - a02*a02) + b2*(a01*a02 - a00*a12)) / det;
+            p[2] = (b0*c02 + b1*(a01*a02 - a00*a12) + b2*(a00*a11 - a01*a01)) / det;
+            return true;
+        }
+    };
+
+    /// \internal
+    /// A bone influence by the local id of the bone.
+    typedef std::pair<std::size_t, float> SimplifyInfluence;
+
+    /// \internal
+    /// Everything we know about a submesh while simplifying it.
+    struct SimplifySubMesh
+    {
+        std::vector<std::string> boneNames;
+        std::vector<std::string> attribNames;
+        std::vector<std::size_t> attribSizes;
+        std::size_t attribStride;
+
+        /// Three coordinates per vertex.
+        std::vector<double> pos;
+
+        /// attribStride floats per vertex, the attributes in the order of \a attribNames.
+        std::vector<float> attribs;
+
+        std::vector< std::vector<SimplifyInfluence> > influences;
+        std::vector<SimplifyQuadric> quadrics;
+
+        /// A third of the area of all the faces around each vertex.
+        std::vector<double> areas;
+
+        /// The faces using each vertex. Can contain already removed faces.
+        std::vector< std::vector<std::size_t> > vertexFaces;
+
+        /// Changes every time a vertex changes, to recognize outdated edges.
+        std::vector<std::size_t> versions;
+        std::vector<bool> vertexRemoved;
+
+        /// Three vertices per face.
+        std::vector<std::size_t> faces;
+        std::vector<bool> faceRemoved;
+        std::size_t liveFaces;
+    };
+
+    /// \internal
+    /// The collapse of the edge from vertex \a remove into vertex \a keep, as
+    /// it has been evaluated while both had the versions stored here.
+    struct SimplifyEdge
+    {
+        double cost;
+        std::size_t keep, remove;
+        std::size_t keepVersion, removeVersion;
+
+        /// Where \a keep moves to: the attributes are interpolated by \a t
+        /// from \a keep to \a remove.
+        double pos[3];
+        double t;
+
+        /// std::priority_queue gives us the largest, we want the cheapest.
+        bool operator<(const SimplifyEdge& o) const
+        {
+            return cost > o.cost;
+        }
+    };
+
+    /// \internal
+    /// \return The (not normalized) normal of the triangle \a a, \a b, \a c.
+    static void triangleNormal(const double* a, const double* b, const double* c, double* n)
+    {
+        double e1[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+        double e2[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+        n[0] = e1[1]*e2[2] - e1[2]*e2[1];
+        n[1] = e1[2]*e2[0] - e1[0]*e2[2];
+        n[2] = e1[0]*e2[1] - e1[1]*e2[0];
+    }
+
+    /// \internal
+    /// \return The best collapse of the edge between \a u and \a v.
+    static SimplifyEdge evaluateEdge(const SimplifySubMesh& m, std::size_t u, std::size_t v, float attribWeight)
+    {
+        SimplifyQuadric q = m.quadrics[u] + m.quadrics[v];
+        const double* pu = &m.pos[3*u];
+        const double* pv = &m.pos[3*v];
+
+        SimplifyEdge e;
+        e.keep = u;
+        e.remove = v;
+        e.keepVersion = m.versions[u];
+        e.removeVersion = m.versions[v];
+
+        // The candidates are both ends and the middle of the edge, and the
+        // optimal point, if there is one.
+        double candidates[4][3];
+        double ts[4] = {0.0, 1.0, 0.5, 0.0};
+        std::size_t nCandidates = 3;
+        for(int i = 0 ; i < 3 ; ++i) {
+            candidates[0][i] = pu[i];
+            candidates[1][i] = pv[i];
+            candidates[2][i] = 0.5*(pu[i] + pv[i]);
+        }
+
+        if(q.optimum(candidates[3])) {
+            // The attributes are interpolated by where it lies along the edge.
+            double d[3] = {pv[0] - pu[0], pv[1] - pu[1], pv[2] - pu[2]};
+            double len2 = d[0]*d[0] + d[1]*d[1] + d[2]*d[2];
+            double t = len2 > 0.0 ? ((candidates[3][0] - pu[0])*d[0] + (candidates[3][1] - pu[1])*d[1] + (candidates[3][2] - pu[2])*d[2]) / len2 : 0.0;
+            ts[3] = std::max(0.0, std::min(1.0, t));
+            nCandidates = 4;
+        }
+
+        e.cost = q.error(candidates[0]);
+        std::size_t best = 0;
+        for(std::size_t i = 1 ; i < nCandidates ; ++i) {
+            double cost = q.error(candidates[i]);
+            if(cost < e.cost) {
+                e.cost = cost;
+                best = i;
+            }
+        }
+
+        for(int i = 0 ; i < 3 ; ++i) {
+            e.pos[i] = candidates[best][i];
+        }
+        e.t = ts[best];
+
+        // Whatever we choose, some attribute values get lost.
+        if(attribWeight > 0.0f && m.attribStride > 0) {
+            double diff = 0.0;
+            for(std::size_t i = 0 ; i < m.attribStride ; ++i) {
+                double d = m.attribs[u*m.attribStride + i] - m.attribs[v*m.attribStride + i];
+                diff += d*d;
+            }
+            e.cost += attribWeight * diff * (m.areas[u] + m.areas[v]);
+        }
+
+        return e;
+    }
+
+    /// \internal
+    static bool heavierInfluence(const SimplifyInfluence& a, const SimplifyInfluence& b)
+    {
+        return a.second > b.second;
+    }
+
+    /// \internal
+    /// Interpolates the influences \a a and \a b by \a t, keeping at most as
+    /// many influences as the one of them having more, and the same total weight.
+    static void mergeInfluences(const std::vector<SimplifyInfluence>& a, const std::vector<SimplifyInfluence>& b, double t, std::vector<SimplifyInfluence>& out)
+    {
+        out.clear();
+        for(std::vector<SimplifyInfluence>::const_iterator i = a.begin() ; i != a.end() ; ++i) {
+            out.push_back(SimplifyInfluence(i->first, (float)((1.0 - t)*i->second)));
+        }
+
+        for(std::vector<SimplifyInfluence>::const_iterator i = b.begin() ; i != b.end() ; ++i) {
+            std::vector<SimplifyInfluence>::iterator j = out.begin();
+            while(j != out.end() && j->first != i->first)
+                ++j;
+
+            if(j != out.end())
+                j->second += (float)(t*i->second);
+            else
+                out.push_back(SimplifyInfluence(i->first, (float)(t*i->second)));
+        }
+
+        // Drop the weakest ones if we got too many.
+        std::size_t maxCount = std::max(a.size(), b.size());
+        if(out.size() > maxCount) {
+            float total = 0.0f, kept = 0.0f;
+            for(std::size_t i = 0 ; i < out.size() ; ++i) {
+                total += out[i].second;
+            }
+
+            std::stable_sort(out.begin(), out.end(), heavierInfluence);
+            out.resize(maxCount);
+
+            for(std::size_t i = 0 ; i < out.size() ; ++i) {
+                kept += out[i].second;
+            }
+            for(std::size_t i = 0 ; kept > 0.0f && i < out.size() ; ++i) {
+                out[i].second *= total / kept;
+            }
+        }
+    }
+
+    /// \internal
+    /// Creates a CoreSubMesh out of the current state of \a m.
+    static CoreSubMeshPtr snapshot(const SimplifySubMesh& m, const std::string& name)
+    {
+        CoreSubMeshPtr ret(new CoreSubMesh(name));
+
+        // Only keep the vertices that are still used, in their original order.
+        std::size_t nVerts = m.vertexRemoved.size();
+        std::vector<std::size_t> newIds(nVerts, nVerts);
+        for(std::size_t iFace = 0 ; iFace < m.faceRemoved.size() ; ++iFace) {
+            if(m.faceRemoved[iFace])
+                continue;
+
+            for(std::size_t i = 0 ; i < 3 ; ++i) {
+                newIds[m.faces[3*iFace + i]] = 0;
+            }
+        }
+
+        for(std::size_t iVtx = 0 ; iVtx < nVerts ; ++iVtx) {
+            if(newIds[iVtx] == nVerts)
+                continue;
+
+            newIds[iVtx] = ret->vertexCount();
+
+            Vertex vtx(Vector((float)m.pos[3*iVtx], (float)m.pos[3*iVtx + 1], (float)m.pos[3*iVtx + 2]));
+            for(std::vector<SimplifyInfluence>::const_iterator i = m.influences[iVtx].begin() ; i != m.influences[iVtx].end() ; ++i) {
+                vtx.addInfluence(Influence(i->second, m.boneNames[i->first]));
+            }
+
+            std::vector<float>::const_iterator iAttrib = m.attribs.begin() + iVtx*m.attribStride;
+            for(std::size_t i = 0 ; i < m.attribNames.size() ; ++i) {
+                vtx.attrib(m.attribNames[i], std::vector<float>(iAttrib, iAttrib + m.attribSizes[i]));
+                iAttrib += m.attribSizes[i];
+            }
+
+            ret->addVertex(vtx);
+        }
+
+        std::vector<Uint32> idxs;
+        idxs.reserve(m.faces.size());
+        for(std::size_t iFace = 0 ; iFace < m.faceRemoved.size() ; ++iFace) {
+            if(m.faceRemoved[iFace])
+                continue;
+
+            for(std::size_t i = 0 ; i < 3 ; ++i) {
+                idxs.push_back((Uint32)newIds[m.faces[3*iFace + i]]);
+            }
+        }
+        ret->addTriangles(Span<Uint32>(idxs));
+
+        return ret;
+    }
+
+    CoreMeshSimplifier::CoreMeshSimplifier()
+        : m_attribWeight(1.0f)
+        , m_boundaryWeight(100.0f)
+        , m_maxBonesPerFace(0)
+    { }
+
+    CoreMeshSimplifier::~CoreMeshSimplifier()
+    { }
+
+    float CoreMeshSimplifier::attribWeight() const
+    {
+        return m_attribWeight;
+    }
+
+    CoreMeshSimplifier& CoreMeshSimplifier::attribWeight(float weight)
+    {
+        m_attribWeight = weight;
+        return *this;
+    }
+
+    float CoreMeshSimplifier::boundaryWeight() const
+    {
+        return m_boundaryWeight;
+    }
+
+    CoreMeshSimplifier& CoreMeshSimplifier::boundaryWeight(float weight)
+    {
+        m_boundaryWeight = weight;
+        return *this;
+    }
+
+    unsigned int CoreMeshSimplifier::maxBonesPerFace() const
+    {
+        return m_maxBonesPerFace;
+    }
+
+    CoreMeshSimplifier& CoreMeshSimplifier::maxBonesPerFace(unsigned int bones)
+    {
+        m_maxBonesPerFace = bones;
+        return *this;
+    }
+
+    CoreMeshPtr CoreMeshSimplifier::simplify(CoreMeshPtrC source, float ratio) const
+    {
+        return this->buildLODChain(source, 1, ratio).front();
+    }
+
+    std::vector<CoreMeshPtr> CoreMeshSimplifier::buildLODChain(CoreMeshPtrC source, std::size_t levelCount, float ratioPerLevel) const
+    {
+        std::vector<CoreMeshPtr> ret;
+        for(std::size_t iLevel = 0 ; iLevel < levelCount ; ++iLevel) {
+            ret.push_back(CoreMeshPtr(new CoreMesh(source->name())));
+        }
+
+        ratioPerLevel = std::max(0.0f, std::min(1.0f, ratioPerLevel));
+
+        for(CoreMesh::const_iterator iSubMesh = source->begin() ; iSubMesh != source->end() ; ++iSubMesh) {
+            std::vector<std::size_t> faceTargets;
+            double ratio = 1.0;
+            for(std::size_t iLevel = 0 ; iLevel < levelCount ; ++iLevel) {
+                ratio *= ratioPerLevel;
+                faceTargets.push_back((std::size_t)(ratio*iSubMesh->faceCount() + 0.5));
+            }
+
+            std::vector<CoreSubMeshPtr> levels = this->simplify(*iSubMesh, faceTargets);
+            for(std::size_t iLevel = 0 ; iLevel < levelCount ; ++iLevel) {
+                ret[iLevel]->add(levels[iLevel]);
+            }
+        }
+
+        return ret;
+    }
+
+    std::vector<CoreSubMeshPtr> CoreMeshSimplifier::simplify(CoreSubMeshPtrC source, const std::vector<std::size_t>& faceTargets) const
+    {
+        std::vector<CoreSubMeshPtr> ret;
+
+        // We only know how to simplify triangles.
+        if(!source->allFacesAreTriangles()) {
+            for(std::size_t i = 0 ; i < faceTargets.size() ; ++i) {
+                ret.push_back(CoreSubMeshPtr(new CoreSubMesh(*source)));
+            }
+            return ret;
+        }
+
+        std::size_t nVerts = source->vertexCount();
+        std::size_t nFaces = source->faceCount();
+
+        SimplifySubMesh m;
+
+        // All the attributes any vertex has, one after the other. Those
+        // missing in a vertex are zero.
+        m.attribNames = source->attribNames();
+        m.attribStride = 0;
+        for(std::vector<std::string>::const_iterator i = m.attribNames.begin() ; i != m.attribNames.end() ; ++i) {
+            m.attribSizes.push_back(source->attribCoordCount(*i));
+            m.attribStride += m.attribSizes.back();
+        }
+
+        m.attribs.resize(m.attribStride*nVerts);
+        std::size_t attribOffset = 0;
+        for(std::size_t i = 0 ; i < m.attribNames.size() ; ++i) {
+            Span<float> attrib = source->attribs(m.attribNames[i]);
+            for(std::size_t iVtx = 0 ; iVtx < nVerts ; ++iVtx) {
+                std::copy(attrib.begin() + iVtx*m.attribSizes[i], attrib.begin() + (iVtx+1)*m.attribSizes[i], m.attribs.begin() + iVtx*m.attribStride + attribOffset);
+            }
+            attribOffset += m.attribSizes[i];
+        }
+
+        Span<float> positions = source->positions();
+        m.pos.assign(positions.begin(), positions.end());
+
+        // The bones are already numbered locally by the submesh.
+        for(std::size_t iBone = 0 ; iBone < source->boneCount() ; ++iBone) {
+            m.boneNames.push_back(source->boneName(iBone));
+        }
+
+        m.influences.resize(nVerts);
+        for(std::size_t iVtx = 0 ; iVtx < nVerts ; ++iVtx) {
+            Span<Uint32> bones = source->influenceBones(iVtx);
+            Span<float> weights = source->influenceWeights(iVtx);
+            for(std::size_t i = 0 ; i < bones.size() ; ++i) {
+                m.influences[iVtx].push_back(SimplifyInfluence(bones[i], weights[i]));
+            }
+        }
+
+        m.quadrics.resize(nVerts);
+        m.areas.resize(nVerts, 0.0);
+        m.vertexFaces.resize(nVerts);
+        m.versions.resize(nVerts, 0);
+        m.vertexRemoved.resize(nVerts, false);
+        m.faces.reserve(3*nFaces);
+        m.faceRemoved.resize(nFaces, false);
+        m.liveFaces = nFaces;
+
+        // Every face adds its plane to the quadrics of its vertices, weighted
+        // by its area so that many tiny faces don't outweigh a big one.
+        // Meanwhile, collect all the edges to find the borders.
+        std::vector< std::pair<std::pair<std::size_t, std::size_t>, std::size_t> > edges;
+        edges.reserve(3*nFaces);
+        for(std::size_t iFace = 0 ; iFace < nFaces ; ++iFace) {
+            Span<Uint32> f = source->faceIndices(iFace);
+            for(std::size_t i = 0 ; i < 3 ; ++i) {
+                m.faces.push_back(f[i]);
+                m.vertexFaces[f[i]].push_back(iFace);
+            }
+
+            for(std::size_t i = 0 ; i < 3 ; ++i) {
+                std::size_t a = f[i], b = f[(i+1)%3];
+                edges.push_back(std::make_pair(std::make_pair(std::min(a, b), std::max(a, b)), iFace));
+            }
+
+            double n[3];
+            triangleNormal(&m.pos[3*f[0]], &m.pos[3*f[1]], &m.pos[3*f[2]], n);
+            double len = std::sqrt(n[0]*n[0] + n[1]*n[1] + n[2]*n[2]);
+            if(len <= 0.0)
+                continue;
+
+            double area = 0.5*len;
+            n[0] /= len; n[1] /= len; n[2] /= len;
+            double d = -(n[0]*m.pos[3*f[0]] + n[1]*m.pos[3*f[0] + 1] + n[2]*m.pos[3*f[0] + 2]);
+            for(std::size_t i = 0 ; i < 3 ; ++i) {
+                m.quadrics[f[i]].addPlane(n[0], n[1], n[2], d, area);
+                m.areas[f[i]] += area / 3.0;
+            }
+        }
+
+        // Edges used by a single face are on a border. We hold them in place
+        // by adding a plane through the edge, perpendicular to the face.
+        std::sort(edges.begin(), edges.end());
+        for(std::size_t i = 0 ; i < edges.size() ; ) {
+            std::size_t j = i + 1;
+            while(j < edges.size() && edges[j].first == edges[i].first)
+                ++j;
+
+            std::size_t a = edges[i].first.first, b = edges[i].first.second;
+            if(j - i == 1 && m_boundaryWeight > 0.0f) {
+                const std::size_t* f = &m.faces[3*edges[i].second];
+                double n[3];
+                triangleNormal(&m.pos[3*f[0]], &m.pos[3*f[1]], &m.pos[3*f[2]], n);
+
+                double e[3] = {m.pos[3*b] - m.pos[3*a], m.pos[3*b + 1] - m.pos[3*a + 1], m.pos[3*b + 2] - m.pos[3*a + 2]};
+                double bn[3] = {e[1]*n[2] - e[2]*n[1], e[2]*n[0] - e[0]*n[2], e[0]*n[1] - e[1]*n[0]};
+                double len = std::sqrt(bn[0]*bn[0] + bn[1]*bn[1] + bn[2]*bn[2]);
+                if(len > 0.0) {
+                    bn[0] /= len; bn[1] /= len; bn[2] /= len;
+                    double d = -(bn[0]*m.pos[3*a] + bn[1]*m.pos[3*a + 1] + bn[2]*m.pos[3*a + 2]);
+                    double w = m_boundaryWeight * (e[0]*e[0] + e[1]*e[1] + e[2]*e[2]);
+                    m.quadrics[a].addPlane(bn[0], bn[1], bn[2], d, w);
+                    m.quadrics[b].addPlane(bn[0], bn[1], bn[2], d, w);
+                }
+            }
+
+            i = j;
+        }
+
+        std::priority_queue<SimplifyEdge> heap;
+        for(std::size_t i = 0 ; i < edges.size() ; ++i) {
+            if(i == 0 || edges[i].first != edges[i-1].first)
+                heap.push(evaluateEdge(m, edges[i].first.first, edges[i].first.second, m_attribWeight));
+        }
+        edges.clear();
+
+        // Used to mark vertices and bones, see the hardware mesh for the stamps.
+        std::vector<std::size_t> vtxStamps(nVerts, 0);
+        std::vector<std::size_t> vtxStamps2(nVerts, 0);
+        std::vector<std::size_t> boneStamps(m.boneNames.size(), 0);
+        std::size_t stamp = 0;
+
+        std::vector<SimplifyInfluence> merged;
+
+        std::size_t iTarget = 0;
+        while(iTarget < faceTargets.size()) {
+            // Take a snapshot for all the levels of detail we reached.
+            if(m.liveFaces <= faceTargets[iTarget] || heap.empty()) {
+                ret.push_back(snapshot(m, source->name()));
+                ++iTarget;
+                continue;
+            }
+
+            SimplifyEdge e = heap.top();
+            heap.pop();
+
+            std::size_t u = e.keep, v = e.remove;
+            if(m.vertexRemoved[u] || m.vertexRemoved[v] || m.versions[u] != e.keepVersion || m.versions[v] != e.removeVersion)
+                continue;
+
+            // Don't change the topology: the only vertices that are neighbours
+            // of both u and v must be those of the faces that we remove.
+            ++stamp;
+            for(std::vector<std::size_t>::const_iterator iFace = m.vertexFaces[u].begin() ; iFace != m.vertexFaces[u].end() ; ++iFace) {
+                for(std::size_t i = 0 ; i < 3 && !m.faceRemoved[*iFace] ; ++i) {
+                    vtxStamps[m.faces[3*(*iFace) + i]] = stamp;
+                }
+            }
+
+            std::size_t sharedFaces = 0, sharedNeighbours = 0;
+            for(std::vector<std::size_t>::const_iterator iFace = m.vertexFaces[v].begin() ; iFace != m.vertexFaces[v].end() ; ++iFace) {
+                if(m.faceRemoved[*iFace])
+                    continue;
+
+                const std::size_t* f = &m.faces[3*(*iFace)];
+                if(f[0] == u || f[1] == u || f[2] == u)
+                    sharedFaces++;
+
+                for(std::size_t i = 0 ; i < 3 ; ++i) {
+                    if(f[i] != u && f[i] != v && vtxStamps[f[i]] == stamp && vtxStamps2[f[i]] != stamp) {
+                        vtxStamps2[f[i]] = stamp;
+                        sharedNeighbours++;
+                    }
+                }
+            }
+
+            if(sharedFaces == 0 || sharedNeighbours != sharedFaces)
+                continue;
+
+            mergeInfluences(m.influences[u], m.influences[v], e.t, merged);
+
+            // Don't flip any face around, nor give it more bones than allowed.
+            bool bOk = true;
+            for(std::size_t iEnd = 0 ; iEnd < 2 && bOk ; ++iEnd) {
+                const std::vector<std::size_t>& around = m.vertexFaces[iEnd == 0 ? u : v];
+                for(std::vector<std::size_t>::const_iterator iFace = around.begin() ; iFace != around.end() && bOk ; ++iFace) {
+                    if(m.faceRemoved[*iFace])
+                        continue;
+
+                    const std::size_t* f = &m.faces[3*(*iFace)];
+                    bool bHasU = f[0] == u || f[1] == u || f[2] == u;
+                    bool bHasV = f[0] == v || f[1] == v || f[2] == v;
+                    if(bHasU && bHasV)
+                        continue;
+
+                    const double* p[3];
+                    for(std::size_t i = 0 ; i < 3 ; ++i) {
+                        p[i] = (f[i] == u || f[i] == v) ? e.pos : &m.pos[3*f[i]];
+                    }
+
+                    double nOld[3], nNew[3];
+                    triangleNormal(&m.pos[3*f[0]], &m.pos[3*f[1]], &m.pos[3*f[2]], nOld);
+                    triangleNormal(p[0], p[1], p[2], nNew);
+                    if(nOld[0]*nNew[0] + nOld[1]*nNew[1] + nOld[2]*nNew[2] <= 0.0)
+                        bOk = false;
+
+                    if(m_maxBonesPerFace > 0) {
+                        ++stamp;
+                        std::size_t nBones = 0;
+                        for(std::size_t i = 0 ; i < 3 ; ++i) {
+                            const std::vector<SimplifyInfluence>& infs = (f[i] == u || f[i] == v) ? merged : m.influences[f[i]];
+                            for(std::vector<SimplifyInfluence>::const_iterator iInf = infs.begin() ; iInf != infs.end() ; ++iInf) {
+                                if(boneStamps[iInf->first] != stamp) {
+                                    boneStamps[iInf->first] = stamp;
+                                    nBones++;
+                                }
+                            }
+                        }
+
+                        if(nBones > m_maxBonesPerFace)
+                            bOk = false;
+                    }
+                }
+            }
+
+            if(!bOk)
+                continue;
+
+            // Now, collapse v into u.
+            for(std::size_t i = 0 ; i < 3 ; ++i) {
+                m.pos[3*u + i] = e.pos[i];
+            }
+            for(std::size_t i = 0 ; i < m.attribStride ; ++i) {
+                float& a = m.attribs[u*m.attribStride + i];
+                a = (float)((1.0 - e.t)*a + e.t*m.attribs[v*m.attribStride + i]);
+            }
+            m.influences[u].swap(merged);
+            m.quadrics[u] = m.quadrics[u] + m.quadrics[v];
+            m.areas[u] += m.areas[v];
+
+            for(std::vector<std::size_t>::const_iterator iFace = m.vertexFaces[v].begin() ; iFace != m.vertexFaces[v].end() ; ++iFace) {
+                if(m.faceRemoved[*iFace])
+                    continue;
+
+                std::size_t* f = &m.faces[3*(*iFace)];
+                if(f[0] == u || f[1] == u || f[2] == u) {
+                    m.faceRemoved[*iFace] = true;
+                    m.liveFaces--;
+                    continue;
+                }
+
+                for(std::size_t i = 0 ; i < 3 ; ++i) {
+                    if(f[i] == v)
+                        f[i] = u;
+                }
+                m.vertexFaces[u].push_back(*iFace);
+            }
+
+            m.vertexRemoved[v] = true;
+            std::vector<std::size_t>().swap(m.vertexFaces[v]);
+            m.versions[u]++;
+
+            // Forget about the removed faces and re-evaluate all edges around u.
+            std::vector<std::size_t> aroundU;
+            ++stamp;
+            for(std::vector<std::size_t>::const_iterator iFace = m.vertexFaces[u].begin() ; iFace != m.vertexFaces[u].end() ; ++iFace) {
+                if(m.faceRemoved[*iFace])
+                    continue;
+
+                aroundU.push_back(*iFace);
+                for(std::size_t i = 0 ; i < 3 ; ++i) {
+                    std::size_t w = m.faces[3*(*iFace) + i];
+                    if(w != u && vtxStamps[w] != stamp) {
+                        vtxStamps[w] = stamp;
+                        heap.push(evaluateEdge(m, u, w, m_attribWeight));
+                    }
+                }
+            }
+            m.vertexFaces[u].swap(aroundU);
+        }
+
+        return ret;
+    }
+
+} // namespace bouge
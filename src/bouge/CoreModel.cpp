@@ -27,6 +27,7 @@
 #include <bouge/CoreMaterial.hpp>
 #include <bouge/CoreMaterialSet.hpp>
 #include <bouge/CoreHardwareMesh.hpp>
+#include <bouge/BoneBounds.hpp>
 #include <bouge/CoreAnimation.hpp>
 
 #include <stdexcept>
@@ -434,12 +435,24 @@ namespace bouge {
         return const_materialset_iterator(m_matsets.end());
     }
 
-    bool CoreModel::hasAnimation(const std::string& name) const
+    bool CoreModel::hasAnimation(const Name& name) const
     {
         return m_anims.find(name) != m_anims.end();
     }
 
-    CoreAnimationPtr CoreModel::animation(const std::string& name)
+    bool CoreModel::hasAnimation(const std::string& name) const
+    {
+        // An unknown text can't name anything, but it does find the empty name.
+        Name found = Name::find(name);
+        return (!found.empty() || name.empty()) && this->hasAnimation(found);
+    }
+
+    bool CoreModel::hasAnimation(const char* name) const
+    {
+        return this->hasAnimation(std::string(name));
+    }
+
+    CoreAnimationPtr CoreModel::animation(const Name& name)
     {
         AnimationMap::iterator i = m_anims.find(name);
 
@@ -449,7 +462,7 @@ namespace bouge {
         return i->second;
     }
 
-    CoreAnimationPtrC CoreModel::animation(const std::string& name) const
+    CoreAnimationPtrC CoreModel::animation(const Name& name) const
     {
         AnimationMap::const_iterator i = m_anims.find(name);
 
@@ -473,7 +486,7 @@ namespace bouge {
         return *this;
     }
 
-    CoreModel& CoreModel::removeAnimation(const std::string& name)
+    CoreModel& CoreModel::removeAnimation(const Name& name)
     {
         m_anims.erase(name);
         return *this;
@@ -690,8 +703,13 @@ namespace bouge {
         return !missingBones().empty() && !missingMaterials().empty() && !missingMatsetSpecs().empty();
     }
 
-    CoreHardwareMeshPtr CoreModel::buildHardwareMesh(unsigned int bonesPerMesh, unsigned char bonesPerVertex, unsigned char verticesPerFace) const
+    BoneBoundsPtr CoreModel::buildBoneBounds() const
+    {
+        return BoneBoundsPtr(new BoneBounds(this->mesh(), this->skeleton()));
+    }
+
+    CoreHardwareMeshPtr CoreModel::buildHardwareMesh(unsigned int bonesPerMesh, unsigned char bonesPerVertex, unsigned char verticesPerFace, CoreHardwareMesh::PartitionMethod method) const
     {
-        return CoreHardwareMeshPtr(new CoreHardwareMesh(this->mesh(), bonesPerMesh, bonesPerVertex, verticesPerFace));
+        return CoreHardwareMeshPtr(new CoreHardwareMesh(this->mesh(), bonesPerMesh, bonesPerVertex, verticesPerFace, method));
     }
 }
@@ -56,12 +56,24 @@ namespace bouge {
         return *this;
     }
 
-    bool CoreSkeleton::hasBone(const std::string& name) const
+    bool CoreSkeleton::hasBone(const Name& name) const
     {
         return m_boneNames.find(name) != m_boneNames.end();
     }
 
-    BoneId CoreSkeleton::boneId(const std::string& name) const
+    bool CoreSkeleton::hasBone(const std::string& name) const
+    {
+        // An unknown text can't name anything, but it does find the empty name.
+        Name found = Name::find(name);
+        return (!found.empty() || name.empty()) && this->hasBone(found);
+    }
+
+    bool CoreSkeleton::hasBone(const char* name) const
+    {
+        return this->hasBone(std::string(name));
+    }
+
+    BoneId CoreSkeleton::boneId(const Name& name) const
     {
         BoneNamesMap::const_iterator i = m_boneNames.find(name);
         if(i == m_boneNames.end())
@@ -70,12 +82,12 @@ namespace bouge {
         return i->second;
     }
 
-    CoreBonePtr CoreSkeleton::bone(const std::string& name)
+    CoreBonePtr CoreSkeleton::bone(const Name& name)
     {
         return this->bone(this->boneId(name));
     }
 
-    CoreBonePtrC CoreSkeleton::bone(const std::string& name) const
+    CoreBonePtrC CoreSkeleton::bone(const Name& name) const
     {
         return this->bone(this->boneId(name));
     }
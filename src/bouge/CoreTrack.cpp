@@ -25,6 +25,8 @@
 #include <bouge/CoreKeyframe.hpp>
 #include <bouge/Math/Util.hpp>
 
+#include <cmath>
+
 namespace bouge {
 
     CoreTrack::CoreTrack()
@@ -32,6 +34,11 @@ namespace bouge {
         , m_bHasTranslation(false)
         , m_bHasRotation(false)
         , m_bHasScale(false)
+        , m_bRotationsAligned(false)
+        , m_interpolation(InterpolationLinear)
+        , m_rotChannel(ChannelAnimated)
+        , m_transChannel(ChannelAnimated)
+        , m_scaleChannel(ChannelAnimated)
     { }
 
     CoreTrack::~CoreTrack()
@@ -39,7 +46,7 @@ namespace bouge {
 
     bool CoreTrack::hasRotation() const
     {
-        return m_bHasRotation;
+        return m_bHasRotation && m_rotChannel != ChannelIdentity;
     }
 
     Quaternion CoreTrack::rotation(float time) const
@@ -47,6 +54,9 @@ namespace bouge {
         if(!this->hasRotation())
             return Quaternion();
 
+        if(m_rotChannel == ChannelConstant)
+            return m_constRot;
+
         const_iterator to = this->after(time);
         const_iterator from = to;
         if(from != this->begin())
@@ -57,15 +67,28 @@ namespace bouge {
             return from->rotation();
         }
 
+        float between = (time - from.time())/(to.time() - from.time());
+        if(m_interpolation == InterpolationSpline && between <= 1.0f) {
+            const_iterator prev = from, next = to;
+            if(prev != this->begin())
+                --prev;
+            if(++next == this->end())
+                next = to;
+            return spline(prev->rotation(), from->rotation(), to->rotation(), next->rotation(),
+                          prev.time(), from.time(), to.time(), next.time(), between);
+        }
+
         // Note: We really DO need slerp here, instead of nlerp, in the case
         // between goes beyond 1.0 (that is, we extrapolate).
-        float between = (time - from.time())/(to.time() - from.time());
+        if(m_bRotationsAligned && between <= 1.0f)
+            return from->rotation().fastSlerp(to->rotation(), between);
+
         return from->rotation().slerp(to->rotation(), between);
     }
 
     bool CoreTrack::hasTranslation() const
     {
-        return m_bHasTranslation;
+        return m_bHasTranslation && m_transChannel != ChannelIdentity;
     }
 
     Vector CoreTrack::translation(float time) const
@@ -73,6 +96,9 @@ namespace bouge {
         if(!this->hasTranslation())
             return Vector();
 
+        if(m_transChannel == ChannelConstant)
+            return m_constTrans;
+
         const_iterator to = this->after(time);
         const_iterator from = to;
         if(from != this->begin())
@@ -83,13 +109,24 @@ namespace bouge {
             return from->translation();
         }
 
+        // Splines would go wild when extrapolating, stay linear there.
         float between = (time - from.time())/(to.time() - from.time());
+        if(m_interpolation == InterpolationSpline && between <= 1.0f) {
+            const_iterator prev = from, next = to;
+            if(prev != this->begin())
+                --prev;
+            if(++next == this->end())
+                next = to;
+            return spline(prev->translation(), from->translation(), to->translation(), next->translation(),
+                          prev.time(), from.time(), to.time(), next.time(), between);
+        }
+
         return from->translation().lerp(to->translation(), between);
     }
 
     bool CoreTrack::hasScale() const
     {
-        return m_bHasScale;
+        return m_bHasScale && m_scaleChannel != ChannelIdentity;
     }
 
     Vector CoreTrack::scale(float time) const
@@ -97,6 +134,9 @@ namespace bouge {
         if(!this->hasScale())
             return Vector(1.0f, 1.0f, 1.0f);
 
+        if(m_scaleChannel == ChannelConstant)
+            return m_constScale;
+
         const_iterator to = this->after(time);
         const_iterator from = to;
         if(from != this->begin())
@@ -108,11 +148,22 @@ namespace bouge {
         }
 
         float between = (time - from.time())/(to.time() - from.time());
+        if(m_interpolation == InterpolationSpline && between <= 1.0f) {
+            const_iterator prev = from, next = to;
+            if(prev != this->begin())
+                --prev;
+            if(++next == this->end())
+                next = to;
+            return spline(prev->scale(), from->scale(), to->scale(), next->scale(),
+                          prev.time(), from.time(), to.time(), next.time(), between);
+        }
+
         return from->scale().lerp(to->scale(), between);
     }
 
     CoreTrack& CoreTrack::add(float time, CoreKeyframePtr keyframe)
     {
+        this->keyframesChanged();
         m_keyframes.insert(std::make_pair(time, keyframe));
 
         if(keyframe->hasTranslation())
@@ -129,6 +180,10 @@ namespace bouge {
 
     CoreTrack& CoreTrack::remove(iterator who)
     {
+#if BOUGE_USE_USERDATA
+        keyframeUserData.set(who.myIter->second.get(), UserDataPtr());
+#endif
+        m_bRotationsAligned = false;
         m_keyframes.erase(who.myIter);
         return this->updateDuration();
     }
@@ -136,7 +191,15 @@ namespace bouge {
     // If there are several inside [time-tolerance ; time+tolerance], all are removed.
     CoreTrack& CoreTrack::removeAllIn(float start, float end)
     {
-        m_keyframes.erase(m_keyframes.lower_bound(start), m_keyframes.upper_bound(end));
+        KeyframeMap::iterator first = m_keyframes.lower_bound(start);
+        KeyframeMap::iterator last = m_keyframes.upper_bound(end);
+#if BOUGE_USE_USERDATA
+        for(KeyframeMap::iterator i = first ; i != last ; ++i) {
+            keyframeUserData.set(i->second.get(), UserDataPtr());
+        }
+#endif
+        m_bRotationsAligned = false;
+        m_keyframes.erase(first, last);
         return this->updateDuration();
     }
 
@@ -150,6 +213,126 @@ namespace bouge {
         return m_duration;
     }
 
+    CoreTrack::Interpolation CoreTrack::interpolation() const
+    {
+        return m_interpolation;
+    }
+
+    CoreTrack& CoreTrack::interpolation(Interpolation mode)
+    {
+        m_interpolation = mode;
+        return *this;
+    }
+
+    CoreTrack& CoreTrack::alignRotations()
+    {
+        m_bRotationsAligned = true;
+
+        KeyframeMap::iterator prev = m_keyframes.end();
+        for(KeyframeMap::iterator i = m_keyframes.begin() ; i != m_keyframes.end() ; prev = i++) {
+            if(prev == m_keyframes.end() || prev->second->rotation().dot(i->second->rotation()) >= 0.0f)
+                continue;
+
+            // Keyframes without rotation stand for the identity, flipping
+            // them would give them a rotation. Just stay with slerp then.
+            if(i->second->hasRotation())
+                i->second->rotation(-i->second->rotation());
+            else
+                m_bRotationsAligned = false;
+        }
+
+        return *this;
+    }
+
+    bool CoreTrack::rotationsAligned() const
+    {
+        return m_bRotationsAligned;
+    }
+
+    /// \internal \return Whether none of the \a n components of \a a and \a b
+    ///           differ by more than \a tolerance.
+    static bool nearlyEqual(const float* a, const float* b, int n, float tolerance)
+    {
+        for(int i = 0 ; i < n ; ++i) {
+            if(std::fabs(a[i] - b[i]) > tolerance)
+                return false;
+        }
+
+        return true;
+    }
+
+    CoreTrack& CoreTrack::detectConstants(float tolerance)
+    {
+        m_rotChannel = m_transChannel = m_scaleChannel = ChannelAnimated;
+        if(m_keyframes.empty())
+            return *this;
+
+        KeyframeMap::const_iterator i = m_keyframes.begin();
+        m_constRot = i->second->rotation();
+        m_constTrans = i->second->translation();
+        m_constScale = i->second->scale();
+
+        bool constRot = true, constTrans = true, constScale = true;
+        for(++i ; i != m_keyframes.end() ; ++i) {
+            Quaternion rot = i->second->rotation();
+            Vector trans = i->second->translation();
+            Vector scale = i->second->scale();
+            constRot = constRot && nearlyEqual(rot.array4f(), m_constRot.array4f(), 4, tolerance);
+            constTrans = constTrans && nearlyEqual(trans.array3f(), m_constTrans.array3f(), 3, tolerance);
+            constScale = constScale && nearlyEqual(scale.array3f(), m_constScale.array3f(), 3, tolerance);
+        }
+
+        // Both q and -q are no rotation at all.
+        Quaternion noRot, noRotNeg = -noRot;
+        Vector noTrans, noScale(1.0f, 1.0f, 1.0f);
+        if(constRot) {
+            bool identity = nearlyEqual(m_constRot.array4f(), noRot.array4f(), 4, tolerance)
+                         || nearlyEqual(m_constRot.array4f(), noRotNeg.array4f(), 4, tolerance);
+            m_rotChannel = identity ? ChannelIdentity : ChannelConstant;
+        }
+        if(constTrans)
+            m_transChannel = nearlyEqual(m_constTrans.array3f(), noTrans.array3f(), 3, tolerance) ? ChannelIdentity : ChannelConstant;
+        if(constScale)
+            m_scaleChannel = nearlyEqual(m_constScale.array3f(), noScale.array3f(), 3, tolerance) ? ChannelIdentity : ChannelConstant;
+
+        return *this;
+    }
+
+    void CoreTrack::keyframesChanged()
+    {
+        m_bRotationsAligned = false;
+        m_rotChannel = m_transChannel = m_scaleChannel = ChannelAnimated;
+    }
+
+    Vector CoreTrack::spline(const Vector& prev, const Vector& from, const Vector& to, const Vector& next,
+                             float tPrev, float tFrom, float tTo, float tNext, float between)
+    {
+        // The tangents of Catmull-Rom, taking the uneven spacing of the
+        // keyframes into account. At the ends, they point to the neighbour.
+        float dt = tTo - tFrom;
+        Vector tanFrom = (to - prev) * (dt / (tTo - tPrev));
+        Vector tanTo = (next - from) * (dt / (tNext - tFrom));
+
+        // The cubic Hermite basis functions.
+        float s2 = between*between;
+        float s3 = s2*between;
+        return from * (2.0f*s3 - 3.0f*s2 + 1.0f)
+             + tanFrom * (s3 - 2.0f*s2 + between)
+             + to * (3.0f*s2 - 2.0f*s3)
+             + tanTo * (s3 - s2);
+    }
+
+    Quaternion CoreTrack::spline(const Quaternion& prev, const Quaternion& from, const Quaternion& to, const Quaternion& next,
+                                 float tPrev, float tFrom, float tTo, float tNext, float between)
+    {
+        // Go the short way, just as the control points do.
+        Quaternion to2 = from.dot(to) < 0.0f ? -to : to;
+        float dt = tTo - tFrom;
+        Quaternion aFrom = Quaternion::squadControl(prev, from, to2, dt / (tTo - tPrev));
+        Quaternion aTo = Quaternion::squadControl(next, to2, from, dt / (tNext - tFrom));
+        return from.squad(aFrom, aTo, to2, between);
+    }
+
     CoreTrack& CoreTrack::updateDuration()
     {
         std::map<float, CoreKeyframePtr>::reverse_iterator i = m_keyframes.rbegin();
@@ -214,11 +397,13 @@ namespace bouge {
 
     CoreTrack::iterator CoreTrack::begin()
     {
+        this->keyframesChanged();
         return iterator(m_keyframes.begin());
     }
 
     CoreTrack::iterator CoreTrack::closest(float time)
     {
+        this->keyframesChanged();
         iterator i(m_keyframes.lower_bound(time));
 
         // i is now either the exact element at time (unlikely), or the next one.
@@ -249,6 +434,7 @@ namespace bouge {
 
     CoreTrack::iterator CoreTrack::after(float time)
     {
+        this->keyframesChanged();
         iterator i(m_keyframes.upper_bound(time));
         return (i == this->end() ? --i : i);
     }
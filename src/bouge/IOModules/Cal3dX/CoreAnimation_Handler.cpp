@@ -138,7 +138,8 @@ namespace bouge {
 
     void CoreAnimation_Cal3dXHandler::trackEnd()
     {
-        // Add the track to the animation's tracklist.
+        // Add the track to the animation's tracklist, ready for fast sampling.
+        m_currTrack->alignRotations().detectConstants();
         m_animsToLoad.back()->track(m_currTrackName, m_currTrack);
 
         // Reset that, as they only keep it for one track.
@@ -42,7 +42,7 @@ namespace bouge {
 
     bool CoreAnimation_XMLHandler::wantsToEnter(const std::string& element)
     {
-        static const std::string accepted[] = {"ANIMATION", "TRACK", "KEYFRAME", "TRANSLATION", "ROTATION", "SCALE", ""};
+        static const std::string accepted[] = {"ANIMATION", "MARKER", "TRACK", "KEYFRAME", "TRANSLATION", "ROTATION", "SCALE", ""};
 
         for(const std::string* i = &accepted[0] ; i->length() > 0 ; ++i) {
             if(element == *i)
@@ -56,6 +56,8 @@ namespace bouge {
     {
         if(element == "ANIMATION") {
             this->animationStart(attributes);
+        } else if(element == "MARKER") {
+            this->markerStart(attributes);
         } else if(element == "TRACK") {
             this->trackStart(attributes);
         } else if(element == "KEYFRAME") {
@@ -117,6 +119,9 @@ namespace bouge {
         }
 
         m_animsToLoad.push_back(CoreAnimationPtr(new CoreAnimation(attributes.getValue("NAME"), control)));
+
+        // The tracks already hold the differences, nothing else to do.
+        m_animsToLoad.back()->additive(attributes.getValueAsBool("ADDITIVE", false));
     }
 
     void CoreAnimation_XMLHandler::animationEnd()
@@ -124,15 +129,25 @@ namespace bouge {
         // Nothing to do here. It already is in the list.
     }
 
+    void CoreAnimation_XMLHandler::markerStart(const XMLAttributes& attributes)
+    {
+        m_animsToLoad.back()->addMarker(attributes.getValueAsFloat("TIME"), attributes.getValue("NAME"));
+    }
+
     void CoreAnimation_XMLHandler::trackStart(const XMLAttributes& attributes)
     {
         m_currTrack = CoreTrackPtr(new CoreTrack());
         m_currTrackName = attributes.getValue("BONE");
+
+        if(attributes.getValueAsString("INTERPOLATION", "linear") == "spline") {
+            m_currTrack->interpolation(CoreTrack::InterpolationSpline);
+        }
     }
 
     void CoreAnimation_XMLHandler::trackEnd()
     {
-        // Add the track to the animation's tracklist.
+        // Add the track to the animation's tracklist, ready for fast sampling.
+        m_currTrack->alignRotations().detectConstants();
         m_animsToLoad.back()->track(m_currTrackName, m_currTrack);
     }
 
@@ -31,11 +31,14 @@
 #include <bouge/CoreMaterialSet.hpp>
 #include <bouge/CoreAnimation.hpp>
 #include <bouge/CoreTrack.hpp>
+#include <bouge/CompressedCoreTrack.hpp>
+#include <bouge/ResampledCoreTrack.hpp>
 #include <bouge/CoreKeyframe.hpp>
 #include <bouge/Math/Util.hpp>
 #include <bouge/Math/TimeFunction.hpp>
 #include <bouge/Util.hpp>
 
+#include <map>
 #include <sstream>
 
 namespace bouge
@@ -83,11 +86,11 @@ namespace bouge
             }
 
             for(std::size_t iFace = 0 ; iFace < iSubMesh->faceCount() ; ++iFace) {
-                Face face = iSubMesh->face(iFace);
+                Span<Uint32> face = iSubMesh->faceIndices(iFace);
 
                 out.openTag("FACE");
 
-                for(std::vector<Face::index_t>::const_iterator iIdx = face.idxs().begin() ; iIdx != face.idxs().end() ; ++iIdx) {
+                for(Span<Uint32>::const_iterator iIdx = face.begin() ; iIdx != face.end() ; ++iIdx) {
                     out.openTag("VERTEXID").text(to_s(*iIdx)).closeTag();
                 }
 
@@ -293,11 +296,38 @@ namespace bouge
             out.attribute("ENDCONTROL", "repeat");
         }
 
+        if(anim->additive()) {
+            out.attribute("ADDITIVE", "true");
+        }
+
+        for(CoreAnimation::const_marker_iterator iMarker = anim->begin_marker() ; iMarker != anim->end_marker() ; ++iMarker) {
+            out.openTag("MARKER")
+                .attribute("NAME", iMarker.name())
+                .attribute("TIME", to_s(iMarker.time()))
+                .closeTag();
+        }
+
+        // The tracks are ordered by the order in which their bone's names were
+        // first seen, which depends on what has been loaded before. Order them
+        // by name so that the same animation always gets saved the same way.
+        std::map<std::string, CoreTrackPtrC> tracks;
         for(CoreAnimation::const_iterator iTrack = anim->begin() ; iTrack != anim->end() ; ++iTrack) {
+            tracks[iTrack.bone().str()] = iTrack.track();
+        }
+
+        for(std::map<std::string, CoreTrackPtrC>::const_iterator iTrack = tracks.begin() ; iTrack != tracks.end() ; ++iTrack) {
+            // Compressed and resampled tracks don't have any keyframes to iterate over.
+            CoreTrackPtrC track = iTrack->second;
+            if(const CompressedCoreTrack* compressed = dynamic_cast<const CompressedCoreTrack*>(track.get()))
+                track = compressed->decompress();
+            else if(const ResampledCoreTrack* resampled = dynamic_cast<const ResampledCoreTrack*>(track.get()))
+                track = resampled->toCoreTrack();
+
             out.openTag("TRACK")
-                .attribute("BONE", iTrack.bone());
+                .attribute("BONE", iTrack->first)
+                .attribute("INTERPOLATION", track->interpolation() == CoreTrack::InterpolationSpline ? "spline" : "linear");
 
-            for(CoreTrack::const_iterator iKeyframe = iTrack->begin() ; iKeyframe != iTrack->end() ; ++iKeyframe) {
+            for(CoreTrack::const_iterator iKeyframe = track->begin() ; iKeyframe != track->end() ; ++iKeyframe) {
                 out.openTag("KEYFRAME")
                     .attribute("TIME", to_s(iKeyframe.time()));
 
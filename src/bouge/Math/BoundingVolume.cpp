@@ -0,0 +1,217 @@
+////////////////////////////////////////////////////////////
+//
+// Bouge - Modern and flexible skeletal animation library
+// Copyright (C) 2010 Lucas Beyer (pompei2@gmail.com)
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it freely,
+// subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+////////////////////////////////////////////////////////////
+#include <bouge/Math/BoundingVolume.hpp>
+#include <bouge/Math/Matrix.hpp>
+#include <bouge/Math/Vector.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+namespace bouge {
+
+/////////////////
+// BoundingBox //
+/////////////////
+
+BoundingBox::BoundingBox()
+{
+    // min > max means empty, and extending it just works.
+    for(int i = 0 ; i < 3 ; ++i) {
+        m_min[i] = 1.0f;
+        m_max[i] = -1.0f;
+    }
+}
+
+BoundingBox::BoundingBox(const Vector& in_min, const Vector& in_max)
+{
+    for(int i = 0 ; i < 3 ; ++i) {
+        m_min[i] = in_min.array3f()[i];
+        m_max[i] = in_max.array3f()[i];
+    }
+}
+
+bool BoundingBox::empty() const
+{
+    return m_min[0] > m_max[0];
+}
+
+Vector BoundingBox::minCorner() const
+{
+    return Vector(m_min);
+}
+
+Vector BoundingBox::maxCorner() const
+{
+    return Vector(m_max);
+}
+
+Vector BoundingBox::center() const
+{
+    return Vector(0.5f*(m_min[0] + m_max[0]), 0.5f*(m_min[1] + m_max[1]), 0.5f*(m_min[2] + m_max[2]));
+}
+
+Vector BoundingBox::halfExtents() const
+{
+    if(this->empty())
+        return Vector(0.0f, 0.0f, 0.0f);
+
+    return Vector(0.5f*(m_max[0] - m_min[0]), 0.5f*(m_max[1] - m_min[1]), 0.5f*(m_max[2] - m_min[2]));
+}
+
+BoundingBox& BoundingBox::extend(const float in_p[3])
+{
+    if(this->empty()) {
+        for(int i = 0 ; i < 3 ; ++i) {
+            m_min[i] = m_max[i] = in_p[i];
+        }
+        return *this;
+    }
+
+    for(int i = 0 ; i < 3 ; ++i) {
+        m_min[i] = std::min(m_min[i], in_p[i]);
+        m_max[i] = std::max(m_max[i], in_p[i]);
+    }
+    return *this;
+}
+
+BoundingBox& BoundingBox::extend(const Vector& in_v)
+{
+    return this->extend(in_v.array3f());
+}
+
+BoundingBox& BoundingBox::extend(const BoundingBox& in_box)
+{
+    if(in_box.empty())
+        return *this;
+
+    this->extend(in_box.m_min);
+    return this->extend(in_box.m_max);
+}
+
+BoundingBox BoundingBox::transformed(const Base4x4Matrix& in_m) const
+{
+    if(this->empty())
+        return *this;
+
+    // Transform the center and project the half extents onto the new axes,
+    // which is much cheaper than transforming all eight corners.
+    const float* m = in_m.array16f();
+    BoundingBox ret;
+    for(int r = 0 ; r < 3 ; ++r) {
+        float c = m[12+r];
+        float e = 0.0f;
+        for(int k = 0 ; k < 3 ; ++k) {
+            c += m[4*k+r] * 0.5f*(m_min[k] + m_max[k]);
+            e += std::fabs(m[4*k+r]) * 0.5f*(m_max[k] - m_min[k]);
+        }
+        ret.m_min[r] = c - e;
+        ret.m_max[r] = c + e;
+    }
+    return ret;
+}
+
+std::string BoundingBox::to_s(unsigned int in_iDecimalPlaces) const
+{
+    if(this->empty())
+        return "(empty)";
+
+    return "[" + this->minCorner().to_s(in_iDecimalPlaces) + " - " + this->maxCorner().to_s(in_iDecimalPlaces) + "]";
+}
+
+////////////////////
+// BoundingSphere //
+////////////////////
+
+BoundingSphere::BoundingSphere()
+    : m_radius(-1.0f)
+{
+    m_center[0] = m_center[1] = m_center[2] = 0.0f;
+}
+
+BoundingSphere::BoundingSphere(const Vector& in_center, float in_fRadius)
+    : m_radius(in_fRadius)
+{
+    for(int i = 0 ; i < 3 ; ++i) {
+        m_center[i] = in_center.array3f()[i];
+    }
+}
+
+bool BoundingSphere::empty() const
+{
+    return m_radius < 0.0f;
+}
+
+Vector BoundingSphere::center() const
+{
+    return Vector(m_center);
+}
+
+float BoundingSphere::radius() const
+{
+    return m_radius;
+}
+
+BoundingSphere BoundingSphere::transformed(const Base4x4Matrix& in_m) const
+{
+    if(this->empty())
+        return *this;
+
+    const float* m = in_m.array16f();
+    BoundingSphere ret;
+    for(int r = 0 ; r < 3 ; ++r) {
+        ret.m_center[r] = m[4*0+r]*m_center[0] + m[4*1+r]*m_center[1] + m[4*2+r]*m_center[2] + m[12+r];
+    }
+
+    // The biggest scaling factor is the square root of the biggest eigenvalue
+    // of M^T M, the dot products of M's columns. We bound that eigenvalue by
+    // the biggest absolute row sum (Gershgorin), which is exact as long as the
+    // columns are orthogonal (rotations and scales) and too big under shear.
+    float dots[3][3];
+    for(int i = 0 ; i < 3 ; ++i) {
+        for(int j = 0 ; j < 3 ; ++j) {
+            dots[i][j] = m[4*i]*m[4*j] + m[4*i+1]*m[4*j+1] + m[4*i+2]*m[4*j+2];
+        }
+    }
+
+    float maxScale2 = 0.0f;
+    for(int i = 0 ; i < 3 ; ++i) {
+        maxScale2 = std::max(maxScale2, std::abs(dots[i][0]) + std::abs(dots[i][1]) + std::abs(dots[i][2]));
+    }
+    ret.m_radius = m_radius * std::sqrt(maxScale2);
+    return ret;
+}
+
+std::string BoundingSphere::to_s(unsigned int in_iDecimalPlaces) const
+{
+    if(this->empty())
+        return "(empty)";
+
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(in_iDecimalPlaces) << m_radius;
+    return "(" + this->center().to_s(in_iDecimalPlaces) + ", r=" + ss.str() + ")";
+}
+
+} // namespace bouge
@@ -0,0 +1,195 @@
+////////////////////////////////////////////////////////////
+//
+// Bouge - Modern and flexible skeletal animation library
+// Copyright (C) 2010 Lucas Beyer (pompei2@gmail.com)
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it freely,
+// subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+////////////////////////////////////////////////////////////
+#include <bouge/Math/DualQuaternion.hpp>
+#include <bouge/Math/Quaternion.hpp>
+#include <bouge/Math/Vector.hpp>
+
+#include <sstream>
+#include <iomanip>
+#include <cmath>
+
+namespace bouge {
+
+////////////////////////////////////////////
+// Constructors and assignment operators. //
+////////////////////////////////////////////
+
+DualQuaternion::DualQuaternion()
+{
+    m_dq[0] = 0.0f; m_dq[1] = 0.0f; m_dq[2] = 0.0f; m_dq[3] = 1.0f;
+    m_dq[4] = 0.0f; m_dq[5] = 0.0f; m_dq[6] = 0.0f; m_dq[7] = 0.0f;
+}
+
+DualQuaternion::DualQuaternion(const float in_dq[8])
+{
+    for(int i = 0 ; i < 8 ; ++i) {
+        m_dq[i] = in_dq[i];
+    }
+}
+
+DualQuaternion::DualQuaternion(const Quaternion& in_rot, const Vector& in_trans)
+{
+    const float* r = in_rot.array4f();
+    m_dq[0] = r[0]; m_dq[1] = r[1]; m_dq[2] = r[2]; m_dq[3] = r[3];
+
+    // The dual part is 0.5 * (t, 0) * r
+    float tx = 0.5f*in_trans.x(), ty = 0.5f*in_trans.y(), tz = 0.5f*in_trans.z();
+    m_dq[4] =  tx*r[3] + ty*r[2] - tz*r[1];
+    m_dq[5] = -tx*r[2] + ty*r[3] + tz*r[0];
+    m_dq[6] =  tx*r[1] - ty*r[0] + tz*r[3];
+    m_dq[7] = -tx*r[0] - ty*r[1] - tz*r[2];
+}
+
+///////////////////////////////////////
+// Conversion methods and operators. //
+///////////////////////////////////////
+
+std::string DualQuaternion::to_s(unsigned int in_iDecimalPlaces) const
+{
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(in_iDecimalPlaces)
+       << "(" << m_dq[0] << ", " << m_dq[1] << ", " << m_dq[2] << ", " << m_dq[3] << ")"
+       << " + e(" << m_dq[4] << ", " << m_dq[5] << ", " << m_dq[6] << ", " << m_dq[7] << ")";
+    return ss.str();
+}
+
+Quaternion DualQuaternion::real() const
+{
+    return Quaternion(m_dq[0], m_dq[1], m_dq[2], m_dq[3]);
+}
+
+Quaternion DualQuaternion::dual() const
+{
+    return Quaternion(m_dq[4], m_dq[5], m_dq[6], m_dq[7]);
+}
+
+Vector DualQuaternion::translation() const
+{
+    // t = 2 * dual * conjugate(real)
+    const float* r = &m_dq[0];
+    const float* d = &m_dq[4];
+    return Vector(2.0f*(-d[3]*r[0] + d[0]*r[3] - d[1]*r[2] + d[2]*r[1]),
+                  2.0f*(-d[3]*r[1] + d[1]*r[3] - d[2]*r[0] + d[0]*r[2]),
+                  2.0f*(-d[3]*r[2] + d[2]*r[3] - d[0]*r[1] + d[1]*r[0]));
+}
+
+///////////////////////////////////////////
+// Basic dual quaternion calculations.   //
+///////////////////////////////////////////
+
+DualQuaternion DualQuaternion::operator +(const DualQuaternion& in_dq) const
+{
+    DualQuaternion ret(*this);
+    ret += in_dq;
+    return ret;
+}
+
+void DualQuaternion::operator +=(const DualQuaternion& in_dq)
+{
+    for(int i = 0 ; i < 8 ; ++i) {
+        m_dq[i] += in_dq.m_dq[i];
+    }
+}
+
+DualQuaternion DualQuaternion::operator *(float in_f) const
+{
+    DualQuaternion ret(*this);
+    for(int i = 0 ; i < 8 ; ++i) {
+        ret.m_dq[i] *= in_f;
+    }
+    return ret;
+}
+
+/// \internal Multiplies the quaternions \a a and \a b (x, y, z, w) and adds the result to \a out.
+static void addQuatProduct(const float* a, const float* b, float* out)
+{
+    out[0] += a[3]*b[0] + a[0]*b[3] + a[1]*b[2] - a[2]*b[1];
+    out[1] += a[3]*b[1] + a[1]*b[3] + a[2]*b[0] - a[0]*b[2];
+    out[2] += a[3]*b[2] + a[2]*b[3] + a[0]*b[1] - a[1]*b[0];
+    out[3] += a[3]*b[3] - a[0]*b[0] - a[1]*b[1] - a[2]*b[2];
+}
+
+DualQuaternion DualQuaternion::operator *(const DualQuaternion& in_dq) const
+{
+    // (r1 + e d1) (r2 + e d2) = r1 r2 + e (r1 d2 + d1 r2)
+    float res[8] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+    addQuatProduct(&m_dq[0], &in_dq.m_dq[0], &res[0]);
+    addQuatProduct(&m_dq[0], &in_dq.m_dq[4], &res[4]);
+    addQuatProduct(&m_dq[4], &in_dq.m_dq[0], &res[4]);
+    return DualQuaternion(res);
+}
+
+float DualQuaternion::dotReal(const DualQuaternion& in_dq) const
+{
+    return m_dq[0]*in_dq.m_dq[0] + m_dq[1]*in_dq.m_dq[1] + m_dq[2]*in_dq.m_dq[2] + m_dq[3]*in_dq.m_dq[3];
+}
+
+DualQuaternion& DualQuaternion::normalize()
+{
+    float len = std::sqrt(this->dotReal(*this));
+    if(len <= 0.0f)
+        return *this;
+
+    // Divide both parts by the length of the real part, then remove the
+    // component of the dual part parallel to the real one, so that it stays
+    // a rigid transformation.
+    float inv = 1.0f / len;
+    for(int i = 0 ; i < 8 ; ++i) {
+        m_dq[i] *= inv;
+    }
+
+    float d = m_dq[0]*m_dq[4] + m_dq[1]*m_dq[5] + m_dq[2]*m_dq[6] + m_dq[3]*m_dq[7];
+    for(int i = 0 ; i < 4 ; ++i) {
+        m_dq[4+i] -= d*m_dq[i];
+    }
+
+    return *this;
+}
+
+DualQuaternion DualQuaternion::normalized() const
+{
+    DualQuaternion ret(*this);
+    return ret.normalize();
+}
+
+Vector DualQuaternion::rotate(const Vector& in_v) const
+{
+    // v + 2 r.xyz x (r.xyz x v + r.w v)
+    const float* r = &m_dq[0];
+    float cx = r[1]*in_v.z() - r[2]*in_v.y() + r[3]*in_v.x();
+    float cy = r[2]*in_v.x() - r[0]*in_v.z() + r[3]*in_v.y();
+    float cz = r[0]*in_v.y() - r[1]*in_v.x() + r[3]*in_v.z();
+    return Vector(in_v.x() + 2.0f*(r[1]*cz - r[2]*cy),
+                  in_v.y() + 2.0f*(r[2]*cx - r[0]*cz),
+                  in_v.z() + 2.0f*(r[0]*cy - r[1]*cx));
+}
+
+Vector DualQuaternion::transform(const Vector& in_v) const
+{
+    Vector rotated = this->rotate(in_v);
+    Vector t = this->translation();
+    return Vector(rotated.x() + t.x(), rotated.y() + t.y(), rotated.z() + t.z());
+}
+
+} // namespace bouge
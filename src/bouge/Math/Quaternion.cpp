@@ -137,6 +137,26 @@ float Quaternion::angle() const
     return 2.0f*acos(this->w());
 }
 
+float Quaternion::angleTo(const Quaternion& in_q) const
+{
+    // The angle between the two unit 4D vectors, taken as 2*atan2(|a-b|, |a+b|)
+    // as the acos of their dot product is useless close to 1. q and -q being
+    // the same rotation, flip one into the same hemisphere as the other.
+    float lenA = this->len();
+    float lenB = in_q.len();
+    float sign = this->dot(in_q) < 0.0f ? -1.0f : 1.0f;
+    float diff = 0.0f, sum = 0.0f;
+    for(int i = 0 ; i < 4 ; ++i) {
+        float a = m_q[i] / lenA;
+        float b = sign * in_q.m_q[i] / lenB;
+        diff += (a - b)*(a - b);
+        sum += (a + b)*(a + b);
+    }
+
+    // The rotation angle is twice the angle between the quaternions.
+    return 4.0f*atan2(sqrt(diff), sqrt(sum));
+}
+
 /////////////////////////////////////
 // Accessors, getters and setters. //
 /////////////////////////////////////
@@ -352,6 +372,58 @@ Quaternion Quaternion::slerp(const Quaternion& q2, float between) const
     return ((*this)*w1 + q2*w2).normalize();
 }
 
+Quaternion Quaternion::fastSlerp(const Quaternion& q2, float between) const
+{
+    // nlerp is too slow in the middle and too fast at the ends, the more so
+    // the farther apart the quaternions are. Warp the time with a polynomial
+    // fitted to make up for that, see http://zeux.io/2015/07/23/approximating-slerp/
+    float d = this->dot(q2);
+    float a = 1.0904f + d * (-3.2452f + d * (3.55645f - d * 1.43519f));
+    float b = 0.848013f + d * (-1.06021f + d * 0.215638f);
+    float k = a * (between - 0.5f) * (between - 0.5f) + b;
+    return this->nlerp(q2, between + between * (between - 0.5f) * (between - 1.0f) * k);
+}
+
+Quaternion Quaternion::squad(const Quaternion& a1, const Quaternion& a2, const Quaternion& q2, float between) const
+{
+    return this->slerp(q2, between).slerp(a1.slerp(a2, between), 2.0f*between*(1.0f - between));
+}
+
+Quaternion Quaternion::squadControl(const Quaternion& prev, const Quaternion& q, const Quaternion& next, float towardsNext)
+{
+    // Take the neighbours from the same hemisphere as q, as -p is the same
+    // rotation as p but would make the curve take the long way around.
+    Quaternion qInv = q.inv();
+    Quaternion logPrev = (qInv * (q.dot(prev) < 0.0f ? -prev : prev)).log();
+    Quaternion logNext = (qInv * (q.dot(next) < 0.0f ? -next : next)).log();
+
+    // The tangent at q, as in Catmull-Rom, scaled to the part towards next.
+    // When evenly spaced, this is the well-known -(logPrev + logNext)/4.
+    Quaternion tangent = (logNext - logPrev) * towardsNext;
+    return q * ((tangent - logNext) * 0.5f).exp();
+}
+
+Quaternion Quaternion::log() const
+{
+    float sinHalf = sqrt(this->x()*this->x() + this->y()*this->y() + this->z()*this->z());
+    // For tiny angles, sin(x) is x.
+    if(nearZero(sinHalf))
+        return Quaternion(this->x(), this->y(), this->z(), 0.0f);
+
+    float half = atan2(sinHalf, this->w());
+    return Quaternion(this->x()*half/sinHalf, this->y()*half/sinHalf, this->z()*half/sinHalf, 0.0f);
+}
+
+Quaternion Quaternion::exp() const
+{
+    float half = sqrt(this->x()*this->x() + this->y()*this->y() + this->z()*this->z());
+    if(nearZero(half))
+        return Quaternion(this->x(), this->y(), this->z(), cos(half));
+
+    float s = sin(half)/half;
+    return Quaternion(this->x()*s, this->y()*s, this->z()*s, cos(half));
+}
+
 ///////////////////////////////////////
 // Quaternion comparison operations. //
 ///////////////////////////////////////
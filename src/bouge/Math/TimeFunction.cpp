@@ -80,6 +80,18 @@ namespace bouge {
         return (*m_tf)(fractional);
     }
 
+    float RepeatTF::before(float t)
+    {
+        // Right before restarting, it is at the very end.
+        float fractional = t - (float)((int)t);
+        return fractional == 0.0f && t > 0.0f ? m_tf->before(1.0f) : m_tf->before(fractional);
+    }
+
+    float RepeatTF::after(float t)
+    {
+        return m_tf->after(t - (float)((int)t));
+    }
+
     RepeatTF* RepeatTF::clone() const
     {
         return new RepeatTF(this->tf()->clone());
@@ -106,6 +118,26 @@ namespace bouge {
         return fwd ? (*m_tf)(fractional) : (*m_tf)(1.0f-fractional);
     }
 
+    float CycleTF::before(float t)
+    {
+        // Right before turning around, it is at the end of the previous piece.
+        float fractional = t - (float)((int)t);
+        if(fractional == 0.0f && t > 0.0f) {
+            bool prevFwd = ((int)t - 1) % 2 == 0;
+            return prevFwd ? m_tf->before(1.0f) : m_tf->after(0.0f);
+        }
+
+        bool fwd = (int)t % 2 == 0;
+        return fwd ? m_tf->before(fractional) : m_tf->after(1.0f-fractional);
+    }
+
+    float CycleTF::after(float t)
+    {
+        bool fwd = (int)t % 2 == 0;
+        float fractional = t - (float)((int)t);
+        return fwd ? m_tf->after(fractional) : m_tf->before(1.0f-fractional);
+    }
+
     CycleTF* CycleTF::clone() const
     {
         return new CycleTF(this->tf()->clone());
@@ -134,6 +166,16 @@ namespace bouge {
             return (*m_tf)(m_valueFrom);
     }
 
+    float HoldTF::before(float t)
+    {
+        return t <= 1.0f ? m_tf->before(t) : (*m_tf)(m_valueFrom);
+    }
+
+    float HoldTF::after(float t)
+    {
+        return t < 1.0f ? m_tf->after(t) : (*m_tf)(m_valueFrom);
+    }
+
     HoldTF* HoldTF::clone() const
     {
         return new HoldTF(this->tf()->clone(), this->valueFrom());
@@ -27,14 +27,19 @@
 #include <bouge/CoreAnimation.hpp>
 #include <bouge/CoreTrack.hpp>
 #include <bouge/BoneInstance.hpp>
+#include <bouge/BoneMask.hpp>
+#include <bouge/CoreBone.hpp>
 #include <bouge/Math/Util.hpp>
 #include <bouge/Math/TimeFunction.hpp>
 
+#include <stdexcept>
+
 namespace bouge {
 
     Mixer::Mixer()
         : m_speed(1.0f)
         , m_paused(false)
+        , m_events(0)
     { }
 
     Mixer::~Mixer()
@@ -73,6 +78,17 @@ namespace bouge {
     void Mixer::onSpeedChanged(float, float)
     { }
 
+    AnimationEvents* Mixer::events() const
+    {
+        return m_events;
+    }
+
+    Mixer& Mixer::events(AnimationEvents* events)
+    {
+        m_events = events;
+        return *this;
+    }
+
     AnimationPtr DummyMixer::play(AnimationPtr anim)
     {
         return AnimationPtr(new Animation(CoreAnimationPtrC(new CoreAnimation("Dummy"))));
@@ -83,6 +99,11 @@ namespace bouge {
         return AnimationPtr(new Animation(CoreAnimationPtrC(new CoreAnimation("Dummy"))));
     }
 
+    AnimationPtr DummyMixer::additive(AnimationPtr anim)
+    {
+        return AnimationPtr(new Animation(CoreAnimationPtrC(new CoreAnimation("Dummy"))));
+    }
+
     DefaultMixer::DefaultMixer(SkeletonInstancePtr skel)
         : m_skel(skel)
     { }
@@ -102,6 +123,17 @@ namespace bouge {
         return anim;
     }
 
+    AnimationPtr DefaultMixer::additive(AnimationPtr anim)
+    {
+        // A full pose on top of the blend would move everything twice as far.
+        if(!anim->core()->additive())
+            throw std::invalid_argument("Can't play the animation '" + anim->name() + "' additively, as it isn't additive; see CoreAnimation::makeAdditive");
+
+        // They get applied in the order they were added.
+        m_additiveAnims.push_back(anim);
+        return anim;
+    }
+
     DefaultMixer& DefaultMixer::stop(AnimationPtr anim, float fadeOutTime)
     {
         // TODO: Verify this one!
@@ -115,7 +147,7 @@ namespace bouge {
         return *this;
     }
 
-    DefaultMixer& DefaultMixer::stop(const std::string& animName, float fadeOutTime)
+    DefaultMixer& DefaultMixer::stop(const Name& animName, float fadeOutTime)
     {
         for(std::set<AnimationPtr>::iterator i = m_cyclingAnims.begin() ; i != m_cyclingAnims.end() ; ++i) {
             if((*i)->name() == animName) {
@@ -127,10 +159,15 @@ namespace bouge {
                 this->stop(*i, fadeOutTime);
             }
         }
+        for(std::list<AnimationPtr>::iterator i = m_additiveAnims.begin() ; i != m_additiveAnims.end() ; ++i) {
+            if((*i)->name() == animName) {
+                this->stop(*i, fadeOutTime);
+            }
+        }
         return *this;
     }
 
-    DefaultMixer& DefaultMixer::pause(const std::string& animName)
+    DefaultMixer& DefaultMixer::pause(const Name& animName)
     {
         for(std::set<AnimationPtr>::iterator i = m_cyclingAnims.begin() ; i != m_cyclingAnims.end() ; ++i) {
             if((*i)->name() == animName) {
@@ -144,10 +181,16 @@ namespace bouge {
                 break;
             }
         }
+        for(std::list<AnimationPtr>::iterator i = m_additiveAnims.begin() ; i != m_additiveAnims.end() ; ++i) {
+            if((*i)->name() == animName) {
+                (*i)->pause();
+                break;
+            }
+        }
         return *this;
     }
 
-    DefaultMixer& DefaultMixer::resume(const std::string& animName)
+    DefaultMixer& DefaultMixer::resume(const Name& animName)
     {
         for(std::set<AnimationPtr>::iterator i = m_cyclingAnims.begin() ; i != m_cyclingAnims.end() ; ++i) {
             if((*i)->name() == animName) {
@@ -161,10 +204,16 @@ namespace bouge {
                 break;
             }
         }
+        for(std::list<AnimationPtr>::iterator i = m_additiveAnims.begin() ; i != m_additiveAnims.end() ; ++i) {
+            if((*i)->name() == animName) {
+                (*i)->resume();
+                break;
+            }
+        }
         return *this;
     }
 
-    bool DefaultMixer::paused(const std::string& animName) const
+    bool DefaultMixer::paused(const Name& animName) const
     {
         for(std::set<AnimationPtr>::const_iterator i = m_cyclingAnims.begin() ; i != m_cyclingAnims.end() ; ++i) {
             if((*i)->name() == animName) {
@@ -176,6 +225,11 @@ namespace bouge {
                 return (*i)->paused();
             }
         }
+        for(std::list<AnimationPtr>::const_iterator i = m_additiveAnims.begin() ; i != m_additiveAnims.end() ; ++i) {
+            if((*i)->name() == animName) {
+                return (*i)->paused();
+            }
+        }
         return false;
     }
 
@@ -188,6 +242,9 @@ namespace bouge {
         for(std::list<AnimationPtr>::iterator i = m_oneshotAnims.begin() ; i != m_oneshotAnims.end() ; ++i) {
             (*i)->pause();
         }
+        for(std::list<AnimationPtr>::iterator i = m_additiveAnims.begin() ; i != m_additiveAnims.end() ; ++i) {
+            (*i)->pause();
+        }
         return *this;
     }
 
@@ -200,6 +257,9 @@ namespace bouge {
         for(std::list<AnimationPtr>::iterator i = m_oneshotAnims.begin() ; i != m_oneshotAnims.end() ; ++i) {
             (*i)->resume();
         }
+        for(std::list<AnimationPtr>::iterator i = m_additiveAnims.begin() ; i != m_additiveAnims.end() ; ++i) {
+            (*i)->resume();
+        }
         return *this;
     }
 
@@ -212,10 +272,13 @@ namespace bouge {
         for(std::list<AnimationPtr>::iterator i = m_oneshotAnims.begin() ; i != m_oneshotAnims.end() ; ++i) {
             this->stop(*i, fadeOutTime);
         }
+        for(std::list<AnimationPtr>::iterator i = m_additiveAnims.begin() ; i != m_additiveAnims.end() ; ++i) {
+            this->stop(*i, fadeOutTime);
+        }
         return *this;
     }
 
-    float DefaultMixer::speed(const std::string& animName) const
+    float DefaultMixer::speed(const Name& animName) const
     {
         for(std::set<AnimationPtr>::const_iterator i = m_cyclingAnims.begin() ; i != m_cyclingAnims.end() ; ++i) {
             if((*i)->name() == animName)
@@ -225,11 +288,15 @@ namespace bouge {
             if((*i)->name() == animName)
                 return (*i)->speed();
         }
+        for(std::list<AnimationPtr>::const_iterator i = m_additiveAnims.begin() ; i != m_additiveAnims.end() ; ++i) {
+            if((*i)->name() == animName)
+                return (*i)->speed();
+        }
 
         return 1.0f;
     }
 
-    DefaultMixer& DefaultMixer::speed(const std::string& animName, float speed)
+    DefaultMixer& DefaultMixer::speed(const Name& animName, float speed)
     {
         for(std::set<AnimationPtr>::iterator i = m_cyclingAnims.begin() ; i != m_cyclingAnims.end() ; ++i) {
             if((*i)->name() == animName)
@@ -239,6 +306,10 @@ namespace bouge {
             if((*i)->name() == animName)
                 (*i)->speed(speed);
         }
+        for(std::list<AnimationPtr>::iterator i = m_additiveAnims.begin() ; i != m_additiveAnims.end() ; ++i) {
+            if((*i)->name() == animName)
+                (*i)->speed(speed);
+        }
 
         return *this;
     }
@@ -266,6 +337,13 @@ namespace bouge {
                     break; // <- needed because of ++i.
                 }
             }
+            for(std::list<AnimationPtr>::iterator i = m_additiveAnims.begin() ; !bGotIt && i != m_additiveAnims.end() ; ++i) {
+                if(*i == *iToStop) {
+                    m_additiveAnims.erase(i);
+                    bGotIt = true;
+                    break; // <- needed because of ++i.
+                }
+            }
 
             // Remove it from the set. (This works.)
             m_scheduledStop.erase(iToStop++);
@@ -308,13 +386,13 @@ namespace bouge {
         // by the "walk", while when it's at 1, the arm should be fully controlled
         // by the "wave" animation.
 
-        std::map<std::string, ZeroFloat> bonesOneShot;
+        std::map<Name, ZeroFloat> bonesOneShot;
 
         // We first apply the one-shot animations following the 'last added overrides' principle.
         // We do this first as it might save us from updating some bones below.
         for(std::list<AnimationPtr>::iterator iAnim = m_oneshotAnims.begin() ; iAnim != m_oneshotAnims.end() ; ++iAnim) {
             AnimationPtr anim = *iAnim;
-            anim->update(deltaTime);
+            anim->update(deltaTime, Mixer::events());
 
             float t = anim->timeAbsolute();
             float w = anim->weight();
@@ -326,32 +404,45 @@ namespace bouge {
             if(nearZero(w))
                 continue;
 
+            BoneMaskPtrC mask = anim->mask();
             for(CoreAnimation::const_iterator iTrack = anim->core()->begin() ; iTrack != anim->core()->end() ; ++iTrack) {
-                bonesOneShot[iTrack.bone()] += w;
-
                 BoneInstancePtr bone = m_skel->bone(iTrack.bone());
+                float boneW = mask ? w * mask->weight(bone->core()->id()) : w;
+                if(nearZero(boneW))
+                    continue;
+
+                bonesOneShot[iTrack.bone()] += boneW;
+
+                // Still overrides the cycles, but leaves the bone as it is.
+                if(!iTrack->hasRotation() && !iTrack->hasTranslation() && !iTrack->hasScale())
+                    continue;
+
                 if(iTrack->hasRotation()) {
-                    bone->rot(bone->rot() * Quaternion().nlerp(iTrack->rotation(t), w));
+                    bone->rot(bone->rot() * Quaternion().nlerp(iTrack->rotation(t), boneW));
                 }
                 if(iTrack->hasTranslation()) {
-                    bone->trans(bone->trans() + Vector().lerp(iTrack->translation(t), w));
+                    bone->trans(bone->trans() + Vector().lerp(iTrack->translation(t), boneW));
                 }
                 if(iTrack->hasScale()) {
-                    bone->scale(bone->scale() * Vector(1.0f, 1.0f, 1.0f).lerp(iTrack->scale(t), w));
+                    bone->scale(bone->scale() * Vector(1.0f, 1.0f, 1.0f).lerp(iTrack->scale(t), boneW));
                 }
             }
         }
 
         // And then, first prepare the "usual" animations, that get blended together.
-        std::map<std::string, ZeroFloat> totalWeightPerBone;
+        std::map<Name, ZeroFloat> totalWeightPerBone;
         for(std::set<AnimationPtr>::iterator iAnim = m_cyclingAnims.begin() ; iAnim != m_cyclingAnims.end() ; ++iAnim) {
             AnimationPtr anim = *iAnim;
-            anim->update(deltaTime);
+            anim->update(deltaTime, Mixer::events());
 
             // We need the total of the weights first in order to normalize them later.
             float w = anim->weight();
+            BoneMaskPtrC mask = anim->mask();
             for(CoreAnimation::const_iterator iTrack = anim->core()->begin() ; iTrack != anim->core()->end() ; ++iTrack) {
-                totalWeightPerBone[iTrack.bone()] += w;
+                if(mask)
+                    totalWeightPerBone[iTrack.bone()] += w * mask->weight(m_skel->bone(iTrack.bone())->core()->id());
+                else
+                    totalWeightPerBone[iTrack.bone()] += w;
             }
         }
 
@@ -364,6 +455,7 @@ namespace bouge {
             if(nearZero(animW))
                 continue;
 
+            BoneMaskPtrC mask = anim->mask();
             for(CoreAnimation::const_iterator iTrack = anim->core()->begin() ; iTrack != anim->core()->end() ; ++iTrack) {
                 // Use per-bone weights so that only bones used by both (or more) cycling
                 // animations get blended, while those being used by say just one
@@ -394,13 +486,23 @@ namespace bouge {
                 // This is because of the "totalWeightPerBone", which normalizes.
                 // But we only want to normalize in case the weight sums to more
                 // than one.
+                // A mask just lowers the weight of the bones, also for the
+                // normalization above.
+                BoneInstancePtr bone = m_skel->bone(iTrack.bone());
+                float maskW = mask ? mask->weight(bone->core()->id()) : 1.0f;
                 float tot = totalWeightPerBone[iTrack.bone()];
-                float boneW = (tot <= 1.0f ? animW : animW / tot);
+                float boneW = (tot <= 1.0f ? animW * maskW : animW * maskW / tot);
 
                 // Regarding this one, read the big comment above the one-shot action loop above.
                 boneW *= 1.0f - bonesOneShot[iTrack.bone()];
 
-                BoneInstancePtr bone = m_skel->bone(iTrack.bone());
+                // Masked out or overridden by one-shots, don't even sample it.
+                if(nearZero(boneW))
+                    continue;
+
+                if(!iTrack->hasRotation() && !iTrack->hasTranslation() && !iTrack->hasScale())
+                    continue;
+
                 if(iTrack->hasRotation()) {
                     // Here, nlerp is fine (and fast), because w should't ever go above 1.0!
                     bone->rot(bone->rot() * Quaternion().nlerp(iTrack->rotation(t), boneW));
@@ -414,6 +516,43 @@ namespace bouge {
             }
         }
 
+        // The additive animations go on top of whatever the above made of the
+        // bones, each one as strong as its weight, without any normalization.
+        for(std::list<AnimationPtr>::iterator iAnim = m_additiveAnims.begin() ; iAnim != m_additiveAnims.end() ; ++iAnim) {
+            AnimationPtr anim = *iAnim;
+            anim->update(deltaTime, Mixer::events());
+
+            float t = anim->timeAbsolute();
+            float w = anim->weight();
+
+            if(anim->hasEnded())
+                m_scheduledStop.insert(anim);
+
+            if(nearZero(w))
+                continue;
+
+            BoneMaskPtrC mask = anim->mask();
+            for(CoreAnimation::const_iterator iTrack = anim->core()->begin() ; iTrack != anim->core()->end() ; ++iTrack) {
+                if(!iTrack->hasRotation() && !iTrack->hasTranslation() && !iTrack->hasScale())
+                    continue;
+
+                BoneInstancePtr bone = m_skel->bone(iTrack.bone());
+                float boneW = mask ? w * mask->weight(bone->core()->id()) : w;
+                if(nearZero(boneW))
+                    continue;
+
+                if(iTrack->hasRotation()) {
+                    bone->rot(bone->rot() * Quaternion().nlerp(iTrack->rotation(t), boneW));
+                }
+                if(iTrack->hasTranslation()) {
+                    bone->trans(bone->trans() + Vector().lerp(iTrack->translation(t), boneW));
+                }
+                if(iTrack->hasScale()) {
+                    bone->scale(bone->scale() * Vector(1.0f, 1.0f, 1.0f).lerp(iTrack->scale(t), boneW));
+                }
+            }
+        }
+
         // Finally, let all the bones update their matrices.
         m_skel->recalcAllBones();
     }
@@ -30,8 +30,29 @@
 #include <bouge/CoreAnimation.hpp>
 #include <bouge/Math/Util.hpp>
 
+#include <stdexcept>
+
 namespace bouge {
 
+    /// \internal Looks the animation name \a anim up without adding it to the
+    /// name table, so that asking for unknown animations doesn't grow it.
+    /// \return Whether any animation could be named \a anim.
+    static bool findName(const std::string& anim, Name& name)
+    {
+        name = Name::find(anim);
+        return !name.empty() || anim.empty();
+    }
+
+    /// \internal Same as findName, for when the animation has to exist.
+    /// \exception std::invalid_argument if \a anim can't name any animation.
+    static Name existingName(const std::string& anim, CoreModelPtrC mdl)
+    {
+        Name name;
+        if(!findName(anim, name))
+            throw std::invalid_argument("There is no animation " + anim + " in the model " + mdl->name());
+        return name;
+    }
+
     ModelInstance::ModelInstance(CoreModelPtrC coremdl)
         : m_coremdl(coremdl)
         , m_skel(coremdl->skeleton() ? new SkeletonInstance(coremdl->skeleton()) : 0)
@@ -94,7 +115,7 @@ namespace bouge {
 
     AnimationPtr ModelInstance::playCycle(const std::string anim, float speed, float fadeInTime, float weight, TimeFunction* control)
     {
-        CoreAnimationPtrC coreAnim = this->findAnimToUse(anim);
+        CoreAnimationPtrC coreAnim = this->findAnimToUse(existingName(anim, m_coremdl));
 
         if(nearZero(coreAnim->duration())) {
             return m_mixer->play(AnimationPtr(new Animation(coreAnim, speed)));
@@ -108,7 +129,7 @@ namespace bouge {
 
     AnimationPtr ModelInstance::playOneShot(const std::string anim, float speed, float fadeInTime, float fadeOutTime, TimeFunction* control)
     {
-        CoreAnimationPtrC coreAnim = this->findAnimToUse(anim);
+        CoreAnimationPtrC coreAnim = this->findAnimToUse(existingName(anim, m_coremdl));
 
         if(nearZero(coreAnim->duration())) {
             return m_mixer->oneshot(AnimationPtr(new Animation(coreAnim, speed)));
@@ -116,12 +137,27 @@ namespace bouge {
 
         // Note: same as in playCycle.
         TimeFunction* pWeightFun = new FadeOutTF(fadeOutTime/coreAnim->duration(), new FadeInTF(fadeInTime/coreAnim->duration(), new ConstantTF(1.0f)));
-        return m_mixer->oneshot(AnimationPtr(new Animation(m_coremdl->animation(anim), speed, control, pWeightFun)));
+        return m_mixer->oneshot(AnimationPtr(new Animation(m_coremdl->animation(coreAnim->name()), speed, control, pWeightFun)));
+    }
+
+    AnimationPtr ModelInstance::playAdditive(const std::string anim, float speed, float fadeInTime, float weight, TimeFunction* control)
+    {
+        CoreAnimationPtrC coreAnim = this->findAnimToUse(existingName(anim, m_coremdl));
+
+        if(nearZero(coreAnim->duration())) {
+            return m_mixer->additive(AnimationPtr(new Animation(coreAnim, speed, control, new ConstantTF(weight))));
+        }
+
+        // Note: same as in playCycle.
+        TimeFunction* pWeightFun = new FadeInTF(fadeInTime/coreAnim->duration(), new ConstantTF(weight));
+        return m_mixer->additive(AnimationPtr(new Animation(coreAnim, speed, control, pWeightFun)));
     }
 
     ModelInstance& ModelInstance::stop(const std::string anim, float fadeOutTime)
     {
-        m_mixer->stop(anim, fadeOutTime);
+        Name name;
+        if(findName(anim, name))
+            m_mixer->stop(name, fadeOutTime);
         return *this;
     }
 
@@ -133,19 +169,24 @@ namespace bouge {
 
     ModelInstance& ModelInstance::pause(const std::string anim)
     {
-        m_mixer->pause(anim);
+        Name name;
+        if(findName(anim, name))
+            m_mixer->pause(name);
         return *this;
     }
 
     ModelInstance& ModelInstance::resume(const std::string anim)
     {
-        m_mixer->resume(anim);
+        Name name;
+        if(findName(anim, name))
+            m_mixer->resume(name);
         return *this;
     }
 
     bool ModelInstance::paused(const std::string anim) const
     {
-        return m_mixer->paused(anim);
+        Name name;
+        return findName(anim, name) && m_mixer->paused(name);
     }
 
     ModelInstance& ModelInstance::stopAll(float fadeOutTime)
@@ -184,12 +225,16 @@ namespace bouge {
 
     float ModelInstance::speed(const std::string anim) const
     {
-        return m_mixer->speed(anim);
+        // Unknown animations have the default speed, like in the mixer.
+        Name name;
+        return findName(anim, name) ? m_mixer->speed(name) : 1.0f;
     }
 
     ModelInstance& ModelInstance::speed(const std::string anim, float s)
     {
-        m_mixer->speed(anim, s);
+        Name name;
+        if(findName(anim, name))
+            m_mixer->speed(name, s);
         return *this;
     }
 
@@ -201,7 +246,9 @@ namespace bouge {
 
     ModelInstance& ModelInstance::detachAnimation(const std::string& name)
     {
-        m_attachedAnims.erase(name);
+        Name found;
+        if(findName(name, found))
+            m_attachedAnims.erase(found);
         return *this;
     }
 
@@ -224,12 +271,12 @@ namespace bouge {
         return *this;
     }
 
-    CoreAnimationPtrC ModelInstance::findAnimToUse(const std::string& name) const
+    CoreAnimationPtrC ModelInstance::findAnimToUse(const Name& name) const
     {
         CoreAnimationPtrC coreAnim;
 
         // First, look for the animation in the individual attached animations. Use that if found.
-        std::map<std::string, CoreAnimationPtrC>::const_iterator iAnim = m_attachedAnims.find(name);
+        std::map<Name, CoreAnimationPtrC>::const_iterator iAnim = m_attachedAnims.find(name);
         if(iAnim != m_attachedAnims.end())
             return iAnim->second;
 
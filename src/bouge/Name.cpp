@@ -0,0 +1,219 @@
+////////////////////////////////////////////////////////////
+//
+// Bouge - Modern and flexible skeletal animation library
+// Copyright (C) 2010 Lucas Beyer (pompei2@gmail.com)
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it freely,
+// subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+////////////////////////////////////////////////////////////
+#include <bouge/Name.hpp>
+#include <bouge/Util.hpp>
+
+#include <deque>
+#include <map>
+
+#ifdef BOUGE_SYSTEM_WINDOWS
+    #include <windows.h>
+#else
+    #include <pthread.h>
+#endif
+
+namespace bouge {
+
+    /// \internal
+    /// The global table holding the text of all names. The texts live in a
+    /// deque so that references to them stay valid while new ones are added.
+    /// Lookups go through the hash of the text, so only names with colliding
+    /// hashes ever need their texts to be compared.
+    /// Names may be created from any thread, so every access to the table
+    /// is serialized through its mutex.
+    class NameTable {
+    public:
+        NameTable()
+        {
+#ifdef BOUGE_SYSTEM_WINDOWS
+            InitializeCriticalSection(&m_mutex);
+#else
+            pthread_mutex_init(&m_mutex, 0);
+#endif
+            this->intern(std::string());
+        }
+
+        ~NameTable()
+        {
+#ifdef BOUGE_SYSTEM_WINDOWS
+            DeleteCriticalSection(&m_mutex);
+#else
+            pthread_mutex_destroy(&m_mutex);
+#endif
+        }
+
+        /// \return The id of \a text, adding it to the table if it's new.
+        Uint32 intern(const std::string& text)
+        {
+            Lock lock(*this);
+
+            Uint32 h = fnv1aHash(text);
+            Uint32 id = this->lookup(text, h);
+            if(id != NotFound)
+                return id;
+
+            id = (Uint32)m_texts.size();
+            m_texts.push_back(text);
+            m_idsByHash.insert(std::make_pair(h, id));
+            return id;
+        }
+
+        /// \return The id of \a text or 0 (the empty name) if it isn't in the table.
+        Uint32 find(const std::string& text)
+        {
+            Lock lock(*this);
+
+            Uint32 id = this->lookup(text, fnv1aHash(text));
+            return id == NotFound ? 0 : id;
+        }
+
+        const std::string& text(Uint32 id)
+        {
+            // Once added, texts never move, only the deque's bookkeeping
+            // might change while another thread adds a name.
+            Lock lock(*this);
+            return m_texts[id];
+        }
+
+    private:
+        static const Uint32 NotFound = 0xFFFFFFFF;
+
+        class Lock {
+        public:
+            Lock(NameTable& table) : m_table(table) { m_table.lock(); }
+            ~Lock() { m_table.unlock(); }
+        private:
+            NameTable& m_table;
+        };
+
+        void lock()
+        {
+#ifdef BOUGE_SYSTEM_WINDOWS
+            EnterCriticalSection(&m_mutex);
+#else
+            pthread_mutex_lock(&m_mutex);
+#endif
+        }
+
+        void unlock()
+        {
+#ifdef BOUGE_SYSTEM_WINDOWS
+            LeaveCriticalSection(&m_mutex);
+#else
+            pthread_mutex_unlock(&m_mutex);
+#endif
+        }
+
+        Uint32 lookup(const std::string& text, Uint32 h) const
+        {
+            std::pair<std::multimap<Uint32, Uint32>::const_iterator, std::multimap<Uint32, Uint32>::const_iterator> candidates = m_idsByHash.equal_range(h);
+            for(std::multimap<Uint32, Uint32>::const_iterator i = candidates.first ; i != candidates.second ; ++i) {
+                if(m_texts[i->second] == text)
+                    return i->second;
+            }
+
+            return NotFound;
+        }
+
+        std::deque<std::string> m_texts;
+        std::multimap<Uint32, Uint32> m_idsByHash;
+
+#ifdef BOUGE_SYSTEM_WINDOWS
+        CRITICAL_SECTION m_mutex;
+#else
+        pthread_mutex_t m_mutex;
+#endif
+    };
+
+    static NameTable& nameTable()
+    {
+        static NameTable table;
+        return table;
+    }
+
+    Name::Name()
+        : m_id(0)
+    { }
+
+    Name::Name(const std::string& name)
+        : m_id(nameTable().intern(name))
+    { }
+
+    Name::Name(const char* name)
+        : m_id(nameTable().intern(name))
+    { }
+
+    Name Name::find(const std::string& name)
+    {
+        Name ret;
+        ret.m_id = nameTable().find(name);
+        return ret;
+    }
+
+    const std::string& Name::str() const
+    {
+        return nameTable().text(m_id);
+    }
+
+    Name::operator const std::string&() const
+    {
+        return this->str();
+    }
+
+    Uint32 Name::id() const
+    {
+        return m_id;
+    }
+
+    bool Name::empty() const
+    {
+        return m_id == 0;
+    }
+
+    std::ostream& operator<<(std::ostream& os, const Name& name)
+    {
+        return os << name.str();
+    }
+
+    std::string operator+(const std::string& lhs, const Name& rhs)
+    {
+        return lhs + rhs.str();
+    }
+
+    std::string operator+(const Name& lhs, const std::string& rhs)
+    {
+        return lhs.str() + rhs;
+    }
+
+    std::string operator+(const char* lhs, const Name& rhs)
+    {
+        return lhs + rhs.str();
+    }
+
+    std::string operator+(const Name& lhs, const char* rhs)
+    {
+        return lhs.str() + rhs;
+    }
+
+} // namespace bouge
@@ -0,0 +1,249 @@
+////////////////////////////////////////////////////////////
+//
+// Bouge - Modern and flexible skeletal animation library
+// Copyright (C) 2010 Lucas Beyer (pompei2@gmail.com)
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it freely,
+// subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+////////////////////////////////////////////////////////////
+#include <bouge/ResampledCoreTrack.hpp>
+#include <bouge/CoreKeyframe.hpp>
+#include <bouge/Util.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace bouge {
+
+    /// \internal \return The biggest difference of any component of \a a and \a b.
+    static float maxDifference(const Vector& a, const Vector& b)
+    {
+        return std::max(std::fabs(a.x() - b.x()), std::max(std::fabs(a.y() - b.y()), std::fabs(a.z() - b.z())));
+    }
+
+    ResampledCoreTrack::ResampledCoreTrack(const CoreTrack& source, float rate)
+        : m_count(1)
+        , m_end(source.duration())
+        , m_rate(0.0f)
+        , m_bHasRot(source.hasRotation())
+        , m_bHasTrans(source.hasTranslation())
+        , m_bHasScale(source.hasScale())
+    {
+        if(source.keyframeCount() == 0)
+            throw std::invalid_argument("Can't resample a track without keyframes");
+        if(rate <= 0.0f)
+            throw std::invalid_argument("Can't resample a track at a rate of " + to_s(rate) + " samples per second");
+
+        if(m_end > 0.0f) {
+            m_count = (std::size_t)std::ceil(m_end * rate) + 1;
+            m_rate = (float)(m_count - 1) / m_end;
+        }
+
+        for(std::size_t i = 0 ; i < m_count ; ++i) {
+            float t = i + 1 == m_count ? m_end : (float)i / m_rate;
+            if(m_bHasRot) {
+                Quaternion q = source.rotation(t);
+                m_rot.insert(m_rot.end(), q.array4f(), q.array4f() + 4);
+            }
+            if(m_bHasTrans) {
+                Vector v = source.translation(t);
+                m_trans.insert(m_trans.end(), v.array3f(), v.array3f() + 3);
+            }
+            if(m_bHasScale) {
+                Vector v = source.scale(t);
+                m_scale.insert(m_scale.end(), v.array3f(), v.array3f() + 3);
+            }
+        }
+
+        // Now measure what we lost: the keyframes falling between two samples
+        // get cut off, and the motion between the samples may differ.
+        std::vector<float> times;
+        for(CoreTrack::const_iterator i = source.begin() ; i != source.end() ; ++i) {
+            times.push_back(i.time());
+        }
+        for(std::size_t i = 0 ; i + 1 < m_count ; ++i) {
+            times.push_back(((float)i + 0.5f) / m_rate);
+        }
+
+        for(std::vector<float>::iterator t = times.begin() ; t != times.end() ; ++t) {
+            m_error.rotation = std::max(m_error.rotation, source.rotation(*t).angleTo(this->rotation(*t)));
+            m_error.translation = std::max(m_error.translation, (source.translation(*t) - this->translation(*t)).len());
+            m_error.scale = std::max(m_error.scale, maxDifference(source.scale(*t), this->scale(*t)));
+        }
+    }
+
+    ResampledCoreTrack::~ResampledCoreTrack()
+    { }
+
+    void ResampledCoreTrack::sampleAt(float time, std::size_t& idx, float& between) const
+    {
+        // Just as CoreTrack does, stick to the first one before the start
+        // but extrapolate the last two ones after the end.
+        float pos = time * m_rate;
+        if(m_count == 1 || pos <= 0.0f) {
+            idx = 0;
+            between = 0.0f;
+            return;
+        }
+
+        idx = std::min((std::size_t)pos, m_count - 2);
+        between = pos - (float)idx;
+    }
+
+    bool ResampledCoreTrack::hasRotation() const
+    {
+        return m_bHasRot;
+    }
+
+    Quaternion ResampledCoreTrack::rotation(float time) const
+    {
+        if(!this->hasRotation())
+            return Quaternion();
+
+        std::size_t idx;
+        float between;
+        this->sampleAt(time, idx, between);
+
+        const float* q = &m_rot[4*idx];
+        if(between == 0.0f)
+            return Quaternion(q[0], q[1], q[2], q[3]);
+
+        // Samples of the same motion are next to each other, so they nearly
+        // always lie in the same hemisphere, allowing to go the fast way.
+        Quaternion qFrom(q[0], q[1], q[2], q[3]), qTo(q[4], q[5], q[6], q[7]);
+        if(between <= 1.0f && qFrom.dot(qTo) >= 0.0f)
+            return qFrom.fastSlerp(qTo, between);
+
+        return qFrom.slerp(qTo, between);
+    }
+
+    bool ResampledCoreTrack::hasTranslation() const
+    {
+        return m_bHasTrans;
+    }
+
+    Vector ResampledCoreTrack::translation(float time) const
+    {
+        if(!this->hasTranslation())
+            return Vector();
+
+        std::size_t idx;
+        float between;
+        this->sampleAt(time, idx, between);
+
+        const float* v = &m_trans[3*idx];
+        if(between == 0.0f)
+            return Vector(v[0], v[1], v[2]);
+
+        return Vector(v[0] + (v[3] - v[0])*between,
+                      v[1] + (v[4] - v[1])*between,
+                      v[2] + (v[5] - v[2])*between);
+    }
+
+    bool ResampledCoreTrack::hasScale() const
+    {
+        return m_bHasScale;
+    }
+
+    Vector ResampledCoreTrack::scale(float time) const
+    {
+        if(!this->hasScale())
+            return Vector(1.0f, 1.0f, 1.0f);
+
+        std::size_t idx;
+        float between;
+        this->sampleAt(time, idx, between);
+
+        const float* v = &m_scale[3*idx];
+        if(between == 0.0f)
+            return Vector(v[0], v[1], v[2]);
+
+        return Vector(v[0] + (v[3] - v[0])*between,
+                      v[1] + (v[4] - v[1])*between,
+                      v[2] + (v[5] - v[2])*between);
+    }
+
+    std::size_t ResampledCoreTrack::keyframeCount() const
+    {
+        return m_count;
+    }
+
+    float ResampledCoreTrack::duration() const
+    {
+        return m_end;
+    }
+
+    CoreTrack::iterator ResampledCoreTrack::begin()
+    {
+        throw std::logic_error("Can't edit the keyframes of a resampled track, get a CoreTrack out of it using toCoreTrack first");
+    }
+
+    CoreTrack::iterator ResampledCoreTrack::closest(float)
+    {
+        throw std::logic_error("Can't edit the keyframes of a resampled track, get a CoreTrack out of it using toCoreTrack first");
+    }
+
+    CoreTrack::iterator ResampledCoreTrack::after(float)
+    {
+        throw std::logic_error("Can't edit the keyframes of a resampled track, get a CoreTrack out of it using toCoreTrack first");
+    }
+
+    CoreTrack& ResampledCoreTrack::add(float, CoreKeyframePtr)
+    {
+        throw std::logic_error("Can't add keyframes to a resampled track, get a CoreTrack out of it using toCoreTrack first");
+    }
+
+    CoreTrack& ResampledCoreTrack::remove(iterator)
+    {
+        throw std::logic_error("Can't remove keyframes from a resampled track, get a CoreTrack out of it using toCoreTrack first");
+    }
+
+    CoreTrack& ResampledCoreTrack::removeAllIn(float, float)
+    {
+        throw std::logic_error("Can't remove keyframes from a resampled track, get a CoreTrack out of it using toCoreTrack first");
+    }
+
+    float ResampledCoreTrack::rate() const
+    {
+        return m_rate;
+    }
+
+    const CompressionError& ResampledCoreTrack::error() const
+    {
+        return m_error;
+    }
+
+    CoreTrackPtr ResampledCoreTrack::toCoreTrack() const
+    {
+        CoreTrackPtr ret(new CoreTrack());
+        for(std::size_t i = 0 ; i < m_count ; ++i) {
+            CoreKeyframePtr kf(new CoreKeyframe());
+            if(this->hasRotation())
+                kf->rotation(Quaternion(m_rot[4*i], m_rot[4*i+1], m_rot[4*i+2], m_rot[4*i+3]));
+            if(this->hasTranslation())
+                kf->translation(Vector(m_trans[3*i], m_trans[3*i+1], m_trans[3*i+2]));
+            if(this->hasScale())
+                kf->scale(Vector(m_scale[3*i], m_scale[3*i+1], m_scale[3*i+2]));
+            ret->add(i + 1 == m_count ? m_end : (float)i / m_rate, kf);
+        }
+
+        return ret;
+    }
+
+} // namespace bouge
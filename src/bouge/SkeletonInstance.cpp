@@ -26,8 +26,13 @@
 #include <bouge/CoreBone.hpp>
 #include <bouge/Exception.hpp>
 #include <bouge/BoneInstance.hpp>
+#include <bouge/BoneBounds.hpp>
 #include <bouge/Util.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
 namespace bouge {
 
     SkeletonInstance::SkeletonInstance(CoreSkeletonPtrC core)
@@ -52,7 +57,7 @@ namespace bouge {
         return m_core;
     }
 
-    bool SkeletonInstance::hasBone(const std::string& name) const
+    bool SkeletonInstance::hasBone(const Name& name) const
     {
         try {
             return m_core->boneId(name) < m_bones.size();
@@ -61,12 +66,24 @@ namespace bouge {
         }
     }
 
-    BoneInstancePtr SkeletonInstance::bone(const std::string& name)
+    bool SkeletonInstance::hasBone(const std::string& name) const
+    {
+        // An unknown text can't name anything, but it does find the empty name.
+        Name found = Name::find(name);
+        return (!found.empty() || name.empty()) && this->hasBone(found);
+    }
+
+    bool SkeletonInstance::hasBone(const char* name) const
+    {
+        return this->hasBone(std::string(name));
+    }
+
+    BoneInstancePtr SkeletonInstance::bone(const Name& name)
     {
         return this->bone(m_core->boneId(name));
     }
 
-    BoneInstancePtrC SkeletonInstance::bone(const std::string& name) const
+    BoneInstancePtrC SkeletonInstance::bone(const Name& name) const
     {
         return this->bone(m_core->boneId(name));
     }
@@ -117,6 +134,50 @@ namespace bouge {
         return m_core->rootBoneCount();
     }
 
+    BoundingBox SkeletonInstance::bounds(const BoneBounds& bounds, const AffineMatrix& world) const
+    {
+        if(bounds.boneCount() != m_bones.size())
+            throw std::invalid_argument("The bone bounds have " + to_s(bounds.boneCount()) + " bones but the skeleton instance " + this->name() + " has " + to_s(m_bones.size()));
+
+        BoundingBox ret;
+        for(BoneId id = 0 ; id < m_bones.size() ; ++id) {
+            ret.extend(bounds.box(id).transformed(m_bones[id]->transformMatrix()));
+        }
+
+        return ret.transformed(world);
+    }
+
+    BoundingSphere SkeletonInstance::boundingSphere(const BoneBounds& bounds, const AffineMatrix& world) const
+    {
+        if(bounds.boneCount() != m_bones.size())
+            throw std::invalid_argument("The bone bounds have " + to_s(bounds.boneCount()) + " bones but the skeleton instance " + this->name() + " has " + to_s(m_bones.size()));
+
+        // Move all bones' spheres and center the result on the box around them.
+        std::vector<BoundingSphere> spheres;
+        spheres.reserve(m_bones.size());
+        BoundingBox box;
+        for(BoneId id = 0 ; id < m_bones.size() ; ++id) {
+            if(bounds.sphere(id).empty())
+                continue;
+
+            spheres.push_back(bounds.sphere(id).transformed(m_bones[id]->transformMatrix()));
+            float r = spheres.back().radius();
+            box.extend(spheres.back().center() - Vector(r, r, r));
+            box.extend(spheres.back().center() + Vector(r, r, r));
+        }
+
+        if(spheres.empty())
+            return BoundingSphere();
+
+        Vector center = box.center();
+        float radius = 0.0f;
+        for(std::vector<BoundingSphere>::const_iterator i = spheres.begin() ; i != spheres.end() ; ++i) {
+            radius = std::max(radius, (i->center() - center).len() + i->radius());
+        }
+
+        return BoundingSphere(center, radius).transformed(world);
+    }
+
     SkeletonInstance::iterator::iterator(SkeletonInstance* me, CoreSkeleton::const_iterator iter)
         : me(me)
         , myIter(iter)
@@ -0,0 +1,356 @@
+////////////////////////////////////////////////////////////
+//
+// Bouge - Modern and flexible skeletal animation library
+// Copyright (C) 2010 Lucas Beyer (pompei2@gmail.com)
+//
+// This software is provided 'as-is', without any express or implied warranty.
+// In no event will the authors be held liable for any damages arising from the use of this software.
+//
+// Permission is granted to anyone to use this software for any purpose,
+// including commercial applications, and to alter it and redistribute it freely,
+// subject to the following restrictions:
+//
+// 1. The origin of this software must not be misrepresented;
+//    you must not claim that you wrote the original software.
+//    If you use this software in a product, an acknowledgment
+//    in the product documentation would be appreciated but is not required.
+//
+// 2. Altered source versions must be plainly marked as such,
+//    and must not be misrepresented as being the original software.
+//
+// 3. This notice may not be removed or altered from any source distribution.
+//
+////////////////////////////////////////////////////////////
+#include <bouge/StaticBatcher.hpp>
+#include <bouge/StaticModelInstance.hpp>
+#include <bouge/CoreModel.hpp>
+#include <bouge/CoreHardwareMesh.hpp>
+#include <bouge/CoreMaterial.hpp>
+#include <bouge/Exception.hpp>
+#include <bouge/Util.hpp>
+#include <bouge/Math/Matrix.hpp>
+#include <bouge/Math/Vector.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace bouge {
+
+    StaticBatch::StaticBatch(CoreMaterialPtrC mat)
+        : m_mat(mat)
+        , m_revision(0)
+        , m_coordsPerVertex(0)
+    { }
+
+    StaticBatch::~StaticBatch()
+    { }
+
+    CoreMaterialPtrC StaticBatch::material() const
+    {
+        return m_mat;
+    }
+
+    std::size_t StaticBatch::revision() const
+    {
+        return m_revision;
+    }
+
+    std::size_t StaticBatch::vertexCount() const
+    {
+        return m_coordsPerVertex == 0 ? 0 : m_coords.size() / m_coordsPerVertex;
+    }
+
+    std::size_t StaticBatch::faceCount() const
+    {
+        return m_faceIndices.size() / 3;
+    }
+
+    std::size_t StaticBatch::coordsPerVertex() const
+    {
+        return m_coordsPerVertex;
+    }
+
+    const std::vector<float>& StaticBatch::coords() const
+    {
+        return m_coords;
+    }
+
+    const std::map<std::string, std::size_t>& StaticBatch::attribs() const
+    {
+        return m_attribCoordCount;
+    }
+
+    bool StaticBatch::hasAttrib(const std::string& name) const
+    {
+        return m_attribCoordCount.find(name) != m_attribCoordCount.end();
+    }
+
+    std::size_t StaticBatch::attribCoordsPerVertex(const std::string& name) const
+    {
+        std::map<std::string, std::size_t>::const_iterator i = m_attribCoordCount.find(name);
+        if(i == m_attribCoordCount.end())
+            throw std::invalid_argument("The static batch has no vertex attribute called " + name);
+
+        return i->second;
+    }
+
+    const std::vector<float>& StaticBatch::attrib(const std::string& name) const
+    {
+        std::map<std::string, std::vector<float> >::const_iterator i = m_attribs.find(name);
+        if(i == m_attribs.end())
+            throw std::invalid_argument("The static batch has no vertex attribute called " + name);
+
+        return i->second;
+    }
+
+    const std::vector<Uint32>& StaticBatch::faceIndices() const
+    {
+        return m_faceIndices;
+    }
+
+    std::size_t StaticBatch::indexSize() const
+    {
+        return this->vertexCount() <= 0x10000 ? sizeof(Uint16) : sizeof(Uint32);
+    }
+
+    const StaticBatch& StaticBatch::writeIndices(void* where, std::size_t indexSize) const
+    {
+        if(indexSize == sizeof(Uint32)) {
+            std::copy(m_faceIndices.begin(), m_faceIndices.end(), (Uint32*)where);
+        } else if(indexSize == sizeof(Uint16)) {
+            if(this->vertexCount() > 0x10000)
+                throw std::invalid_argument("The " + to_s(this->vertexCount()) + " vertices of the static batch can't be addressed by " + to_s(indexSize) + " byte indices");
+
+            std::copy(m_faceIndices.begin(), m_faceIndices.end(), (Uint16*)where);
+        } else {
+            throw std::invalid_argument("Indices can only be " + to_s(sizeof(Uint16)) + " or " + to_s(sizeof(Uint32)) + " bytes big, not " + to_s(indexSize));
+        }
+
+        return *this;
+    }
+
+    bool StaticBatch::accepts(const CoreHardwareMesh& hwmesh) const
+    {
+        // An empty batch takes the layout of whatever comes first.
+        if(this->vertexCount() == 0)
+            return true;
+
+        return hwmesh.coordsPerVertex() == m_coordsPerVertex && hwmesh.attribs() == m_attribCoordCount;
+    }
+
+    void StaticBatch::append(std::size_t instance, const CoreHardwareMesh& hwmesh, const CoreHardwareSubMesh& submesh, const AffineMatrix& world, const std::string& normalAttrib)
+    {
+        if(this->vertexCount() == 0) {
+            m_coordsPerVertex = hwmesh.coordsPerVertex();
+            m_attribCoordCount = hwmesh.attribs();
+            m_attribs.clear();
+            for(std::map<std::string, std::size_t>::const_iterator i = m_attribCoordCount.begin() ; i != m_attribCoordCount.end() ; ++i) {
+                m_attribs[i->first];
+            }
+        }
+
+        // The submeshes of an instance get added one after the other, so all of
+        // them that go into this batch end up in the same piece.
+        if(m_pieces.empty() || m_pieces.back().instance != instance) {
+            Piece p;
+            p.instance = instance;
+            p.firstVertex = this->vertexCount();
+            p.vertexCount = 0;
+            p.firstIndex = m_faceIndices.size();
+            p.indexCount = 0;
+            m_pieces.push_back(p);
+        }
+
+        std::size_t firstVtx = submesh.baseVertex();
+        std::size_t nVtx = submesh.vertexCount();
+        std::size_t newBase = this->vertexCount();
+
+        // The coordinates get transformed as points...
+        const float* m = world.array16f();
+        const std::vector<float>& coords = hwmesh.coords();
+        m_coords.reserve(m_coords.size() + nVtx*m_coordsPerVertex);
+        for(std::size_t iVtx = firstVtx ; iVtx < firstVtx + nVtx ; ++iVtx) {
+            const float* v = &coords[iVtx*m_coordsPerVertex];
+            m_coords.push_back(m[0]*v[0] + m[4]*v[1] + m[8] *v[2] + m[12]);
+            m_coords.push_back(m[1]*v[0] + m[5]*v[1] + m[9] *v[2] + m[13]);
+            m_coords.push_back(m[2]*v[0] + m[6]*v[1] + m[10]*v[2] + m[14]);
+            m_coords.insert(m_coords.end(), v + 3, v + m_coordsPerVertex);
+        }
+
+        // ... the normals using the inverse transpose and everything else is just copied.
+        const float* im = world.array9fInverse();
+        for(std::map<std::string, std::size_t>::const_iterator i = m_attribCoordCount.begin() ; i != m_attribCoordCount.end() ; ++i) {
+            const std::vector<float>& src = hwmesh.attrib(i->first);
+            std::vector<float>& dst = m_attribs[i->first];
+            std::size_t n = i->second;
+
+            if(i->first != normalAttrib || n < 3) {
+                dst.insert(dst.end(), src.begin() + firstVtx*n, src.begin() + (firstVtx + nVtx)*n);
+                continue;
+            }
+
+            dst.reserve(dst.size() + nVtx*n);
+            for(std::size_t iVtx = firstVtx ; iVtx < firstVtx + nVtx ; ++iVtx) {
+                const float* v = &src[iVtx*n];
+                Vector nor(im[0]*v[0] + im[1]*v[1] + im[2]*v[2],
+                           im[3]*v[0] + im[4]*v[1] + im[5]*v[2],
+                           im[6]*v[0] + im[7]*v[1] + im[8]*v[2]);
+                nor.normalize();
+                dst.push_back(nor.x());
+                dst.push_back(nor.y());
+                dst.push_back(nor.z());
+                dst.insert(dst.end(), v + 3, v + n);
+            }
+        }
+
+        // A mirroring transformation turns the faces inside out, which would
+        // get them culled. Swap two corners of each face to keep them facing out.
+        float det = m[0]*(m[5]*m[10] - m[9]*m[6])
+                  - m[4]*(m[1]*m[10] - m[9]*m[2])
+                  + m[8]*(m[1]*m[6] - m[5]*m[2]);
+        bool bMirrored = det < 0.0f;
+
+        // The indices of the hardware mesh are absolute, rebase them.
+        const std::vector<Uint32>& indices = hwmesh.faceIndices();
+        std::size_t nIdx = submesh.faceCount()*3;
+        m_faceIndices.reserve(m_faceIndices.size() + nIdx);
+        for(std::size_t i = submesh.startIndex() ; i < submesh.startIndex() + nIdx ; i += 3) {
+            m_faceIndices.push_back((Uint32)(indices[i] - firstVtx + newBase));
+            m_faceIndices.push_back((Uint32)(indices[bMirrored ? i+2 : i+1] - firstVtx + newBase));
+            m_faceIndices.push_back((Uint32)(indices[bMirrored ? i+1 : i+2] - firstVtx + newBase));
+        }
+
+        m_pieces.back().vertexCount += nVtx;
+        m_pieces.back().indexCount += nIdx;
+        ++m_revision;
+    }
+
+    void StaticBatch::remove(std::size_t instance)
+    {
+        for(std::size_t iPiece = 0 ; iPiece < m_pieces.size() ; ++iPiece) {
+            if(m_pieces[iPiece].instance != instance)
+                continue;
+
+            Piece p = m_pieces[iPiece];
+            m_pieces.erase(m_pieces.begin() + iPiece);
+
+            // Cut the piece out of all buffers...
+            m_coords.erase(m_coords.begin() + p.firstVertex*m_coordsPerVertex, m_coords.begin() + (p.firstVertex + p.vertexCount)*m_coordsPerVertex);
+            for(std::map<std::string, std::size_t>::const_iterator i = m_attribCoordCount.begin() ; i != m_attribCoordCount.end() ; ++i) {
+                std::vector<float>& a = m_attribs[i->first];
+                a.erase(a.begin() + p.firstVertex*i->second, a.begin() + (p.firstVertex + p.vertexCount)*i->second);
+            }
+            m_faceIndices.erase(m_faceIndices.begin() + p.firstIndex, m_faceIndices.begin() + p.firstIndex + p.indexCount);
+
+            // ... and move everything behind it to the front.
+            for(std::size_t i = p.firstIndex ; i < m_faceIndices.size() ; ++i) {
+                m_faceIndices[i] -= (Uint32)p.vertexCount;
+            }
+            for(std::size_t i = iPiece ; i < m_pieces.size() ; ++i) {
+                m_pieces[i].firstVertex -= p.vertexCount;
+                m_pieces[i].firstIndex -= p.indexCount;
+            }
+
+            ++m_revision;
+            return;
+        }
+    }
+
+    StaticBatcher::StaticBatcher(const std::string& normalAttrib)
+        : m_normalAttrib(normalAttrib)
+        , m_nextId(0)
+    { }
+
+    StaticBatcher::~StaticBatcher()
+    { }
+
+    StaticBatcher::InstanceId StaticBatcher::add(StaticModelInstancePtrC inst, const AffineMatrix& world)
+    {
+        CoreModelPtrC model = inst->core();
+
+        std::map<CoreModelPtrC, CachedMesh>::iterator iMesh = m_meshes.find(model);
+        if(iMesh == m_meshes.end()) {
+            CachedMesh cached;
+            cached.hwmesh = CoreHardwareMeshPtrC(new CoreHardwareMesh(model->mesh(), 0, 0, 3));
+            cached.users = 0;
+            iMesh = m_meshes.insert(std::make_pair(model, cached)).first;
+        }
+        const CoreHardwareMesh& hwmesh = *iMesh->second.hwmesh;
+
+        // First find the batch of every submesh, so that we don't leave a
+        // half-added instance behind if one of them doesn't fit.
+        std::vector<std::size_t> batchOfSubmesh;
+        for(CoreHardwareMesh::const_iterator i = hwmesh.begin() ; i != hwmesh.end() ; ++i) {
+            CoreMaterialPtrC mat = inst->materialForSubmesh(i->submeshName());
+
+            std::map<CoreMaterialPtrC, std::size_t>::iterator iBatch = m_batchForMaterial.find(mat);
+            if(iBatch == m_batchForMaterial.end()) {
+                iBatch = m_batchForMaterial.insert(std::make_pair(mat, m_batches.size())).first;
+                m_batches.push_back(StaticBatch(mat));
+            }
+
+            if(!m_batches[iBatch->second].accepts(hwmesh))
+                throw std::invalid_argument("The mesh of the model " + model->name() + " has other vertex attributes than the rest of the static batch using the material " + (mat ? mat->name().str() : std::string("(none)")));
+
+            batchOfSubmesh.push_back(iBatch->second);
+        }
+
+        InstanceId id = m_nextId++;
+        Entry& entry = m_instances[id];
+        entry.model = model;
+        ++iMesh->second.users;
+
+        std::size_t iSubmesh = 0;
+        for(CoreHardwareMesh::const_iterator i = hwmesh.begin() ; i != hwmesh.end() ; ++i, ++iSubmesh) {
+            std::size_t iBatch = batchOfSubmesh[iSubmesh];
+            m_batches[iBatch].append(id, hwmesh, *i, world, m_normalAttrib);
+            if(std::find(entry.batches.begin(), entry.batches.end(), iBatch) == entry.batches.end())
+                entry.batches.push_back(iBatch);
+        }
+
+        return id;
+    }
+
+    StaticBatcher& StaticBatcher::remove(InstanceId id)
+    {
+        std::map<InstanceId, Entry>::iterator iEntry = m_instances.find(id);
+        if(iEntry == m_instances.end())
+            throw NotExistException("instance", to_s(id), "static batcher", "", __FILE__, __LINE__);
+
+        for(std::vector<std::size_t>::const_iterator i = iEntry->second.batches.begin() ; i != iEntry->second.batches.end() ; ++i) {
+            m_batches[*i].remove(id);
+        }
+
+        // Forget the hardware mesh once no instance uses it anymore.
+        std::map<CoreModelPtrC, CachedMesh>::iterator iMesh = m_meshes.find(iEntry->second.model);
+        if(--iMesh->second.users == 0)
+            m_meshes.erase(iMesh);
+
+        m_instances.erase(iEntry);
+        return *this;
+    }
+
+    bool StaticBatcher::has(InstanceId id) const
+    {
+        return m_instances.find(id) != m_instances.end();
+    }
+
+    std::size_t StaticBatcher::instanceCount() const
+    {
+        return m_instances.size();
+    }
+
+    std::size_t StaticBatcher::batchCount() const
+    {
+        return m_batches.size();
+    }
+
+    const StaticBatch& StaticBatcher::batch(std::size_t idx) const
+    {
+        if(idx >= m_batches.size())
+            throw std::out_of_range("Static batch " + to_s(idx) + " (max: " + to_s(m_batches.size()) + ")");
+
+        return m_batches[idx];
+    }
+
+} // namespace bouge
@@ -60,4 +60,9 @@ namespace bouge {
         return m_coremdl->materialForSubmesh(submesh, m_sMatSet);
     }
 
+    CoreModelPtrC StaticModelInstance::core() const
+    {
+        return m_coremdl;
+    }
+
 }
@@ -61,6 +61,22 @@ namespace bouge
         return to_s(i);
     }
 
+    Uint32 fnv1aHash(const void* pData, std::size_t size, Uint32 h)
+    {
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(pData);
+        for(std::size_t i = 0 ; i < size ; ++i) {
+            h ^= p[i];
+            h *= 16777619u;
+        }
+        return h;
+    }
+
+    Uint32 fnv1aHash(const std::string& s, Uint32 h)
+    {
+        // Hash the terminating zero too, so "ab"+"c" differs from "a"+"bc".
+        return fnv1aHash(s.c_str(), s.size() + 1, h);
+    }
+
     template <>
     std::string to_s< std::vector<float> >(const std::vector<float>& t)
     {